@@ -1,8 +1,16 @@
 #include "simd.hxx"
 
 #include <cctk.h>
+#include <cctk_Arguments.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
 
 namespace Arith {
 
@@ -49,7 +57,235 @@ void TestSIMD() {
   assert(all(r1 == mulsub(2, 3, 4)));
   assert(all(r2 == negmuladd(2, 3, 4)));
   assert(all(r3 == negmulsub(2, 3, 4)));
+
+  // Vectorized elementary functions are accurate to about 1 ULP
+  const auto isclose = [](const realv &x, const CCTK_REAL y) {
+    using std::abs;
+    return all(abs(x - y) <= 4 * numeric_limits<CCTK_REAL>::epsilon() *
+                                 abs(y));
+  };
+  using std::atan2, std::cbrt, std::cos, std::exp, std::log, std::pow,
+      std::sin;
+  assert(isclose(atan2(b, -a), atan2(3, -2)));
+  assert(isclose(cbrt(a), cbrt(2)));
+  assert(isclose(cos(b), cos(3)));
+  assert(isclose(exp(b), exp(3)));
+  assert(isclose(log(c), log(4)));
+  assert(isclose(pow(a, b), 8));
+  assert(isclose(sin(b), sin(3)));
+  assert(all(pow(-a, b) == -8));
 #endif
 }
 
+namespace {
+
+// Error of a result in units in the last place, relative to a more
+// precise reference value
+long double ulp_error(const double res, const long double ref) {
+  using std::abs, std::frexp, std::ldexp, std::max;
+  int exponent;
+  frexp(ref, &exponent);
+  const int digits = std::numeric_limits<double>::digits;
+  const int min_exponent = std::numeric_limits<double>::min_exponent;
+  const long double ulp =
+      ldexp(1.0L, max(exponent, min_exponent) - digits);
+  return abs(res - ref) / ulp;
+}
+
+// Long double is more precise than double on most platforms. There,
+// we compare to a long double reference. Otherwise, we assume that
+// libm is accurate to better than 1 ULP, and that the results differ
+// by at most 1 ULP.
+constexpr bool have_precise_long_double =
+    std::numeric_limits<long double>::digits >
+    std::numeric_limits<double>::digits + 8;
+
+// `expected` is the scalar (libm) result, i.e. what the function
+// returns when `ARITH_SIMD_SCALAR_MATH` is defined. Special values
+// need to agree exactly with it. (We cannot require all results to
+// be close to libm: e.g. glibc's `cbrt` has errors of more than 3 ULP,
+// which is more than the vectorized version.)
+void check_result(const char *const name, const double max_error,
+                  const double x, const double y, const double res,
+                  const double expected, const long double ref) {
+  using std::isfinite, std::isnan, std::nextafter, std::signbit;
+  bool ok;
+  if (isnan(expected))
+    ok = isnan(res);
+  else if (!isfinite(x) || !isfinite(y) || !isfinite(expected))
+    ok = res == expected && signbit(res) == signbit(expected);
+  else if (res == 0 && expected == 0)
+    ok = signbit(res) == signbit(expected);
+  else if (have_precise_long_double)
+    ok = ulp_error(res, ref) <= max_error;
+  else
+    ok = res == expected || res == nextafter(expected, -HUGE_VAL) ||
+         res == nextafter(expected, +HUGE_VAL);
+  if (!ok)
+    CCTK_VERROR("SIMD math test failed: %s(%.17g, %.17g) = %.17g, but the "
+                "scalar result is %.17g and the long double result is %.21Lg",
+                name, x, y, res, expected, ref);
+}
+
+template <typename VF, typename SF, typename LF>
+void check_unary(const char *const name, const double max_error,
+                 const VF &vecf, const SF &scalarf, const LF &longf,
+                 const std::vector<double> &xs) {
+  typedef simd<double> realv;
+  constexpr std::size_t vsize = realv::storage_size;
+  for (std::size_t i = 0; i < xs.size(); i += vsize) {
+    alignas(realv) double xarr[vsize];
+    for (std::size_t n = 0; n < vsize; ++n)
+      xarr[n] = xs.at(std::min(i + n, xs.size() - 1));
+    alignas(realv) double resarr[vsize];
+    storea(resarr, vecf(loada<realv>(xarr)));
+    for (std::size_t n = 0; n < vsize; ++n)
+      check_result(name, max_error, xarr[n], 0, resarr[n], scalarf(xarr[n]),
+                   longf(xarr[n]));
+  }
+}
+
+template <typename VF, typename SF, typename LF>
+void check_binary(const char *const name, const double max_error,
+                  const VF &vecf, const SF &scalarf, const LF &longf,
+                  const std::vector<double> &xs,
+                  const std::vector<double> &ys) {
+  typedef simd<double> realv;
+  constexpr std::size_t vsize = realv::storage_size;
+  assert(xs.size() == ys.size());
+  for (std::size_t i = 0; i < xs.size(); i += vsize) {
+    alignas(realv) double xarr[vsize], yarr[vsize];
+    for (std::size_t n = 0; n < vsize; ++n) {
+      xarr[n] = xs.at(std::min(i + n, xs.size() - 1));
+      yarr[n] = ys.at(std::min(i + n, ys.size() - 1));
+    }
+    alignas(realv) double resarr[vsize];
+    storea(resarr, vecf(loada<realv>(xarr), loada<realv>(yarr)));
+    for (std::size_t n = 0; n < vsize; ++n)
+      check_result(name, max_error, xarr[n], yarr[n], resarr[n],
+                   scalarf(xarr[n], yarr[n]), longf(xarr[n], yarr[n]));
+  }
+}
+
+// Compare the vectorized elementary functions to libm, i.e. to what
+// they return when `ARITH_SIMD_SCALAR_MATH` is defined
+void test_simd_math() {
+  typedef simd<double> realv;
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  constexpr double dmin = std::numeric_limits<double>::min();
+  constexpr double dmax = std::numeric_limits<double>::max();
+  constexpr double dtrue_min = std::numeric_limits<double>::denorm_min();
+
+  const std::vector<double> specials{
+      0,     -0.0,      inf,      -inf,   nan,  dmin,     -dmin,
+      dmax,  -dmax,     dtrue_min, -dtrue_min, 1, -1,      0.5,
+      -0.5,  2,         -2,       3,      -3,   M_PI,     -M_PI,
+      M_PI_2, -M_PI_2,  0x1p+19,  -0x1p+19, 0x1p+19 + 1, 1e+300, -1e+300,
+      709.782712893384, 709.79,   -708.4, -745.1332191019411, -746};
+
+  std::mt19937_64 rng(42);
+  // Random bit patterns cover all exponents, including subnormal
+  // numbers, infinities, and NaNs
+  const auto random_bits = [&]() {
+    const std::uint64_t i = rng();
+    double x;
+    std::memcpy(&x, &i, sizeof x);
+    return x;
+  };
+  const auto random_uniform = [&](const double lo, const double hi) {
+    return std::uniform_real_distribution<double>(lo, hi)(rng);
+  };
+  constexpr int npoints = 100000;
+  const auto make_args = [&](const double lo, const double hi) {
+    std::vector<double> xs = specials;
+    for (int n = 0; n < npoints; ++n)
+      xs.push_back(random_bits());
+    for (int n = 0; n < npoints; ++n)
+      xs.push_back(random_uniform(lo, hi));
+    return xs;
+  };
+
+  // The maximum errors are those stated in simd.hxx
+  check_unary(
+      "exp", 0.77, [](const realv &x) { return exp(x); },
+      [](const double x) { return std::exp(x); },
+      [](const long double x) { return std::exp(x); }, make_args(-746, 710));
+  check_unary(
+      "log", 0.51, [](const realv &x) { return log(x); },
+      [](const double x) { return std::log(x); },
+      [](const long double x) { return std::log(x); }, make_args(0, 10));
+  check_unary(
+      "sin", 0.79, [](const realv &x) { return sin(x); },
+      [](const double x) { return std::sin(x); },
+      [](const long double x) { return std::sin(x); },
+      make_args(-0x1p+19, 0x1p+19));
+  check_unary(
+      "cos", 0.79, [](const realv &x) { return cos(x); },
+      [](const double x) { return std::cos(x); },
+      [](const long double x) { return std::cos(x); },
+      make_args(-0x1p+19, 0x1p+19));
+  check_unary(
+      "cbrt", 0.51, [](const realv &x) { return cbrt(x); },
+      [](const double x) { return std::cbrt(x); },
+      [](const long double x) { return std::cbrt(x); }, make_args(-10, 10));
+
+  // All pairs of special values, and random pairs
+  std::vector<double> xs, ys;
+  for (const double x : specials)
+    for (const double y : specials) {
+      xs.push_back(x);
+      ys.push_back(y);
+    }
+  const std::size_t nspecials = xs.size();
+
+  for (int n = 0; n < npoints; ++n) {
+    xs.push_back(random_bits());
+    ys.push_back(random_bits());
+  }
+  for (int n = 0; n < npoints; ++n) {
+    xs.push_back(random_uniform(-10, 10));
+    ys.push_back(random_uniform(-10, 10));
+  }
+  check_binary(
+      "atan2", 0.90,
+      [](const realv &y, const realv &x) { return atan2(y, x); },
+      [](const double y, const double x) { return std::atan2(y, x); },
+      [](const long double y, const long double x) {
+        return std::atan2(y, x);
+      },
+      xs, ys);
+
+  // For pow, also use positive bases with moderate exponents, and
+  // negative bases with integer exponents
+  xs.resize(nspecials);
+  ys.resize(nspecials);
+  for (int n = 0; n < npoints; ++n) {
+    xs.push_back(random_bits());
+    ys.push_back(random_bits());
+  }
+  for (int n = 0; n < npoints; ++n) {
+    xs.push_back(random_uniform(0, 10));
+    ys.push_back(random_uniform(-300, 300));
+  }
+  for (int n = 0; n < npoints; ++n) {
+    xs.push_back(random_uniform(-10, 0));
+    ys.push_back(std::round(random_uniform(-300, 300)));
+  }
+  check_binary(
+      "pow", 0.74, [](const realv &x, const realv &y) { return pow(x, y); },
+      [](const double x, const double y) { return std::pow(x, y); },
+      [](const long double x, const long double y) { return std::pow(x, y); },
+      xs, ys);
+}
+
+} // namespace
+
+extern "C" void Test_simd(CCTK_ARGUMENTS) {
+  CCTK_INFO("Test_simd");
+
+  TestSIMD();
+  test_simd_math();
+}
+
 } // namespace Arith
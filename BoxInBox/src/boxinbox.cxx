@@ -1,5 +1,6 @@
 #include <defs.hxx>
 #include <loop_device.hxx>
+#include <refined_regions.hxx>
 #include <sum.hxx>
 #include <vect.hxx>
 
@@ -9,6 +10,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 namespace BoxInBox {
 using namespace Loop;
@@ -154,4 +156,44 @@ extern "C" void BoxInBox_Setup(CCTK_ARGUMENTS) {
       });
 }
 
+extern "C" void BoxInBox_SetRegions(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_BoxInBox_SetRegions;
+  DECLARE_CCTK_PARAMETERS;
+
+  const auto get_shape = [](const auto &shape) {
+    if (CCTK_EQUALS(shape, "sphere"))
+      return CarpetX::region_shape_t::sphere;
+    if (CCTK_EQUALS(shape, "cube"))
+      return CarpetX::region_shape_t::cube;
+    CCTK_ERROR("internal error");
+  };
+  const vect<CarpetX::region_shape_t, max_num_regions> shapes = {
+      get_shape(shape_1), get_shape(shape_2), get_shape(shape_3)};
+
+  std::vector<CarpetX::refined_region_t> regions;
+  for (int region = 0; region < max_num_regions; ++region) {
+    if (!int(active[region]))
+      continue;
+    for (int level = 1; level < int(num_levels[region]); ++level) {
+      const int level_region = level + max_num_levels * region;
+      CarpetX::refined_region_t refined_region;
+      refined_region.patch = 0;
+      refined_region.level = level;
+      refined_region.shape = shapes[region];
+      refined_region.centre = {position_x[region], position_y[region],
+                               position_z[region]};
+      refined_region.radius = {
+          radius_x[level_region] < 0 ? radius[level_region]
+                                     : radius_x[level_region],
+          radius_y[level_region] < 0 ? radius[level_region]
+                                     : radius_y[level_region],
+          radius_z[level_region] < 0 ? radius[level_region]
+                                     : radius_z[level_region]};
+      regions.push_back(refined_region);
+    }
+  }
+
+  CarpetX::set_refined_regions(regions);
+}
+
 } // namespace BoxInBox
@@ -0,0 +1,109 @@
+#include "derived.hxx"
+
+#include "driver.hxx"
+
+#include <cctk.h>
+
+#include <cassert>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace CarpetX {
+
+namespace {
+std::map<std::string, derived_quantity_t> &derived_quantities() {
+  static std::map<std::string, derived_quantity_t> dqs;
+  return dqs;
+}
+} // namespace
+
+void register_derived_quantity(const std::string &name,
+                               const std::vector<std::string> &inputs,
+                               const derived_kernel_t &kernel) {
+  if (derived_quantities().count(name))
+    CCTK_VERROR("Derived quantity \"%s\" is already registered", name.c_str());
+  if (inputs.empty())
+    CCTK_VERROR("Derived quantity \"%s\" has no inputs", name.c_str());
+
+  derived_quantity_t dq;
+  dq.name = name;
+  for (const auto &input : inputs) {
+    const int vn = CCTK_VarIndex(input.c_str());
+    if (vn < 0)
+      CCTK_VERROR("Input \"%s\" of derived quantity \"%s\" is not a variable",
+                  input.c_str(), name.c_str());
+    if (CCTK_GroupTypeFromVarI(vn) != CCTK_GF)
+      CCTK_VERROR("Input \"%s\" of derived quantity \"%s\" is not a grid "
+                  "function",
+                  input.c_str(), name.c_str());
+    dq.inputs.push_back(vn);
+  }
+  dq.kernel = kernel;
+
+  derived_quantities()[name] = std::move(dq);
+}
+
+const derived_quantity_t *find_derived_quantity(const std::string &name) {
+  const auto it = derived_quantities().find(name);
+  if (it == derived_quantities().end())
+    return nullptr;
+  return &it->second;
+}
+
+std::vector<const derived_quantity_t *>
+find_derived_quantities(const std::string &names) {
+  std::vector<const derived_quantity_t *> dqs;
+  std::istringstream buf(names);
+  std::string name;
+  while (buf >> name) {
+    const derived_quantity_t *const dq = find_derived_quantity(name);
+    if (!dq)
+      CCTK_VERROR("Unknown derived quantity \"%s\"", name.c_str());
+    dqs.push_back(dq);
+  }
+  return dqs;
+}
+
+int get_derived_layout_group(const derived_quantity_t &dq) {
+  return CCTK_GroupIndexFromVarI(dq.inputs.at(0));
+}
+
+void evaluate_derived_quantity(const derived_quantity_t &dq, const int patch,
+                               const int level, const int component,
+                               const amrex::Box &box, amrex::FArrayBox &fab) {
+  const auto &leveldata = ghext->patchdata.at(patch).leveldata.at(level);
+  const int layout_gi = get_derived_layout_group(dq);
+  const auto &layout_groupdata = *leveldata.groupdata.at(layout_gi);
+
+  const int tl = 0;
+  std::vector<amrex::Array4<const CCTK_REAL> > inputs;
+  inputs.reserve(dq.inputs.size());
+  for (const int vn : dq.inputs) {
+    const int gi = CCTK_GroupIndexFromVarI(vn);
+    const int vi = vn - CCTK_FirstVarIndexI(gi);
+    const auto &groupdata = *leveldata.groupdata.at(gi);
+    if (groupdata.indextype != layout_groupdata.indextype)
+      CCTK_VERROR("Inputs of derived quantity \"%s\" have different "
+                  "centerings",
+                  dq.name.c_str());
+    if (!groupdata.mfab.at(tl)->fabbox(component).contains(box))
+      CCTK_VERROR("Input \"%s\" of derived quantity \"%s\" does not have "
+                  "enough ghost zones",
+                  CCTK_FullVarName(vn), dq.name.c_str());
+    inputs.emplace_back(groupdata.mfab.at(tl)->const_array(component), vi);
+  }
+
+  if (fab.box() != box || fab.nComp() != 1)
+    fab.resize(box, 1);
+  dq.kernel(box, inputs, fab.array());
+}
+
+void evaluate_derived_quantity(const derived_quantity_t &dq, const int patch,
+                               const int level, const amrex::MFIter &mfi,
+                               const amrex::Box &box, amrex::FArrayBox &fab) {
+  evaluate_derived_quantity(dq, patch, level, mfi.index(), box, fab);
+}
+
+} // namespace CarpetX
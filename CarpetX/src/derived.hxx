@@ -0,0 +1,97 @@
+#ifndef CARPETX_CARPETX_DERIVED_HXX
+#define CARPETX_CARPETX_DERIVED_HXX
+
+#include <cctk.h>
+
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_MFIter.H>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace CarpetX {
+
+// A derived quantity is a point-wise function of grid functions, e.g.
+// the norm of a vector. It has no storage of its own. It is evaluated
+// component by component into a small staging buffer only when it is
+// output or reduced. All output methods except slices support derived
+// quantities (see the CarpetX::out_*_derived parameters).
+
+// Evaluate a derived quantity on all points of a box. `inputs` are
+// the input grid functions (in the order in which they were
+// registered), `output` has the shape of the box.
+using derived_kernel_t = std::function<void(
+    const amrex::Box &box,
+    const std::vector<amrex::Array4<const CCTK_REAL> > &inputs,
+    const amrex::Array4<CCTK_REAL> &output)>;
+
+struct derived_quantity_t {
+  std::string name;
+  std::vector<int> inputs; // Cactus variable indices
+  derived_kernel_t kernel;
+};
+
+// Register a derived quantity. `name` should have the form
+// "thorn::name". All inputs must be grid functions with the same
+// centering.
+void register_derived_quantity(const std::string &name,
+                               const std::vector<std::string> &inputs,
+                               const derived_kernel_t &kernel);
+
+// Register a derived quantity given as point-wise expression. `expr`
+// is called with a pointer to the input values at a grid point and
+// returns the value of the derived quantity there.
+template <typename F>
+void register_derived_quantity(const std::string &name,
+                               const std::vector<std::string> &inputs,
+                               const F &expr) {
+  const int ninputs = inputs.size();
+  register_derived_quantity(
+      name, inputs,
+      derived_kernel_t(
+          [=](const amrex::Box &box,
+              const std::vector<amrex::Array4<const CCTK_REAL> > &invars,
+              const amrex::Array4<CCTK_REAL> &outvar) {
+            std::vector<CCTK_REAL> values(ninputs);
+            for (int k = box.smallEnd(2); k <= box.bigEnd(2); ++k)
+              for (int j = box.smallEnd(1); j <= box.bigEnd(1); ++j)
+                for (int i = box.smallEnd(0); i <= box.bigEnd(0); ++i) {
+                  for (int n = 0; n < ninputs; ++n)
+                    values[n] = invars[n](i, j, k);
+                  outvar(i, j, k) = expr(values.data());
+                }
+          }));
+}
+
+// Find a registered derived quantity; returns nullptr if there is
+// none with this name
+const derived_quantity_t *find_derived_quantity(const std::string &name);
+
+// Find the derived quantities listed in a space-separated string.
+// Unknown names are an error.
+std::vector<const derived_quantity_t *>
+find_derived_quantities(const std::string &names);
+
+// The group of the first input, which determines the layout (e.g.
+// centering and ghost zones) of a derived quantity
+int get_derived_layout_group(const derived_quantity_t &dq);
+
+// Evaluate a derived quantity on a box of the component `component`
+// of a level into the staging buffer `fab`, which is resized as
+// necessary. The component must be owned by this process.
+void evaluate_derived_quantity(const derived_quantity_t &dq, int patch,
+                               int level, int component, const amrex::Box &box,
+                               amrex::FArrayBox &fab);
+
+// Evaluate a derived quantity on a box of the component `mfi` of a
+// level into the staging buffer `fab`, which is resized as necessary
+void evaluate_derived_quantity(const derived_quantity_t &dq, int patch,
+                               int level, const amrex::MFIter &mfi,
+                               const amrex::Box &box, amrex::FArrayBox &fab);
+
+} // namespace CarpetX
+
+#endif // #ifndef CARPETX_CARPETX_DERIVED_HXX
@@ -7,6 +7,8 @@
 #include "logo.hxx"
 #include "loop_device.hxx"
 #include "prolongate_3d_rf2.hxx"
+#include "refined_regions.hxx"
+#include "regrid_policy.hxx"
 #include "schedule.hxx"
 #include "timer.hxx"
 
@@ -28,6 +30,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <sstream>
@@ -1287,6 +1290,7 @@ GHExt::PatchData::LevelData::LevelData(const int patch, const int level,
   assert(ba.ixType() == amrex::IndexType(amrex::IndexType::CELL,
                                          amrex::IndexType::CELL,
                                          amrex::IndexType::CELL));
+  box_costs.resize(fab->size(), 0);
 
   // Set up metadata
   const int numgroups = CCTK_NumGroups();
@@ -1349,12 +1353,31 @@ GHExt::PatchData::LevelData::LevelData(const int patch, const int level,
       enter_local_mode(cctkGH, leveldata, mfp);
       assert(int(local_cctkGHs.size()) == component);
       local_cctkGHs.emplace_back(copy_cctkGH(cctkGH));
+      component_indices.push_back(mfp.index());
       leave_local_mode(cctkGH, leveldata, mfp);
     }
     leave_patch_mode(cctkGH, leveldata);
   }
 }
 
+void GHExt::PatchData::LevelData::update_local_cctkGHs_data(
+    const int gi) const {
+  const auto &restrict groupdata = *this->groupdata.at(gi);
+  for (int component = 0; component < int(local_cctkGHs.size());
+       ++component) {
+    cGH *restrict const cctkGH = local_cctkGHs.at(component).get();
+    const int index = component_indices.at(component);
+    for (int tl = 0; tl < int(groupdata.mfab.size()); ++tl) {
+      // Grid function pointers point to the beginning of the FAB,
+      // including its ghost zones (see `GridPtrDesc1`)
+      const amrex::Array4<CCTK_REAL> vars = groupdata.mfab.at(tl)->array(index);
+      for (int vi = 0; vi < groupdata.numvars; ++vi)
+        cctkGH->data[groupdata.firstvarindex + vi][tl] =
+            vars.ptr(vars.begin.x, vars.begin.y, vars.begin.z, vi);
+    }
+  }
+}
+
 GHExt::PatchData::LevelData::GroupData::GroupData(
     const int patch, const int level, const int gi, const amrex::BoxArray &ba,
     const amrex::DistributionMapping &dm, const function<string()> &why)
@@ -1529,7 +1552,7 @@ CactusAmrCore::CactusAmrCore(const int patch, const amrex::RealBox *rb,
                              amrex::Vector<amrex::IntVect> ref_ratios,
                              const int *is_per)
     : amrex::AmrCore(rb, max_level_in, n_cell_in, coord, ref_ratios, is_per),
-      patch(patch) {
+      patch(patch), default_n_error_buf(n_error_buf) {
   SetupGlobals();
 }
 
@@ -1539,18 +1562,177 @@ CactusAmrCore::CactusAmrCore(const int patch, const amrex::RealBox &rb,
                              amrex::Vector<amrex::IntVect> const &ref_ratios,
                              amrex::Array<int, AMREX_SPACEDIM> const &is_per)
     : amrex::AmrCore(rb, max_level_in, n_cell_in, coord, ref_ratios, is_per),
-      patch(patch) {
+      patch(patch), default_n_error_buf(n_error_buf) {
   SetupGlobals();
 }
 
 CactusAmrCore::~CactusAmrCore() {}
 
+void CactusAmrCore::regrid(const int lbase, const amrex::Real time,
+                           const bool initial) {
+  DECLARE_CCTK_PARAMETERS;
+
+  // Before Cactus is initialized there are no regridding errors
+  if (!cactus_is_initialized) {
+    amrex::AmrCore::regrid(lbase, time, initial);
+    return;
+  }
+
+  if (lbase >= maxLevel())
+    return;
+
+  const bool use_refined_regions = have_refined_regions();
+
+  if (verbose)
+#pragma omp critical
+    CCTK_VINFO("regrid patch %d%s", patch,
+               use_refined_regions ? " from refined regions" : "");
+
+  // Construct the new grids. As with AMReX's regridding, at most one
+  // new level is added at a time.
+  const int old_finest_level = finestLevel();
+  const int max_finest_level = min(old_finest_level + 1, maxLevel());
+  amrex::Vector<amrex::BoxArray> new_grids(max_finest_level + 1);
+  new_grids.at(lbase) = boxArray(lbase);
+  int new_finest_level = lbase;
+  if (use_refined_regions) {
+    for (int level = lbase + 1; level <= max_finest_level; ++level) {
+      const amrex::BoxArray ba = make_refined_regions_boxarray(
+          get_refined_regions(patch, level), Geom(level),
+          blockingFactor(level), maxGridSize(level), new_grids.at(level - 1),
+          nProper());
+      if (ba.empty())
+        break;
+      new_grids.at(level) = ba;
+      new_finest_level = level;
+    }
+  } else {
+    // Tag and cluster cells via the refinement criteria. AMReX
+    // enlarges the tagged regions by `n_error_buf` cells, also across
+    // box boundaries. `regrid_buffer` is steerable; restore AMReX's
+    // default when it is reset to -1.
+    if (regrid_buffer >= 0)
+      for (auto &nbuf : n_error_buf)
+        nbuf = amrex::IntVect(regrid_buffer);
+    else
+      n_error_buf = default_n_error_buf;
+    amrex::Vector<amrex::BoxArray> tagged_grids(old_finest_level + 2);
+    MakeNewGrids(lbase, time, new_finest_level, tagged_grids);
+    assert(new_finest_level <= max_finest_level);
+    for (int level = lbase + 1; level <= new_finest_level; ++level)
+      new_grids.at(level) = tagged_grids.at(level);
+  }
+
+  // Avoid regridding levels whose boxes would change only a little
+  for (int level = lbase + 1; level <= new_finest_level; ++level) {
+    const amrex::BoxArray old_ba =
+        level <= old_finest_level ? boxArray(level) : amrex::BoxArray();
+    new_grids.at(level) = apply_regrid_policy(
+        new_grids.at(level), old_ba, new_grids.at(level - 1),
+        Geom(level).Domain(), blockingFactor(level), maxGridSize(level),
+        nProper());
+    if (new_grids.at(level).empty()) {
+      new_finest_level = level - 1;
+      break;
+    }
+  }
+
+  // Update the levels in the same way as AMReX's regridding does
+  for (int level = lbase + 1; level <= new_finest_level; ++level) {
+    const amrex::BoxArray &ba = new_grids.at(level);
+    if (level <= old_finest_level) {
+      if (ba != boxArray(level)) {
+        const amrex::DistributionMapping dm = MakeDistributionMap(level, ba);
+        RemakeLevel(level, time, ba, dm);
+        SetBoxArray(level, ba);
+        SetDistributionMap(level, dm);
+      }
+    } else {
+      const amrex::DistributionMapping dm = MakeDistributionMap(level, ba);
+      MakeNewLevelFromCoarse(level, time, ba, dm);
+      SetBoxArray(level, ba);
+      SetDistributionMap(level, dm);
+    }
+  }
+  for (int level = new_finest_level + 1; level <= old_finest_level; ++level) {
+    ClearLevel(level);
+    ClearBoxArray(level);
+    ClearDistributionMap(level);
+  }
+  SetFinestLevel(new_finest_level);
+
+  if (verbose)
+#pragma omp critical
+    CCTK_VINFO("regrid patch %d done.", patch);
+}
+
+namespace {
+enum class criterion_kind_t { value, gradient, laplacian };
+
+// The refinement criteria, in a form that can be captured by device
+// kernels
+struct regrid_criteria_t {
+  static constexpr int max_num_criteria = 11;
+  int num_criteria;
+  int varindices[max_num_criteria];
+  criterion_kind_t kinds[max_num_criteria];
+  CCTK_REAL thresholds[max_num_criteria];
+};
+
+regrid_criteria_t get_regrid_criteria() {
+  DECLARE_CCTK_PARAMETERS;
+
+  regrid_criteria_t criteria;
+  criteria.num_criteria = 0;
+  const auto add_criterion = [&](const char *const varname,
+                                 const criterion_kind_t kind,
+                                 const CCTK_REAL threshold) {
+    const int varindex = CCTK_VarIndex(varname);
+    if (varindex < 0)
+      CCTK_VERROR("Unknown refinement criterion variable \"%s\"", varname);
+    const int gi = CCTK_GroupIndexFromVarI(varindex);
+    cGroup group;
+    int ierr = CCTK_GroupData(gi, &group);
+    assert(!ierr);
+    if (group.grouptype != CCTK_GF || group.vartype != CCTK_VARIABLE_REAL ||
+        get_group_indextype(gi) != array<int, dim>{1, 1, 1})
+      CCTK_VERROR("Refinement criterion variable \"%s\" must be a cell "
+                  "centred real grid function",
+                  varname);
+    assert(criteria.num_criteria < regrid_criteria_t::max_num_criteria);
+    const int n = criteria.num_criteria++;
+    criteria.varindices[n] = varindex;
+    criteria.kinds[n] = kind;
+    criteria.thresholds[n] = threshold;
+  };
+
+  if (use_regrid_error)
+    add_criterion("CarpetX::regrid_error", criterion_kind_t::value,
+                  regrid_error_threshold);
+  for (int n = 0; n < regrid_criteria_t::max_num_criteria - 1; ++n) {
+    if (!*regrid_criteria_vars[n])
+      continue;
+    criterion_kind_t kind;
+    if (CCTK_EQUALS(regrid_criteria_kinds[n], "value"))
+      kind = criterion_kind_t::value;
+    else if (CCTK_EQUALS(regrid_criteria_kinds[n], "gradient"))
+      kind = criterion_kind_t::gradient;
+    else if (CCTK_EQUALS(regrid_criteria_kinds[n], "laplacian"))
+      kind = criterion_kind_t::laplacian;
+    else
+      assert(0);
+    add_criterion(regrid_criteria_vars[n], kind,
+                  regrid_criteria_thresholds[n]);
+  }
+
+  return criteria;
+}
+} // namespace
+
 void CactusAmrCore::ErrorEst(const int level, amrex::TagBoxArray &tags,
                              const amrex::Real time, const int ngrow) {
   DECLARE_CCTK_PARAMETERS;
 
-  auto &restrict patchdata = ghext->patchdata.at(patch);
-
   // Don't regrid before Cactus is ready to
   if (!cactus_is_initialized)
     return;
@@ -1559,58 +1741,102 @@ void CactusAmrCore::ErrorEst(const int level, amrex::TagBoxArray &tags,
 #pragma omp critical
     CCTK_VINFO("ErrorEst patch %d level %d", patch, level);
 
-  const int gi = CCTK_GroupIndex("CarpetX::regrid_error");
-  assert(gi >= 0);
-  const int vi = 0;
+  const regrid_criteria_t criteria = get_regrid_criteria();
+
+  auto &restrict leveldata = ghext->patchdata.at(patch).leveldata.at(level);
   const int tl = 0;
 
-  auto &restrict leveldata = patchdata.leveldata.at(level);
-  auto &restrict groupdata = *leveldata.groupdata.at(gi);
-  // Ensure the error estimate has been set
-  error_if_invalid(groupdata, vi, tl, make_valid_int(),
-                   []() { return "ErrorEst"; });
-  std::size_t npoints_set = 0, npoints_clear = 0, npoints_total = 0;
-  auto mfitinfo = amrex::MFItInfo().SetDynamic(true).EnableTiling();
-#pragma omp parallel
-  for (amrex::MFIter mfi(*leveldata.fab, mfitinfo); mfi.isValid(); ++mfi) {
-    GridPtrDesc1 grid(leveldata, groupdata, mfi);
-
-    const amrex::Array4<const CCTK_REAL> &err_array4 =
-        groupdata.mfab.at(tl)->array(mfi);
-    const GF3D1<const CCTK_REAL> &err_ = grid.gf3d(err_array4, vi);
-    const amrex::Array4<char> &tags_array4 = tags.array(mfi);
-
-    std::size_t npoints_set_local = 0, npoints_clear_local = 0,
-                npoints_total_local = 0;
-    grid.loop_idx(
-        where_t::interior, groupdata.indextype, [&](const Loop::PointDesc &p) {
-          const int tag = err_(p.I) >= regrid_error_threshold
-                              ? amrex::TagBox::SET
-                              : amrex::TagBox::CLEAR;
-          npoints_set_local += tag == amrex::TagBox::SET;
-          npoints_clear_local += tag == amrex::TagBox::CLEAR;
-          ++npoints_total_local;
-          tags_array4(grid.cactus_offset.x + p.i, grid.cactus_offset.y + p.j,
-                      grid.cactus_offset.z + p.k) = tag;
-        });
-    // Do not set the boundary; AMReX's error grid function might have a
-    // different number of ghost zones, and these ghost zones are unused anyway.
-
-#pragma omp atomic update
-    npoints_set += npoints_set_local;
-#pragma omp atomic update
-    npoints_clear += npoints_clear_local;
-#pragma omp atomic update
-    npoints_total += npoints_total_local;
+  // Ensure the criteria have been set. Derivatives also need the
+  // ghost zones and outer boundaries.
+  for (int n = 0; n < criteria.num_criteria; ++n) {
+    const int varindex = criteria.varindices[n];
+    const int gi = CCTK_GroupIndexFromVarI(varindex);
+    const int vi = varindex - CCTK_FirstVarIndexI(gi);
+    const auto &restrict groupdata = *leveldata.groupdata.at(gi);
+    const valid_t required = criteria.kinds[n] == criterion_kind_t::value
+                                 ? make_valid_int()
+                                 : make_valid_all();
+    error_if_invalid(groupdata, vi, tl, required, []() { return "ErrorEst"; });
   }
 
-  if (verbose)
+  // Evaluate all criteria in a single pass over each tile
+  const active_levels_t active_levels(level, level + 1, patch, patch + 1);
+  active_levels.loop_parallel([&](int, int, const int index, int,
+                                  const cGH *restrict const cctkGH) {
+    const Loop::GridDescBaseDevice grid(cctkGH);
+    const array<int, dim> indextype{1, 1, 1};
+    const Loop::GF3D2layout layout(cctkGH, indextype);
+    // All criteria are cell centred and thus share their layout
+    const CCTK_REAL *restrict ptrs[regrid_criteria_t::max_num_criteria];
+    for (int n = 0; n < criteria.num_criteria; ++n)
+      ptrs[n] = static_cast<const CCTK_REAL *>(
+          CCTK_VarDataPtrI(cctkGH, tl, criteria.varindices[n]));
+
+    // Offset between Cactus's local and AMReX's global indices
+    const amrex::IntVect offset =
+        leveldata.fab->box(index).smallEnd() - leveldata.fab->nGrowVect();
+    const amrex::Array4<char> &tags_array4 = tags.array(index);
+
+    grid.loop_device_idx<where_t::interior>(
+        indextype, grid.nghostzones,
+        [=] CCTK_DEVICE(const Loop::PointDesc &p)
+            CCTK_ATTRIBUTE_ALWAYS_INLINE {
+              const auto val = [&](const int n, const vect<int, dim> &I) {
+                return ptrs[n][layout.linear(I[0], I[1], I[2])];
+              };
+              bool refine = false;
+              for (int n = 0; n < criteria.num_criteria && !refine; ++n) {
+                CCTK_REAL err;
+                switch (criteria.kinds[n]) {
+                case criterion_kind_t::value:
+                  err = val(n, p.I);
+                  break;
+                case criterion_kind_t::gradient:
+                  // Undivided first derivative
+                  err = 0;
+                  for (int d = 0; d < dim; ++d) {
+                    using std::fabs, std::max;
+                    const auto DI = vect<int, dim>::unit(d);
+                    err = max(err,
+                              fabs(val(n, p.I + DI) - val(n, p.I - DI)) / 2);
+                  }
+                  break;
+                case criterion_kind_t::laplacian:
+                  // Undivided second derivative
+                  err = 0;
+                  for (int d = 0; d < dim; ++d) {
+                    using std::fabs;
+                    const auto DI = vect<int, dim>::unit(d);
+                    err += fabs(val(n, p.I - DI) - 2 * val(n, p.I) +
+                                val(n, p.I + DI));
+                  }
+                  break;
+                default:
+                  assert(0);
+                }
+                refine = err >= criteria.thresholds[n];
+              }
+              tags_array4(offset[0] + p.i, offset[1] + p.j,
+                          offset[2] + p.k) =
+                  refine ? amrex::TagBox::SET : amrex::TagBox::CLEAR;
+            });
+    // Do not set the boundary; AMReX's error grid function might have
+    // a different number of ghost zones, and these ghost zones are
+    // unused anyway.
+  });
+  synchronize();
+
+  if (verbose) {
+    const std::size_t npoints_total = leveldata.fab->boxArray().numPts();
+    const std::size_t npoints_set = tags.numTags();
+    const std::size_t npoints_clear = npoints_total - npoints_set;
 #pragma omp critical
     CCTK_VINFO("ErrorEst patch %d level %d done. "
                "Set/clear/total=%td/%td/%td=%.0f%%/%.0f%%/%.0f%%",
                patch, level, npoints_set, npoints_clear, npoints_total,
                100.0 * npoints_set / npoints_total,
                100.0 * npoints_clear / npoints_total, 100.0);
+  }
 }
 
 void SetupGlobals() {
@@ -1729,6 +1955,33 @@ void CactusAmrCore::SetupLevel(const int level, const amrex::BoxArray &ba,
   // Initialize data
   const auto &leveldata = patchdata.leveldata.at(level);
   const int numgroups = CCTK_NumGroups();
+
+  if (numa_aware && !poison_undefined_values) {
+    // Touch the data on the threads that will later access them, so
+    // that their pages are placed on the respective NUMA domains.
+    // (Poisoning touches the data in the same way.)
+    active_levels.loop_parallel([&](int, int, int, int,
+                                     const cGH *restrict const cctkGH) {
+      const Loop::GridDescBaseDevice grid(cctkGH);
+      for (int gi = 0; gi < numgroups; ++gi) {
+        if (CCTK_GroupTypeI(gi) != CCTK_GF)
+          continue;
+        const auto &restrict groupdata = *leveldata.groupdata.at(gi);
+        const Loop::GF3D2layout layout(cctkGH, groupdata.indextype);
+        for (int tl = 0; tl < int(groupdata.mfab.size()); ++tl) {
+          for (int vi = 0; vi < groupdata.numvars; ++vi) {
+            const Loop::GF3D2<CCTK_REAL> gf(
+                layout, static_cast<CCTK_REAL *>(CCTK_VarDataPtrI(
+                            cctkGH, tl, groupdata.firstvarindex + vi)));
+            grid.loop_idx(where_t::everywhere, groupdata.indextype,
+                          groupdata.nghostzones,
+                          [&](const Loop::PointDesc &p) { gf(p.I) = 0; });
+          }
+        }
+      }
+    });
+  }
+
   for (int gi = 0; gi < numgroups; ++gi) {
     cGroup group;
     int ierr = CCTK_GroupData(gi, &group);
@@ -1749,6 +2002,73 @@ void CactusAmrCore::SetupLevel(const int level, const amrex::BoxArray &ba,
     CCTK_VINFO("SetupLevel patch %d level %d done.", patch, level);
 }
 
+amrex::DistributionMapping
+CactusAmrCore::MakeDistributionMap(const int level, const amrex::BoxArray &ba) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (CCTK_EQUALS(load_balance_cost, "cells"))
+    return amrex::AmrCore::MakeDistributionMap(level, ba);
+  assert(CCTK_EQUALS(load_balance_cost, "measured"));
+
+  // Use the measured costs of the old grid of this level, or of the
+  // next coarser level if this level is new
+  const GHExt::PatchData &patchdata = ghext->patchdata.at(patch);
+  const int cost_level = min(level, int(patchdata.leveldata.size()) - 1);
+  if (cost_level < 0)
+    return amrex::AmrCore::MakeDistributionMap(level, ba);
+  const GHExt::PatchData::LevelData &leveldata =
+      patchdata.leveldata.at(cost_level);
+
+  // Each process measured only the components it owns
+  vector<double> costs = leveldata.box_costs;
+  MPI_Allreduce(MPI_IN_PLACE, costs.data(), costs.size(), MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+  double total_cost = 0;
+  for (const double cost : costs)
+    total_cost += cost;
+  // Nothing has been measured yet
+  if (total_cost <= 0)
+    return amrex::AmrCore::MakeDistributionMap(level, ba);
+
+  // Estimate the cost of each new box from the cost per cell of the
+  // old boxes it overlaps. Cells not covered by old boxes use the
+  // average cost per cell.
+  const amrex::BoxArray &oldba = leveldata.fab->boxArray();
+  const double avg_cell_cost = total_cost / oldba.numPts();
+  amrex::Vector<amrex::Real> rcosts(ba.size());
+  for (int n = 0; n < int(ba.size()); ++n) {
+    const amrex::Box &box = ba[n];
+    double cost = 0;
+    amrex::Long covered = 0;
+    if (cost_level == level) {
+      for (const auto &isect : oldba.intersections(box)) {
+        const int m = isect.first;
+        const amrex::Box &overlap = isect.second;
+        cost += costs.at(m) / oldba[m].numPts() * overlap.numPts();
+        covered += overlap.numPts();
+      }
+    }
+    cost += avg_cell_cost * (box.numPts() - covered);
+    rcosts[n] = cost;
+  }
+
+  amrex::Real efficiency;
+  amrex::DistributionMapping dm;
+  if (CCTK_EQUALS(load_balance_method, "knapsack"))
+    dm = amrex::DistributionMapping::makeKnapSack(rcosts, efficiency);
+  else if (CCTK_EQUALS(load_balance_method, "sfc"))
+    dm = amrex::DistributionMapping::makeSFC(rcosts, ba, efficiency);
+  else
+    assert(0);
+
+  if (verbose)
+    CCTK_VINFO("Load balancing patch %d level %d by measured cost: "
+               "efficiency %g",
+               patch, level, double(efficiency));
+
+  return dm;
+}
+
 void CactusAmrCore::MakeNewLevelFromScratch(
     int level, amrex::Real time, const amrex::BoxArray &ba,
     const amrex::DistributionMapping &dm) {
@@ -1774,13 +2094,11 @@ void CactusAmrCore::MakeNewLevelFromCoarse(
 #pragma omp critical
     CCTK_VINFO("MakeNewLevelFromCoarse patch %d level %d", patch, level);
 
-  assert(!use_subcycling_wip);
   assert(level > 0);
 
   SetupLevel(level, ba, dm, []() { return "MakeNewLevelFromCoarse"; });
 
   // Prolongate
-  assert(!use_subcycling_wip);
   auto &patchdata = ghext->patchdata.at(patch);
   auto &leveldata = patchdata.leveldata.at(level);
   auto &coarseleveldata = patchdata.leveldata.at(level - 1);
@@ -1788,6 +2106,10 @@ void CactusAmrCore::MakeNewLevelFromCoarse(
   const active_levels_t active_coarse_levels(level - 1, level, patch,
                                              patch + 1);
 
+  // Prolongate all groups and time levels at the same time so that
+  // their communication overlaps
+  task_manager tasks2;
+
   const int num_groups = CCTK_NumGroups();
   for (int gi = 0; gi < num_groups; ++gi) {
     cGroup group;
@@ -1833,7 +2155,7 @@ void CactusAmrCore::MakeNewLevelFromCoarse(
           });
         }
         FillPatch_NewLevel(
-            groupdata, coarsegroupdata, *groupdata.mfab.at(tl),
+            tasks2, groupdata, coarsegroupdata, *groupdata.mfab.at(tl),
             *coarsegroupdata.mfab.at(tl), patchdata.amrcore->Geom(level - 1),
             patchdata.amrcore->Geom(level), interpolator, groupdata.bcrecs);
         const auto outer_valid =
@@ -1851,14 +2173,32 @@ void CactusAmrCore::MakeNewLevelFromCoarse(
           // });
         }
       }
+    } // for tl
 
-      // Already poisoned by SetupLevel
+  } // for gi
+
+  tasks2.run_tasks_serially();
+  synchronize();
+
+  for (int gi = 0; gi < num_groups; ++gi) {
+    cGroup group;
+    int ierr = CCTK_GroupData(gi, &group);
+    assert(!ierr);
+
+    if (group.grouptype != CCTK_GF)
+      continue;
+
+    const auto &restrict groupdata = *leveldata.groupdata.at(gi);
+    const nan_handling_t nan_handling = groupdata.do_checkpoint
+                                            ? nan_handling_t::forbid_nans
+                                            : nan_handling_t::allow_nans;
+
+    // Already poisoned by SetupLevel
+    for (int tl = 0; tl < int(groupdata.mfab.size()); ++tl)
       for (int vi = 0; vi < groupdata.numvars; ++vi)
         check_valid_gf(active_levels, gi, vi, tl, nan_handling, []() {
           return "MakeNewLevelFromCoarse after prolongation";
         });
-    } // for tl
-
   } // for gi
 
   if (verbose)
@@ -1883,8 +2223,21 @@ void CactusAmrCore::RemakeLevel(const int level, const amrex::Real time,
   const active_levels_t active_coarse_levels(level - 1, level, patch,
                                              patch + 1);
 
-  // Copy or prolongate
-  assert(!use_subcycling_wip);
+  const amrex::BoxArray oldba = leveldata.fab->boxArray();
+  const amrex::DistributionMapping olddm = leveldata.fab->DistributionMap();
+
+  // Keep the level as is (including its valid state) if neither its
+  // boxes nor their owners changed
+  if (ba == oldba && dm == olddm) {
+    if (verbose)
+#pragma omp critical
+      CCTK_VINFO("RemakeLevel patch %d level %d unchanged.", patch, level);
+    return;
+  }
+
+  // Copy or prolongate. With subcycling, regridding happens only at
+  // the end of a coarse time step when all levels are at the same
+  // time, so that no time interpolation is needed here.
 
   // Check old level
   const int num_groups = CCTK_NumGroups();
@@ -1946,6 +2299,50 @@ void CactusAmrCore::RemakeLevel(const int level, const amrex::Real time,
   using std::swap;
   swap(oldleveldata, leveldata);
 
+  // Find the boxes that did not change, i.e. that have the same extent
+  // and owner as a box of the old level. Their data are moved to the
+  // new level without copying. Only the remaining boxes are filled by
+  // copying from the old level and prolongating.
+  std::map<amrex::Box, int> oldboxes;
+  for (int j = 0; j < int(oldba.size()); ++j)
+    oldboxes[oldba[j]] = j;
+  vector<int> oldindex(ba.size(), -1); // [new box index]
+  amrex::BoxList changed_boxes;
+  amrex::Vector<int> changed_owners;
+  vector<int> changed_index; // [changed box index]
+  for (int i = 0; i < int(ba.size()); ++i) {
+    const auto it = oldboxes.find(ba[i]);
+    if (it != oldboxes.end() && olddm[it->second] == dm[i]) {
+      oldindex.at(i) = it->second;
+    } else {
+      changed_boxes.push_back(ba[i]);
+      changed_owners.push_back(dm[i]);
+      changed_index.push_back(i);
+    }
+  }
+  const int num_retained_boxes = int(ba.size()) - int(changed_index.size());
+  const bool have_retained_boxes = num_retained_boxes > 0;
+  if (verbose)
+#pragma omp critical
+    CCTK_VINFO("RemakeLevel patch %d level %d: retaining %d of %d boxes",
+               patch, level, num_retained_boxes, int(ba.size()));
+  amrex::BoxArray changed_ba;
+  amrex::DistributionMapping changed_dm;
+  if (have_retained_boxes && !changed_index.empty()) {
+    changed_ba = amrex::BoxArray(changed_boxes);
+    changed_dm = amrex::DistributionMapping(changed_owners);
+  }
+
+  // Copy from same level and/or prolongate from next coarser level.
+  // All groups and time levels are filled at the same time so that
+  // their communication overlaps. If there are retained boxes, fill
+  // only the changed boxes; this needs to happen before the retained
+  // boxes are moved out of the old level.
+  task_manager tasks2;
+  task_manager tasks3;
+  // [gi][tl]
+  vector<vector<unique_ptr<amrex::MultiFab> > > changed_mfabs(num_groups);
+
   for (int gi = 0; gi < num_groups; ++gi) {
     cGroup group;
     int ierr = CCTK_GroupData(gi, &group);
@@ -1961,6 +2358,102 @@ void CactusAmrCore::RemakeLevel(const int level, const amrex::Real time,
     amrex::Interpolater *const interpolator =
         get_interpolator(groupdata.indextype);
 
+    const int ntls = groupdata.mfab.size();
+    // We only prolongate the state vector. And if there is more than
+    // one time level, then we don't prolongate the oldest.
+    const int prolongate_tl =
+        groupdata.do_checkpoint ? (ntls > 1 ? ntls - 1 : ntls) : 0;
+
+    changed_mfabs.at(gi).resize(prolongate_tl);
+    for (int tl = 0; tl < prolongate_tl; ++tl) {
+      amrex::MultiFab &mfab = *groupdata.mfab.at(tl);
+      amrex::MultiFab *fill_mfab = &mfab;
+      if (have_retained_boxes) {
+        if (changed_index.empty())
+          continue;
+        auto &changed_mfab = changed_mfabs.at(gi).at(tl);
+        changed_mfab = make_unique<amrex::MultiFab>(
+            amrex::convert(changed_ba, mfab.ixType()), changed_dm,
+            mfab.nComp(), mfab.nGrowVect());
+        fill_mfab = changed_mfab.get();
+      }
+      FillPatch_RemakeLevel(tasks2, tasks3, groupdata, coarsegroupdata,
+                            *fill_mfab, *coarsegroupdata.mfab.at(tl),
+                            *oldgroupdata.mfab.at(tl),
+                            patchdata.amrcore->Geom(level - 1),
+                            patchdata.amrcore->Geom(level), interpolator,
+                            groupdata.bcrecs);
+    } // for tl
+
+  } // for gi
+
+  tasks2.run_tasks_serially();
+  synchronize();
+  tasks3.run_tasks_serially();
+  synchronize();
+
+  if (have_retained_boxes) {
+    // Move the retained boxes and the filled changed boxes into the
+    // new level. The ghost zones of the retained boxes still hold the
+    // values of the old level, which are wrong where the neighbouring
+    // boxes changed. Synchronize all ghost zones again.
+    task_manager tasks4;
+    task_manager tasks5;
+
+    for (int gi = 0; gi < num_groups; ++gi) {
+      cGroup group;
+      int ierr = CCTK_GroupData(gi, &group);
+      assert(!ierr);
+
+      if (group.grouptype != CCTK_GF)
+        continue;
+
+      auto &restrict groupdata = *leveldata.groupdata.at(gi);
+      auto &restrict oldgroupdata = *oldleveldata.groupdata.at(gi);
+      auto &restrict coarsegroupdata = *coarseleveldata.groupdata.at(gi);
+      amrex::Interpolater *const interpolator =
+          get_interpolator(groupdata.indextype);
+
+      const int prolongate_tl = changed_mfabs.at(gi).size();
+      for (int tl = 0; tl < prolongate_tl; ++tl) {
+        amrex::MultiFab &mfab = *groupdata.mfab.at(tl);
+        amrex::MultiFab &oldmfab = *oldgroupdata.mfab.at(tl);
+        const auto &changed_mfab = changed_mfabs.at(gi).at(tl);
+
+        for (const int i : mfab.IndexArray())
+          if (oldindex.at(i) >= 0)
+            swap(mfab[i], oldmfab[oldindex.at(i)]);
+        if (changed_mfab)
+          for (const int k : changed_mfab->IndexArray())
+            swap(mfab[changed_index.at(k)], (*changed_mfab)[k]);
+
+        FillPatch_ProlongateGhosts(tasks4, tasks5, groupdata, coarsegroupdata,
+                                   mfab, *coarsegroupdata.mfab.at(tl),
+                                   patchdata.amrcore->Geom(level),
+                                   patchdata.amrcore->Geom(level - 1),
+                                   interpolator, groupdata.bcrecs);
+      } // for tl
+
+      // The data of the moved boxes live elsewhere in memory
+      leveldata.update_local_cctkGHs_data(gi);
+    } // for gi
+
+    tasks4.run_tasks_serially();
+    synchronize();
+    tasks5.run_tasks_serially();
+    synchronize();
+  }
+
+  for (int gi = 0; gi < num_groups; ++gi) {
+    cGroup group;
+    int ierr = CCTK_GroupData(gi, &group);
+    assert(!ierr);
+
+    if (group.grouptype != CCTK_GF)
+      continue;
+
+    auto &restrict groupdata = *leveldata.groupdata.at(gi);
+
     const auto outer_valid = groupdata.all_faces_have_symmetries_or_boundaries()
                                  ? make_valid_outer()
                                  : valid_t();
@@ -1971,25 +2464,14 @@ void CactusAmrCore::RemakeLevel(const int level, const amrex::Real time,
                                             : nan_handling_t::allow_nans;
 
     const int ntls = groupdata.mfab.size();
-    // We only prolongate the state vector. And if there is more than
-    // one time level, then we don't prolongate the oldest.
-    const int prolongate_tl =
-        groupdata.do_checkpoint ? (ntls > 1 ? ntls - 1 : ntls) : 0;
+    const int prolongate_tl = changed_mfabs.at(gi).size();
 
     for (int tl = 0; tl < ntls; ++tl) {
-      if (tl < prolongate_tl) {
-        // Copy from same level and/or prolongate from next coarser level
-        FillPatch_RemakeLevel(
-            groupdata, coarsegroupdata, *groupdata.mfab.at(tl),
-            *coarsegroupdata.mfab.at(tl), *oldgroupdata.mfab.at(tl),
-            patchdata.amrcore->Geom(level - 1), patchdata.amrcore->Geom(level),
-            interpolator, groupdata.bcrecs);
-
+      if (tl < prolongate_tl)
         for (int vi = 0; vi < groupdata.numvars; ++vi)
           groupdata.valid.at(tl).at(vi) =
               why_valid_t(make_valid_int() | make_valid_ghosts() | outer_valid,
                           []() { return "RemakeLevel after prolongation"; });
-      }
 
       for (int vi = 0; vi < groupdata.numvars; ++vi) {
         poison_invalid_gf(active_levels, gi, vi, tl);
@@ -2403,8 +2885,9 @@ void *SetupGH(tFleshConfig *fc, int convLevel, cGH *restrict cctkGH) {
   pp.add("amr.blocking_factor_y", blocking_factor_y);
   pp.add("amr.blocking_factor_z", blocking_factor_z);
   pp.add("amr.grid_eff", grid_efficiency);
-  if (poison_undefined_values) {
-    // Tell AMReX to initialize FArrayBoxes with nans
+  if (poison_undefined_values && !numa_aware) {
+    // Tell AMReX to initialize FArrayBoxes with nans. (With NUMA-aware
+    // placement, data are poisoned later by the threads using them.)
     pp.add("fab.do_initval", true);
     pp.add("fab.init_snan", true);
     amrex::FArrayBox::set_do_initval(true);
@@ -2487,6 +2970,7 @@ int ScheduleTraverseGH(cGH *restrict cctkGH, const char *where) {
 // Shut down driver
 void ShutdownADIOS2();
 void ShutdownOpenPMD();
+void ShutdownSlices();
 extern "C" int CarpetX_Shutdown() {
   DECLARE_CCTK_PARAMETERS;
 
@@ -2497,6 +2981,7 @@ extern "C" int CarpetX_Shutdown() {
   // Shut down ADIOS2
   ShutdownADIOS2();
   ShutdownOpenPMD();
+  ShutdownSlices();
 
   if (false) {
     // Should we really do this? Cactus's extension handling mechanism
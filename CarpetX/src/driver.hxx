@@ -69,6 +69,8 @@ static_assert(is_same<amrex::Real, CCTK_REAL>::value,
 // AMR driver
 class CactusAmrCore final : public amrex::AmrCore {
   int patch;
+  // AMReX's buffer width around tagged cells (amr.n_error_buf)
+  amrex::Vector<amrex::IntVect> default_n_error_buf;
 
 public:
   bool cactus_is_initialized = false;
@@ -89,6 +91,8 @@ public:
 
   virtual ~CactusAmrCore() override;
 
+  virtual void regrid(int lbase, amrex::Real time,
+                      bool initial = false) override;
   virtual void ErrorEst(int level, amrex::TagBoxArray &tags, amrex::Real time,
                         int ngrow) override;
   void SetupLevel(int level, const amrex::BoxArray &ba,
@@ -101,6 +105,8 @@ public:
   virtual void
   MakeNewLevelFromCoarse(int level, amrex::Real time, const amrex::BoxArray &ba,
                          const amrex::DistributionMapping &dm) override;
+  virtual amrex::DistributionMapping
+  MakeDistributionMap(int level, const amrex::BoxArray &ba) override;
   virtual void RemakeLevel(int level, amrex::Real time,
                            const amrex::BoxArray &ba,
                            const amrex::DistributionMapping &dm) override;
@@ -239,14 +245,29 @@ struct GHExt {
       // and its distribution over all processes, but holds no data.
       unique_ptr<amrex::FabArrayBase> fab;
 
+      // The cctkGHs for patch and local mode are set up once when the
+      // level is created. Only the time-dependent fields (see
+      // `update_cctkGH`) and, when data move in memory, the grid
+      // function pointers (see `update_local_cctkGHs_data`) change.
       cctkGHptr patch_cctkGH;
       vector<cctkGHptr> local_cctkGHs; // [component]
+      // The FAB index of each component, so that loops over components
+      // do not need to set up an MFIter
+      vector<int> component_indices; // [component]
+
+      // Measured run time of local-mode scheduled functions on the
+      // components owned by this process, used for load balancing
+      vector<double> box_costs; // [fab index]
 
       cGH *get_patch_cctkGH() const { return patch_cctkGH.get(); }
       cGH *get_local_cctkGH(const int component) const {
         return local_cctkGHs.at(component).get();
       }
 
+      // Point the local cctkGHs to the current data of a grid function
+      // group, e.g. after its time levels were cycled
+      void update_local_cctkGHs_data(int gi) const;
+
       struct GroupData : public CommonGroupData {
         GroupData() = delete;
         GroupData(const GroupData &) = delete;
@@ -276,6 +297,13 @@ struct GHExt {
         // each amrex::MultiFab has numvars components
         vector<unique_ptr<amrex::MultiFab> > mfab; // [time level]
 
+        // State of the current time level before the most recent time
+        // step of this level (interior only). This is kept only for
+        // evolved groups on levels that have a finer subcycling level,
+        // which interpolates in time between this and the current
+        // state when prolongating its ghost zones.
+        unique_ptr<amrex::MultiFab> mfab_old;
+
         // flux register between this and the next coarser level
         unique_ptr<amrex::FluxRegister> freg;
         // associated flux group indices
@@ -1,6 +1,7 @@
 #include "fillpatch.hxx"
 #include "schedule.hxx"
 
+#include <memory>
 #include <utility>
 
 #include <AMReX_FillPatchUtil.H>
@@ -139,6 +140,7 @@ void FillPatch_ProlongateGhosts(
 
 
 void FillPatch_NewLevel(
+    task_manager &tasks2,
     const GHExt::PatchData::LevelData::GroupData &groupdata,
     const GHExt::PatchData::LevelData::GroupData &coarsegroupdata,
     MultiFab &mfab, const MultiFab &cmfab, const Geometry &cgeom,
@@ -170,20 +172,40 @@ void FillPatch_NewLevel(
     box &= fdomain_g;
     cba_g.set(i, coarsener.doit(box));
   }
-  MultiFab cmfab_g(cba_g, dm, ncomps, 0);
+
+  // Copy parts of coarse grid into temporary buffer
+  MultiFab *const cmfab_g_ptr = new MultiFab(cba_g, dm, ncomps, 0);
+  MultiFab &cmfab_g = *cmfab_g_ptr;
   mf_set_domain_bndry(cmfab_g, cgeom);
 
-  cmfab_g.ParallelCopy(cmfab, 0, 0, ncomps, cgeom.periodicity());
+  // This is not local
+  cmfab_g.ParallelCopy_nowait(cmfab, 0, 0, ncomps, IntVect{0}, IntVect{0},
+                              cgeom.periodicity());
+
+  tasks2.submit_serially([&groupdata, &coarsegroupdata, &mfab, &cgeom, &fgeom,
+                          mapper, &bcrecs, fdomain_g, cmfab_g_ptr]() {
+    const int ncomps = mfab.nComp();
+    const IntVect ratio{2, 2, 2};
+    const IntVect &nghosts = mfab.nGrowVect();
+    MultiFab &cmfab_g = *cmfab_g_ptr;
+
+    // Finish copying parts of coarse grid into temporary buffer
+    cmfab_g.ParallelCopy_finish();
+
+    coarsegroupdata.apply_boundary_conditions(cmfab_g);
 
-  coarsegroupdata.apply_boundary_conditions(cmfab_g);
+    // Interpolate coarse buffer into destination (in space, local)
+    FillPatchInterp(mfab, 0, cmfab_g, 0, ncomps, nghosts, cgeom, fgeom,
+                    fdomain_g, ratio, mapper, bcrecs, 0);
 
-  FillPatchInterp(mfab, 0, cmfab_g, 0, ncomps, nghosts, cgeom, fgeom, fdomain_g,
-                  ratio, mapper, bcrecs, 0);
+    delete cmfab_g_ptr;
 
-  groupdata.apply_boundary_conditions(mfab);
+    groupdata.apply_boundary_conditions(mfab);
+  });
 }
 
 void FillPatch_RemakeLevel(
+    task_manager &tasks2, task_manager &tasks3,
     const GHExt::PatchData::LevelData::GroupData &groupdata,
     const GHExt::PatchData::LevelData::GroupData &coarsegroupdata,
     MultiFab &mfab, const MultiFab &cmfab, const MultiFab &fmfab,
@@ -199,32 +221,82 @@ void FillPatch_RemakeLevel(
   const FabArrayBase::FPinfo &fpc = FabArrayBase::TheFPinfo(
       fmfab, mfab, nghosts, coarsener, fgeom, cgeom, index_space);
 
-  if (!fpc.ba_crse_patch.empty()) {
-    MultiFab mfab_crse_patch = make_mf_crse_patch<MultiFab>(fpc, ncomps);
-    mf_set_domain_bndry(mfab_crse_patch, cgeom);
+  if (fpc.ba_crse_patch.empty()) {
+    // There is no prolongation. Copy from the old fine level.
+    mfab.ParallelCopy_nowait(fmfab, 0, 0, ncomps,
+                             IntVect{0} /* don't use old ghosts */, nghosts,
+                             fgeom.periodicity());
+
+    tasks2.submit_serially([&groupdata, &mfab]() {
+      // Finish copying from the old fine level
+      mfab.ParallelCopy_finish();
+
+      // Apply symmetry and boundary conditions
+      groupdata.apply_boundary_conditions(mfab);
+    });
+    return;
+  }
+
+  // Copy parts of coarse grid into temporary buffer
+  const auto mfab_crse_patch_ptr =
+      std::make_shared<MultiFab>(make_mf_crse_patch<MultiFab>(fpc, ncomps));
+  MultiFab &mfab_crse_patch = *mfab_crse_patch_ptr;
+  mf_set_domain_bndry(mfab_crse_patch, cgeom);
+
+  // This is not local
+  mfab_crse_patch.ParallelCopy_nowait(
+      cmfab, 0, 0, ncomps, IntVect{0} /* don't use coarse ghosts */,
+      mfab_crse_patch.nGrowVect(), cgeom.periodicity());
+
+  tasks2.submit_serially([&tasks3, &groupdata, &coarsegroupdata, &mfab, &fmfab,
+                          &cgeom, &fgeom, mapper, &bcrecs, &fpc,
+                          mfab_crse_patch_ptr]() {
+    const IntVect &nghosts = mfab.nGrowVect();
+    const int ncomps = mfab.nComp();
+    const IntVect ratio{2, 2, 2};
+    MultiFab &mfab_crse_patch = *mfab_crse_patch_ptr;
+
+    // Finish copying parts of coarse grid into temporary buffer
+    mfab_crse_patch.ParallelCopy_finish();
 
-    mfab_crse_patch.ParallelCopy(
-        cmfab, 0, 0, ncomps, IntVect{0} /* don't use coarse ghosts */,
-        mfab_crse_patch.nGrowVect(), cgeom.periodicity());
     coarsegroupdata.apply_boundary_conditions(mfab_crse_patch);
 
-    MultiFab mfab_fine_patch = make_mf_fine_patch<MultiFab>(fpc, ncomps);
+    const auto mfab_fine_patch_ptr =
+        std::make_shared<MultiFab>(make_mf_fine_patch<MultiFab>(fpc, ncomps));
+    MultiFab &mfab_fine_patch = *mfab_fine_patch_ptr;
 
-    // In space, local
+    // Interpolate coarse buffer into fine buffer (in space, local)
     FillPatchInterp(mfab_fine_patch, 0, mfab_crse_patch, 0, ncomps,
                     IntVect{0} /* don't add any new ghosts */, cgeom, fgeom,
                     grow(convert(fgeom.Domain(), mfab.ixType()), nghosts),
                     ratio, mapper, bcrecs, 0);
 
+    // Copy fine buffer into destination
     mfab.ParallelCopy_nowait(
         mfab_fine_patch, 0, 0, ncomps,
         IntVect{0} /* don't use any ghosts from the buffer */, nghosts);
-    mfab.ParallelCopy_finish();
-  }
 
-  mfab.ParallelCopy(fmfab, 0, 0, ncomps, IntVect{0} /* don't use old ghosts */,
-                    nghosts, fgeom.periodicity());
-  groupdata.apply_boundary_conditions(mfab);
+    tasks3.submit_serially(
+        [&groupdata, &mfab, &fmfab, &fgeom, mfab_fine_patch_ptr]() {
+          const IntVect &nghosts = mfab.nGrowVect();
+          const int ncomps = mfab.nComp();
+
+          // Finish copying fine buffer into destination
+          mfab.ParallelCopy_finish();
+
+          // Copy from the old fine level. The fine buffer also covers
+          // ghost zones that are periodic images of old fine points;
+          // this copy needs to come last so that the exact old values
+          // overwrite the interpolated ones there.
+          mfab.ParallelCopy_nowait(fmfab, 0, 0, ncomps,
+                                   IntVect{0} /* don't use old ghosts */,
+                                   nghosts, fgeom.periodicity());
+          mfab.ParallelCopy_finish();
+
+          // Apply symmetry and boundary conditions
+          groupdata.apply_boundary_conditions(mfab);
+        });
+  });
 }
 
 } // namespace CarpetX
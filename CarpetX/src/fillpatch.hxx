@@ -28,6 +28,7 @@ void FillPatch_ProlongateGhosts(
 // Prolongate and sync interior. Expects coarse mfab prolongated and
 // synced. ("InterpFromCoarseLevel")
 void FillPatch_NewLevel(
+    task_manager &tasks2,
     const GHExt::PatchData::LevelData::GroupData &groupdata,
     const GHExt::PatchData::LevelData::GroupData &coarsegroupdata,
     amrex::MultiFab &mfab, const amrex::MultiFab &cmfab,
@@ -36,6 +37,7 @@ void FillPatch_NewLevel(
 
 // ("FillPatchTwoLevels")
 void FillPatch_RemakeLevel(
+    task_manager &tasks2, task_manager &tasks3,
     const GHExt::PatchData::LevelData::GroupData &groupdata,
     const GHExt::PatchData::LevelData::GroupData &coarsegroupdata,
     amrex::MultiFab &mfab, const amrex::MultiFab &cmfab,
@@ -23,6 +23,12 @@ extern "C" CCTK_INT CarpetX_DriverInterpolate(
     CCTK_POINTER const output_arrays[]);
 
 namespace CarpetX {
+// Set while SyncGroupsByDirI calls MultiPatch_Interpolate. Multi-patch
+// boundaries are then interpolated at the same points in every
+// synchronization, and the distribution of these points onto the grid
+// is kept until the grid structure changes.
+extern bool interpolating_patch_boundaries;
+
 // a dummy routine for now
 // TODO: implement this for actual local interpolation
 int InterpLocalUniform(int N_dims, int param_table_handle,
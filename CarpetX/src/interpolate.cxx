@@ -22,6 +22,7 @@
 #include <cmath>
 #include <limits>
 #include <map>
+#include <memory>
 #include <set>
 #include <utility>
 #include <vector>
@@ -326,116 +327,65 @@ int InterpLocalUniform(int /*N_dims*/, int /*param_table_handle*/,
   CCTK_ERROR("Dummy InterpLocalUniform function called");
 }
 
-extern "C" CCTK_INT CarpetX_InterpGridArrays(
-    cGH const *const cctkGH, int const N_dims, int const local_interp_handle,
-    int const param_table_handle, int const coord_system_handle,
-    int const N_interp_points, int const interp_coords_type_code,
-    void const *const coords[], int const N_input_arrays,
-    CCTK_INT const input_array_variable_indices[], int const N_output_arrays,
-    CCTK_INT const output_array_type_codes[], void *const output_arrays[]) {
-  /* TODO: verify that the interface with SymmetryInterpolate can be simply
-     copied from Carpet like below */
-  //  if (CCTK_IsFunctionAliased("SymmetryInterpolate")) {
-  //    return SymmetryInterpolate(
-  //        cctkGH, N_dims, local_interp_handle, param_table_handle,
-  //        coord_system_handle, N_interp_points, interp_coords_type_code,
-  //        coords, N_input_arrays, input_array_variable_indices,
-  //        N_output_arrays, output_array_type_codes, output_arrays);
-  //  } else {
-  return CarpetX_DriverInterpolate(
-      cctkGH, N_dims, local_interp_handle, param_table_handle,
-      coord_system_handle, N_interp_points, interp_coords_type_code, coords,
-      N_input_arrays, input_array_variable_indices, N_output_arrays,
-      output_array_type_codes, output_arrays);
-  //  }
-}
-
-extern "C" CCTK_INT CarpetX_DriverInterpolate(
-    CCTK_POINTER_TO_CONST const cctkGH, CCTK_INT const N_dims,
-    CCTK_INT const local_interp_handle, CCTK_INT const param_table_handle,
-    CCTK_INT const coord_system_handle, CCTK_INT const N_interp_points,
-    CCTK_INT const interp_coords_type_code,
-    CCTK_POINTER_TO_CONST const coords[], CCTK_INT const N_input_arrays,
-    CCTK_INT const input_array_variable_indices[],
-    CCTK_INT const N_output_arrays, CCTK_INT const output_array_type_codes[],
-    CCTK_POINTER const output_arrays[]) {
-  DECLARE_CCTK_PARAMETERS;
+namespace {
 
-  // We do not support local interpolators yet
-  const int carpetx_interp_handle = CCTK_InterpHandle("CarpetX");
-  assert(carpetx_interp_handle >= 0);
-  if (carpetx_interp_handle != local_interp_handle) {
-    CCTK_VERROR("Incorrect local interpolator handle provided, only 'CarpetX' "
-                "is allowed: %d != %d",
-                local_interp_handle, carpetx_interp_handle);
+using Container = amrex::AmrParticleContainer<3, 2>;
+
+// The distribution of a set of interpolation points onto the grid.
+// Finding the owners of the points requires global communication.
+// Multi-patch boundaries are interpolated at the same points every
+// time they are synchronized, so we keep the distribution around
+// until the grid structure changes.
+struct interpolation_plan_t {
+  std::vector<CCTK_REAL> globalsx, globalsy, globalsz; // [npoints]
+  // Grid structure for which this plan is valid
+  std::vector<std::vector<amrex::BoxArray> > boxarrays;        // [patch][level]
+  std::vector<std::vector<amrex::DistributionMapping> > dmaps; // [patch][level]
+  std::vector<bool> symmetry_reflected_z; // [npoints]
+  std::vector<Container> containers;      // [patch]
+  // Number of points we return to and receive from each process
+  std::vector<int> sendnpoints, recvnpoints; // [nprocs]
+
+  bool matches(const CCTK_INT npoints, const CCTK_REAL *restrict const globalsx,
+               const CCTK_REAL *restrict const globalsy,
+               const CCTK_REAL *restrict const globalsz) const {
+    return int(this->globalsx.size()) == npoints &&
+           std::equal(this->globalsx.begin(), this->globalsx.end(),
+                      globalsx) &&
+           std::equal(this->globalsy.begin(), this->globalsy.end(),
+                      globalsy) &&
+           std::equal(this->globalsz.begin(), this->globalsz.end(), globalsz);
   }
+};
 
-  // This verifies that the order in param_table_handle matches the order of the
-  // runtime parameter from CarpetX
-  CCTK_INT order;
-  int n_elems = Util_TableGetInt(param_table_handle, &order, "order");
-  assert(n_elems == 1);
-  assert(order == interpolation_order);
+// Plans are kept in the same order on all processes
+std::vector<std::shared_ptr<interpolation_plan_t> > interpolation_plans;
 
-  std::vector<CCTK_INT> varinds;
-  varinds.resize(N_output_arrays);
-  n_elems = Util_TableGetIntArray(param_table_handle, N_output_arrays,
-                                  varinds.data(), "operand_indices");
-  if (n_elems == UTIL_ERROR_TABLE_NO_SUCH_KEY) {
-    assert(N_input_arrays == N_output_arrays);
-    for (int i = 0; i < N_input_arrays; i++) {
-      varinds.at(i) = input_array_variable_indices[i];
-    }
-  } else if (n_elems == N_output_arrays) {
-    for (int i = 0; i < n_elems; i++) {
-      varinds.at(i) = input_array_variable_indices[varinds.at(i)];
+void get_grid_structure(
+    std::vector<std::vector<amrex::BoxArray> > &boxarrays,
+    std::vector<std::vector<amrex::DistributionMapping> > &dmaps) {
+  boxarrays.resize(ghext->num_patches());
+  dmaps.resize(ghext->num_patches());
+  for (const auto &patchdata : ghext->patchdata) {
+    for (const auto &leveldata : patchdata.leveldata) {
+      boxarrays.at(patchdata.patch).push_back(leveldata.fab->boxArray());
+      dmaps.at(patchdata.patch).push_back(leveldata.fab->DistributionMap());
     }
-  } else {
-    CCTK_VERROR("TableGetIntArray failed with error code %d", n_elems);
-  }
-
-  std::vector<CCTK_INT> operations;
-  operations.resize(N_output_arrays, 0);
-  n_elems = Util_TableGetIntArray(param_table_handle, N_output_arrays,
-                                  operations.data(), "operation_codes");
-  if (n_elems == UTIL_ERROR_TABLE_NO_SUCH_KEY) {
-    assert(N_input_arrays == N_output_arrays);
-  } else if (n_elems != N_output_arrays) {
-    CCTK_ERROR("TableGetIntArray failed.");
   }
-
-  const CCTK_POINTER resultptrs = (CCTK_POINTER)output_arrays;
-  const bool allow_boundaries = true;
-  CarpetX_Interpolate(
-      cctkGH, N_interp_points, static_cast<const CCTK_REAL *>(coords[0]),
-      static_cast<const CCTK_REAL *>(coords[1]),
-      static_cast<const CCTK_REAL *>(coords[2]), N_output_arrays,
-      varinds.data(), operations.data(), allow_boundaries, resultptrs);
-
-  return 0;
 }
 
-extern "C" void CarpetX_Interpolate(const CCTK_POINTER_TO_CONST cctkGH_,
-                                    const CCTK_INT npoints,
-                                    const CCTK_REAL *restrict const globalsx,
-                                    const CCTK_REAL *restrict const globalsy,
-                                    const CCTK_REAL *restrict const globalsz,
-                                    const CCTK_INT nvars,
-                                    const CCTK_INT *restrict const varinds,
-                                    const CCTK_INT *restrict const operations,
-                                    const CCTK_INT allow_boundaries,
-                                    const CCTK_POINTER resultptrs_) {
+std::shared_ptr<interpolation_plan_t>
+make_interpolation_plan(const CCTK_INT npoints,
+                        const CCTK_REAL *restrict const globalsx,
+                        const CCTK_REAL *restrict const globalsy,
+                        const CCTK_REAL *restrict const globalsz) {
   DECLARE_CCTK_PARAMETERS;
-  const cGH *restrict const cctkGH = static_cast<const cGH *>(cctkGH_);
-  assert(in_global_mode(cctkGH));
 
   static const bool have_MultiPatch_GlobalToLocal2 =
       CCTK_IsFunctionAliased("MultiPatch_GlobalToLocal2");
 
   // Convert global to patch-local coordinates
   // TODO: Call this only if there is a non-trivial patch system
-  // TODO: Don't call this for multipatch interpolation, precalculate this
-  // instead
   std::vector<CCTK_INT> patches(npoints);
   std::vector<CCTK_REAL> localsx(npoints);
   std::vector<CCTK_REAL> localsy(npoints);
@@ -499,7 +449,6 @@ extern "C" void CarpetX_Interpolate(const CCTK_POINTER_TO_CONST cctkGH_,
   }
 
   // Create particle containers
-  using Container = amrex::AmrParticleContainer<3, 2>;
   using ParticleTile = Container::ParticleTileType;
   std::vector<Container> containers(ghext->num_patches());
   for (int patch = 0; patch < ghext->num_patches(); ++patch) {
@@ -615,6 +564,247 @@ extern "C" void CarpetX_Interpolate(const CCTK_POINTER_TO_CONST cctkGH_,
 #endif
   }
 
+  const auto plan = std::make_shared<interpolation_plan_t>();
+  plan->globalsx.assign(globalsx, globalsx + npoints);
+  plan->globalsy.assign(globalsy, globalsy + npoints);
+  plan->globalsz.assign(globalsz, globalsz + npoints);
+  get_grid_structure(plan->boxarrays, plan->dmaps);
+  plan->symmetry_reflected_z = std::move(symmetry_reflected_z);
+  plan->containers = std::move(containers);
+
+  // Count the points we return to each process, and find out how
+  // many points we will receive
+  const int nprocs = amrex::ParallelDescriptor::NProcs();
+  plan->sendnpoints.resize(nprocs, 0);
+  for (const auto &patchdata : ghext->patchdata) {
+    for (const auto &leveldata : patchdata.leveldata) {
+      for (amrex::ParConstIter<3, 2> pti(plan->containers.at(patchdata.patch),
+                                         leveldata.level);
+           pti.isValid(); ++pti)
+        for (const auto &particle : pti.GetArrayOfStructs())
+          ++plan->sendnpoints.at(particle.idata(0));
+    }
+  }
+  plan->recvnpoints.resize(nprocs);
+  const MPI_Comm comm = amrex::ParallelDescriptor::Communicator();
+  MPI_Alltoall(plan->sendnpoints.data(), 1, MPI_INT, plan->recvnpoints.data(),
+               1, MPI_INT, comm);
+
+  return plan;
+}
+
+std::shared_ptr<interpolation_plan_t>
+get_interpolation_plan(const CCTK_INT npoints,
+                       const CCTK_REAL *restrict const globalsx,
+                       const CCTK_REAL *restrict const globalsy,
+                       const CCTK_REAL *restrict const globalsz) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (interpolation_plan_cache_size == 0) {
+    interpolation_plans.clear();
+    return make_interpolation_plan(npoints, globalsx, globalsy, globalsz);
+  }
+
+  // Forget plans for outdated grid structures
+  std::vector<std::vector<amrex::BoxArray> > boxarrays;
+  std::vector<std::vector<amrex::DistributionMapping> > dmaps;
+  get_grid_structure(boxarrays, dmaps);
+  interpolation_plans.erase(
+      std::remove_if(interpolation_plans.begin(), interpolation_plans.end(),
+                     [&](const auto &plan) {
+                       return plan->boxarrays != boxarrays ||
+                              plan->dmaps != dmaps;
+                     }),
+      interpolation_plans.end());
+
+  // Look for an existing plan. Each process has different points, and
+  // we can only use a plan if it matches on all processes.
+  const int nplans = interpolation_plans.size();
+  std::vector<int> plan_matches(nplans);
+  for (int p = 0; p < nplans; ++p)
+    plan_matches.at(p) = interpolation_plans.at(p)->matches(
+        npoints, globalsx, globalsy, globalsz);
+  const MPI_Comm comm = amrex::ParallelDescriptor::Communicator();
+  MPI_Allreduce(MPI_IN_PLACE, plan_matches.data(), nplans, MPI_INT, MPI_LAND,
+                comm);
+  for (int p = 0; p < nplans; ++p)
+    if (plan_matches.at(p))
+      return interpolation_plans.at(p);
+
+  const auto plan =
+      make_interpolation_plan(npoints, globalsx, globalsy, globalsz);
+  while (int(interpolation_plans.size()) >= interpolation_plan_cache_size)
+    interpolation_plans.erase(interpolation_plans.begin());
+  interpolation_plans.push_back(plan);
+  return plan;
+}
+
+// Plans for multi-patch boundaries, identified by the centerings of the
+// interpolated variables
+std::map<std::set<std::array<int, dim> >,
+         std::shared_ptr<interpolation_plan_t> >
+    patch_boundary_plans;
+
+// Multi-patch boundaries are interpolated at the ghost points of the
+// interpolated variables. These points depend only on the grid
+// structure and on the centerings of the variables, which are the same
+// on all processes. Unlike `get_interpolation_plan`, this needs no
+// communication to find out whether a plan can be reused.
+std::shared_ptr<interpolation_plan_t>
+get_patch_boundary_plan(const CCTK_INT npoints,
+                        const CCTK_REAL *restrict const globalsx,
+                        const CCTK_REAL *restrict const globalsy,
+                        const CCTK_REAL *restrict const globalsz,
+                        const CCTK_INT nvars,
+                        const CCTK_INT *restrict const varinds) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (interpolation_plan_cache_size == 0) {
+    patch_boundary_plans.clear();
+    return make_interpolation_plan(npoints, globalsx, globalsy, globalsz);
+  }
+
+  std::set<std::array<int, dim> > centerings;
+  for (int n = 0; n < nvars; ++n) {
+    const int gi = CCTK_GroupIndexFromVarI(varinds[n]);
+    assert(gi >= 0);
+    const auto &groupdata =
+        *ghext->patchdata.at(0).leveldata.at(0).groupdata.at(gi);
+    centerings.insert(groupdata.indextype);
+  }
+
+  std::vector<std::vector<amrex::BoxArray> > boxarrays;
+  std::vector<std::vector<amrex::DistributionMapping> > dmaps;
+  get_grid_structure(boxarrays, dmaps);
+
+  auto &plan = patch_boundary_plans[centerings];
+  if (plan && plan->boxarrays == boxarrays && plan->dmaps == dmaps) {
+    if (!plan->matches(npoints, globalsx, globalsy, globalsz))
+      CCTK_VERROR("The multi-patch boundary points changed although the grid "
+                  "structure did not change");
+    return plan;
+  }
+
+  plan = make_interpolation_plan(npoints, globalsx, globalsy, globalsz);
+  return plan;
+}
+
+} // namespace
+
+bool interpolating_patch_boundaries = false;
+
+extern "C" CCTK_INT CarpetX_InterpGridArrays(
+    cGH const *const cctkGH, int const N_dims, int const local_interp_handle,
+    int const param_table_handle, int const coord_system_handle,
+    int const N_interp_points, int const interp_coords_type_code,
+    void const *const coords[], int const N_input_arrays,
+    CCTK_INT const input_array_variable_indices[], int const N_output_arrays,
+    CCTK_INT const output_array_type_codes[], void *const output_arrays[]) {
+  /* TODO: verify that the interface with SymmetryInterpolate can be simply
+     copied from Carpet like below */
+  //  if (CCTK_IsFunctionAliased("SymmetryInterpolate")) {
+  //    return SymmetryInterpolate(
+  //        cctkGH, N_dims, local_interp_handle, param_table_handle,
+  //        coord_system_handle, N_interp_points, interp_coords_type_code,
+  //        coords, N_input_arrays, input_array_variable_indices,
+  //        N_output_arrays, output_array_type_codes, output_arrays);
+  //  } else {
+  return CarpetX_DriverInterpolate(
+      cctkGH, N_dims, local_interp_handle, param_table_handle,
+      coord_system_handle, N_interp_points, interp_coords_type_code, coords,
+      N_input_arrays, input_array_variable_indices, N_output_arrays,
+      output_array_type_codes, output_arrays);
+  //  }
+}
+
+extern "C" CCTK_INT CarpetX_DriverInterpolate(
+    CCTK_POINTER_TO_CONST const cctkGH, CCTK_INT const N_dims,
+    CCTK_INT const local_interp_handle, CCTK_INT const param_table_handle,
+    CCTK_INT const coord_system_handle, CCTK_INT const N_interp_points,
+    CCTK_INT const interp_coords_type_code,
+    CCTK_POINTER_TO_CONST const coords[], CCTK_INT const N_input_arrays,
+    CCTK_INT const input_array_variable_indices[],
+    CCTK_INT const N_output_arrays, CCTK_INT const output_array_type_codes[],
+    CCTK_POINTER const output_arrays[]) {
+  DECLARE_CCTK_PARAMETERS;
+
+  // We do not support local interpolators yet
+  const int carpetx_interp_handle = CCTK_InterpHandle("CarpetX");
+  assert(carpetx_interp_handle >= 0);
+  if (carpetx_interp_handle != local_interp_handle) {
+    CCTK_VERROR("Incorrect local interpolator handle provided, only 'CarpetX' "
+                "is allowed: %d != %d",
+                local_interp_handle, carpetx_interp_handle);
+  }
+
+  // This verifies that the order in param_table_handle matches the order of the
+  // runtime parameter from CarpetX
+  CCTK_INT order;
+  int n_elems = Util_TableGetInt(param_table_handle, &order, "order");
+  assert(n_elems == 1);
+  assert(order == interpolation_order);
+
+  std::vector<CCTK_INT> varinds;
+  varinds.resize(N_output_arrays);
+  n_elems = Util_TableGetIntArray(param_table_handle, N_output_arrays,
+                                  varinds.data(), "operand_indices");
+  if (n_elems == UTIL_ERROR_TABLE_NO_SUCH_KEY) {
+    assert(N_input_arrays == N_output_arrays);
+    for (int i = 0; i < N_input_arrays; i++) {
+      varinds.at(i) = input_array_variable_indices[i];
+    }
+  } else if (n_elems == N_output_arrays) {
+    for (int i = 0; i < n_elems; i++) {
+      varinds.at(i) = input_array_variable_indices[varinds.at(i)];
+    }
+  } else {
+    CCTK_VERROR("TableGetIntArray failed with error code %d", n_elems);
+  }
+
+  std::vector<CCTK_INT> operations;
+  operations.resize(N_output_arrays, 0);
+  n_elems = Util_TableGetIntArray(param_table_handle, N_output_arrays,
+                                  operations.data(), "operation_codes");
+  if (n_elems == UTIL_ERROR_TABLE_NO_SUCH_KEY) {
+    assert(N_input_arrays == N_output_arrays);
+  } else if (n_elems != N_output_arrays) {
+    CCTK_ERROR("TableGetIntArray failed.");
+  }
+
+  const CCTK_POINTER resultptrs = (CCTK_POINTER)output_arrays;
+  const bool allow_boundaries = true;
+  CarpetX_Interpolate(
+      cctkGH, N_interp_points, static_cast<const CCTK_REAL *>(coords[0]),
+      static_cast<const CCTK_REAL *>(coords[1]),
+      static_cast<const CCTK_REAL *>(coords[2]), N_output_arrays,
+      varinds.data(), operations.data(), allow_boundaries, resultptrs);
+
+  return 0;
+}
+
+extern "C" void CarpetX_Interpolate(const CCTK_POINTER_TO_CONST cctkGH_,
+                                    const CCTK_INT npoints,
+                                    const CCTK_REAL *restrict const globalsx,
+                                    const CCTK_REAL *restrict const globalsy,
+                                    const CCTK_REAL *restrict const globalsz,
+                                    const CCTK_INT nvars,
+                                    const CCTK_INT *restrict const varinds,
+                                    const CCTK_INT *restrict const operations,
+                                    const CCTK_INT allow_boundaries,
+                                    const CCTK_POINTER resultptrs_) {
+  DECLARE_CCTK_PARAMETERS;
+  const cGH *restrict const cctkGH = static_cast<const cGH *>(cctkGH_);
+  assert(in_global_mode(cctkGH));
+
+  // Distribute the interpolation points
+  const auto plan =
+      interpolating_patch_boundaries
+          ? get_patch_boundary_plan(npoints, globalsx, globalsy, globalsz,
+                                    nvars, varinds)
+          : get_interpolation_plan(npoints, globalsx, globalsy, globalsz);
+  auto &containers = plan->containers;
+  const auto &symmetry_reflected_z = plan->symmetry_reflected_z;
+
   // Define result variables
   const int nprocs = amrex::ParallelDescriptor::NProcs();
   std::vector<std::vector<CCTK_REAL> > results(nprocs); // [nprocs]
@@ -810,9 +1000,12 @@ extern "C" void CarpetX_Interpolate(const CCTK_POINTER_TO_CONST cctkGH_,
     senddispls.at(p) = total_sendcount;
     total_sendcount += sendcounts.at(p);
   }
+  // The plan knows how many points we receive
   std::vector<int> recvcounts(nprocs);
-  MPI_Alltoall(sendcounts.data(), 1, MPI_INT, recvcounts.data(), 1, MPI_INT,
-               comm);
+  for (int p = 0; p < nprocs; ++p) {
+    assert(sendcounts.at(p) == (nvars + 1) * plan->sendnpoints.at(p));
+    recvcounts.at(p) = (nvars + 1) * plan->recvnpoints.at(p);
+  }
   std::vector<int> recvdispls(nprocs);
   int total_recvcount = 0;
   for (int p = 0; p < nprocs; ++p) {
@@ -1,3 +1,4 @@
+#include "derived.hxx"
 #include "driver.hxx"
 #include "io.hxx"
 #include "io_adios2.hxx"
@@ -5,6 +6,7 @@
 #include "io_norm.hxx"
 #include "io_openpmd.hxx"
 #include "io_silo.hxx"
+#include "io_slice.hxx"
 #include "io_tsv.hxx"
 #include "schedule.hxx"
 #include "timer.hxx"
@@ -25,6 +27,7 @@
 #include <yaml-cpp/yaml.h>
 
 #include <algorithm>
+#include <memory>
 #include <regex>
 #include <utility>
 #include <vector>
@@ -357,6 +360,75 @@ void OutputPlotfile(const cGH *restrict cctkGH) {
       }   // for patchdata
     }
   }
+
+  // WriteMultiLevelPlotfile needs a MultiFab per level. Derived
+  // quantities are thus evaluated component by component into a
+  // temporary single-component MultiFab without ghost zones, which is
+  // freed again after the plotfile has been written.
+  for (const derived_quantity_t *const dq :
+       find_derived_quantities(out_plotfile_derived)) {
+    const int gi = get_derived_layout_group(*dq);
+    const int tl = 0;
+
+    auto &restrict groupdata0 =
+        *ghext->patchdata.at(0).leveldata.at(0).groupdata.at(gi);
+    if (groupdata0.mfab.size() == 0)
+      continue;
+
+    string name = regex_replace(dq->name, regex("::"), "-");
+    for (auto &c : name)
+      c = tolower(c);
+
+    for (const auto &restrict patchdata : ghext->patchdata) {
+
+      const string basename = [&]() {
+        ostringstream buf;
+        buf << "derived-" << name << ".it" << setw(8) << setfill('0')
+            << cctk_iteration;
+        if (ghext->num_patches() > 1)
+          buf << ".m" << setw(2) << setfill('0') << patchdata.patch;
+        return buf.str();
+      }();
+      const string filename = string(out_dir) + "/" + basename;
+
+      const amrex::Vector<string> varnames{dq->name};
+
+      vector<unique_ptr<amrex::MultiFab> > derived_mfabs;
+      amrex::Vector<const amrex::MultiFab *> mfabs(patchdata.leveldata.size());
+      amrex::Vector<amrex::Geometry> geoms(patchdata.leveldata.size());
+      amrex::Vector<int> iters(patchdata.leveldata.size());
+      amrex::Vector<amrex::IntVect> reffacts(patchdata.leveldata.size());
+      for (const auto &restrict leveldata : patchdata.leveldata) {
+        const amrex::MultiFab &mfab = *leveldata.groupdata.at(gi)->mfab.at(tl);
+        auto derived_mfab = make_unique<amrex::MultiFab>(
+            mfab.boxArray(), mfab.DistributionMap(), 1, 0);
+        for (amrex::MFIter mfi(*derived_mfab); mfi.isValid(); ++mfi)
+          evaluate_derived_quantity(*dq, patchdata.patch, leveldata.level, mfi,
+                                    mfi.validbox(), (*derived_mfab)[mfi]);
+        mfabs.at(leveldata.level) = derived_mfab.get();
+        derived_mfabs.push_back(std::move(derived_mfab));
+        geoms.at(leveldata.level) = patchdata.amrcore->Geom(leveldata.level);
+        iters.at(leveldata.level) = cctk_iteration;
+        reffacts.at(leveldata.level) = amrex::IntVect{2, 2, 2};
+      }
+
+      WriteMultiLevelPlotfile(filename, mfabs.size(), mfabs, varnames, geoms,
+                              cctk_time, iters, reffacts);
+
+      const bool is_root = CCTK_MyProc(nullptr) == 0;
+      if (is_root) {
+        const string visitname = [&]() {
+          ostringstream buf;
+          buf << out_dir << "/derived-" << name << ".visit";
+          return buf.str();
+        }();
+        ofstream visit(visitname, ios::app);
+        assert(visit.good());
+        visit << basename << "/Header\n";
+        visit.close();
+      } // if is_root
+    }   // for patchdata
+  }     // for dq
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -522,11 +594,13 @@ int OutputGH(const cGH *restrict cctkGH) {
       // TODO: Stop at paramcheck time when ADIOS2 output parameters
       // are set, but ADIOS2 is not available
       const string simulation_name = get_simulation_name();
-      OutputADIOS2(cctkGH, group_enabled, out_dir, simulation_name);
+      OutputADIOS2(cctkGH, group_enabled, out_dir, simulation_name,
+                   find_derived_quantities(out_adios2_derived));
 #else
-      if (strlen(out_adios2_vars) != 0)
-        CCTK_VERROR("ADIOS2 is not enabled. The parameter "
-                    "CarpetX::out_adios2_vars must be empty.");
+      if (strlen(out_adios2_vars) != 0 || strlen(out_adios2_derived) != 0)
+        CCTK_VERROR("ADIOS2 is not enabled. The parameters "
+                    "CarpetX::out_adios2_vars and "
+                    "CarpetX::out_adios2_derived must be empty.");
 #endif
     }
   }
@@ -540,11 +614,28 @@ int OutputGH(const cGH *restrict cctkGH) {
       // TODO: Stop at paramcheck time when openPMD output parameters
       // are set, but openPMD is not available
       const string simulation_name = get_simulation_name();
-      OutputOpenPMD(cctkGH, group_enabled, out_dir, simulation_name);
+      OutputOpenPMD(cctkGH, group_enabled, out_dir, simulation_name,
+                    find_derived_quantities(out_openpmd_derived));
 #else
-      if (strlen(out_openpmd_vars) != 0)
-        CCTK_VERROR("openPMD is not enabled. The parameter "
-                    "CarpetX::out_openpmd_vars must be empty.");
+      if (strlen(out_openpmd_vars) != 0 || strlen(out_openpmd_derived) != 0)
+        CCTK_VERROR("openPMD is not enabled. The parameters "
+                    "CarpetX::out_openpmd_vars and "
+                    "CarpetX::out_openpmd_derived must be empty.");
+#endif
+    }
+  }
+
+  {
+    const int every = out_slice_every == -1 ? out_every : out_slice_every;
+    if (every > 0 && cctk_iteration % every == 0) {
+      const vector<bool> group_enabled = find_groups("Slice", out_slice_vars);
+#ifdef HAVE_CAPABILITY_ADIOS2
+      const string simulation_name = get_simulation_name();
+      OutputSlices(cctkGH, group_enabled, out_dir, simulation_name);
+#else
+      if (strlen(out_slice_vars) != 0)
+        CCTK_VERROR("ADIOS2 is not enabled. The parameter "
+                    "CarpetX::out_slice_vars must be empty.");
 #endif
     }
   }
@@ -563,11 +654,14 @@ int OutputGH(const cGH *restrict cctkGH) {
       // TODO: Stop at paramcheck time when Silo output parameters are
       // set, but Silo is not available
       const string simulation_name = get_simulation_name();
-      OutputSilo(cctkGH, group_enabled, out_dir, simulation_name);
+      OutputSilo(cctkGH, group_enabled, out_dir, simulation_name,
+                 /*incremental*/ false,
+                 find_derived_quantities(out_silo_derived));
 #else
-      if (strlen(out_silo_vars) != 0)
-        CCTK_VERROR("Silo is not enabled. The parameter "
-                    "CarpetX::out_silo_vars must be empty.");
+      if (strlen(out_silo_vars) != 0 || strlen(out_silo_derived) != 0)
+        CCTK_VERROR("Silo is not enabled. The parameters "
+                    "CarpetX::out_silo_vars and "
+                    "CarpetX::out_silo_derived must be empty.");
 #endif
     }
   }
@@ -669,7 +763,8 @@ void Checkpoint(const cGH *const restrict cctkGH) {
       }
       return enabled;
     }();
-    OutputSilo(cctkGH, checkpoint_group, checkpoint_dir, checkpoint_file);
+    OutputSilo(cctkGH, checkpoint_group, checkpoint_dir, checkpoint_file,
+               checkpoint_incremental);
 #else
     // TODO: Check this at paramcheck
     CCTK_VERROR("CarpetX::checkpoint_method is set to \"silo\", but Silo is "
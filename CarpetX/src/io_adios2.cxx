@@ -1,5 +1,6 @@
 #include "io_adios2.hxx"
 
+#include "derived.hxx"
 #include "driver.hxx"
 #include "timer.hxx"
 
@@ -154,29 +155,43 @@ struct carpetx_adios2_t {
     return buf.str();
   }
 
+  static std::string make_varname(const derived_quantity_t &dq,
+                                  const int patch = -1, const int reflevel = -1,
+                                  const int component = -1) {
+    std::ostringstream buf;
+    buf << dq.name;
+    if (patch >= 0)
+      buf << ".m" << setw(2) << setfill('0') << patch;
+    if (reflevel >= 0)
+      buf << ".rl" << setw(2) << setfill('0') << reflevel;
+    if (component >= 0)
+      buf << ".c" << setw(8) << setfill('0') << component;
+    return buf.str();
+  }
+
   ////////////////////////////////////////////////////////////////////////////////
 
   adios2::ADIOS adios;
   adios2::IO io;
   adios2::Engine engine;
 
-  void OutputADIOS2(const cGH *const cctkGH,
-                    const std::vector<bool> &output_group,
-                    const std::string &output_dir,
-                    const std::string &output_file);
+  void OutputADIOS2(
+      const cGH *const cctkGH, const std::vector<bool> &output_group,
+      const std::string &output_dir, const std::string &output_file,
+      const std::vector<const derived_quantity_t *> &output_derived);
   ~carpetx_adios2_t();
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void OutputADIOS2(const cGH *const cctkGH,
-                  const std::vector<bool> &output_group,
-                  const std::string &output_dir,
-                  const std::string &output_file) {
+void OutputADIOS2(
+    const cGH *const cctkGH, const std::vector<bool> &output_group,
+    const std::string &output_dir, const std::string &output_file,
+    const std::vector<const derived_quantity_t *> &output_derived) {
   if (!carpetx_adios2_t::self)
     carpetx_adios2_t::self = std::make_optional<carpetx_adios2_t>();
   carpetx_adios2_t::self->OutputADIOS2(cctkGH, output_group, output_dir,
-                                       output_file);
+                                       output_file, output_derived);
 }
 
 void ShutdownADIOS2() { carpetx_adios2_t::self.reset(); }
@@ -185,10 +200,10 @@ void ShutdownADIOS2() { carpetx_adios2_t::self.reset(); }
 
 std::optional<carpetx_adios2_t> carpetx_adios2_t::self;
 
-void carpetx_adios2_t::OutputADIOS2(const cGH *const cctkGH,
-                                    const std::vector<bool> &output_group,
-                                    const std::string &output_dir,
-                                    const std::string &output_file) {
+void carpetx_adios2_t::OutputADIOS2(
+    const cGH *const cctkGH, const std::vector<bool> &output_group,
+    const std::string &output_dir, const std::string &output_file,
+    const std::vector<const derived_quantity_t *> &output_derived) {
   DECLARE_CCTK_ARGUMENTS;
   DECLARE_CCTK_PARAMETERS;
 
@@ -201,7 +216,8 @@ void carpetx_adios2_t::OutputADIOS2(const cGH *const cctkGH,
   if (io_verbose)
     CCTK_VINFO("OutputADIOS2...");
 
-  if (std::count(output_group.begin(), output_group.end(), true) == 0)
+  if (std::count(output_group.begin(), output_group.end(), true) == 0 &&
+      output_derived.empty())
     return;
 
   try {
@@ -320,6 +336,37 @@ void carpetx_adios2_t::OutputADIOS2(const cGH *const cctkGH,
             }
           } // for gi
 
+          for (const derived_quantity_t *const dq : output_derived) {
+            const int gi = get_derived_layout_group(*dq);
+            const auto &groupdata = *leveldata.groupdata.at(gi);
+            const int tl = 0;
+            const amrex::MultiFab &mfab = *groupdata.mfab[tl];
+            const int num_local_components = mfab.local_size();
+
+            if (!combine_components) {
+
+              // Loop over components (AMReX boxes)
+              for (int local_component = 0;
+                   local_component < num_local_components; ++local_component) {
+                const int component = mfab.IndexArray().at(local_component);
+                const std::string varname = make_varname(
+                    *dq, patchdata.patch, leveldata.level, component);
+                if (io_verbose)
+                  CCTK_VINFO("      Defining variable %s...", varname.c_str());
+                io.DefineVariable<CCTK_REAL>(varname, {}, {}, {1, 1, 1});
+              } // for local_component
+
+            } else { // if combine_components
+
+              const std::string varname =
+                  make_varname(*dq, patchdata.patch, leveldata.level);
+              if (io_verbose)
+                CCTK_VINFO("      Defining variable %s...", varname.c_str());
+              io.DefineVariable<CCTK_REAL>(varname, {}, {}, {1});
+
+            } // if combine_components
+          }   // for dq
+
         } // for leveldata
       }   // for patchdata
 
@@ -495,6 +542,94 @@ void carpetx_adios2_t::OutputADIOS2(const cGH *const cctkGH,
           }
         } // for gi
 
+        // Derived quantities have the layout of their first input
+        // group. They are evaluated component by component, directly
+        // into the output buffer where possible.
+        for (const derived_quantity_t *const dq : output_derived) {
+          if (io_verbose)
+            CCTK_VINFO("    Writing derived quantity %s...", dq->name.c_str());
+
+          const int gi = get_derived_layout_group(*dq);
+          const auto &groupdata = *leveldata.groupdata.at(gi);
+          const int tl = 0;
+          const amrex::MultiFab &mfab = *groupdata.mfab[tl];
+          const int num_local_components = mfab.local_size();
+
+          if (!combine_components) {
+
+            amrex::FArrayBox fab;
+            // Loop over components (AMReX boxes)
+            for (int local_component = 0;
+                 local_component < num_local_components; ++local_component) {
+              const int component = mfab.IndexArray().at(local_component);
+              const amrex::Box &fabbox = mfab.fabbox(component); // exterior
+              evaluate_derived_quantity(*dq, patchdata.patch, leveldata.level,
+                                        component, fabbox, fab);
+
+              adios2::Dims lsh(3);
+              for (int d = 0; d < 3; ++d)
+                lsh.at(d) = fabbox.length(d);
+
+              const std::string varname = make_varname(
+                  *dq, patchdata.patch, leveldata.level, component);
+              if (io_verbose)
+                CCTK_VINFO("      Writing variable %s...", varname.c_str());
+              adios2::Variable<CCTK_REAL> var =
+                  io.InquireVariable<CCTK_REAL>(varname);
+              assert(var);
+              var.SetSelection({{}, lsh});
+              // The staging buffer is reused for the next component
+              engine.Put(var, fab.dataPtr(), adios2::Mode::Sync);
+            } // for local_component
+
+          } else { // if combine_components
+
+            std::vector<size_t> offsets(num_local_components + 1);
+            offsets.at(0) = 0;
+            for (int local_component = 0;
+                 local_component < num_local_components; ++local_component) {
+              const int component = mfab.IndexArray().at(local_component);
+              offsets.at(local_component + 1) =
+                  offsets.at(local_component) +
+                  mfab.fabbox(component).numPts();
+            }
+            const size_t total_np = offsets.back();
+
+            const std::string varname =
+                make_varname(*dq, patchdata.patch, leveldata.level);
+            if (io_verbose)
+              CCTK_VINFO("      Writing variable %s...", varname.c_str());
+            adios2::Variable<CCTK_REAL> var =
+                io.InquireVariable<CCTK_REAL>(varname);
+            assert(var);
+            var.SetSelection({{}, {total_np}});
+
+            const auto evaluate = [&](CCTK_REAL *const data) {
+              for (int local_component = 0;
+                   local_component < num_local_components; ++local_component) {
+                const int component = mfab.IndexArray().at(local_component);
+                const amrex::Box &fabbox = mfab.fabbox(component); // exterior
+                // This FArrayBox does not own its memory
+                amrex::FArrayBox fab(fabbox, 1,
+                                     data + offsets.at(local_component));
+                evaluate_derived_quantity(*dq, patchdata.patch,
+                                          leveldata.level, component, fabbox,
+                                          fab);
+              } // for local_component
+            };
+
+            if (!combine_via_span) {
+              std::vector<CCTK_REAL> alldata(total_np);
+              evaluate(alldata.data());
+              engine.Put(var, alldata.data(), adios2::Mode::Sync);
+            } else {
+              const adios2::Variable<CCTK_REAL>::Span span = engine.Put(var);
+              evaluate(span.data());
+            }
+
+          } // if combine_components
+        }   // for dq
+
       } // for leveldata
       assert(!levels.empty());
       const auto rdomain = levels.front().rdomain;
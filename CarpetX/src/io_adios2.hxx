@@ -5,6 +5,8 @@
 
 #ifdef HAVE_CAPABILITY_ADIOS2
 
+#include "derived.hxx"
+
 #include <string>
 #include <vector>
 
@@ -18,9 +20,10 @@ namespace CarpetX {
 // void InputADIOS2(const cGH *cctkGH, const std::vector<bool> &input_group,
 //                const std::string &input_dir, const std::string &input_file);
 
-void OutputADIOS2(const cGH *cctkGH, const std::vector<bool> &output_group,
-                  const std::string &output_dir,
-                  const std::string &output_file);
+void OutputADIOS2(
+    const cGH *cctkGH, const std::vector<bool> &output_group,
+    const std::string &output_dir, const std::string &output_file,
+    const std::vector<const derived_quantity_t *> &output_derived = {});
 
 } // namespace CarpetX
 
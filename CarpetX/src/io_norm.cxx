@@ -1,5 +1,6 @@
 #include "io_norm.hxx"
 
+#include "derived.hxx"
 #include "driver.hxx"
 #include "io_meta.hxx"
 #include "loop.hxx"
@@ -17,16 +18,170 @@
 #include <limits>
 #include <mutex>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
 namespace CarpetX {
 
+namespace {
+
+std::vector<std::string> get_reduction_names() {
+  DECLARE_CCTK_PARAMETERS;
+  std::vector<std::string> reductions = {"min",    "max",    "sum",
+                                         "avg",    "stddev", "volume",
+                                         "L1norm", "L2norm", "maxabs"};
+  if (!out_norm_omit_unstable) {
+    for (int d = 0; d < dim; ++d) {
+      std::ostringstream buf;
+      buf << "minloc[" << d << "]";
+      reductions.push_back(buf.str());
+    }
+    for (int d = 0; d < dim; ++d) {
+      std::ostringstream buf;
+      buf << "maxloc[" << d << "]";
+      reductions.push_back(buf.str());
+    }
+  }
+  if (!out_norm_omit_sumloc_for_backward_compatibility) {
+    for (int d = 0; d < dim; ++d) {
+      std::ostringstream buf;
+      buf << "sumloc[" << d << "]";
+      reductions.push_back(buf.str());
+    }
+  }
+  return reductions;
+}
+
+std::vector<reduction_t> get_reduction_types() {
+  DECLARE_CCTK_PARAMETERS;
+  std::vector<reduction_t> reductions = {
+      reduction_t::minimum,
+      reduction_t::maximum,
+      reduction_t::sum,
+      reduction_t::average,
+      reduction_t::standard_deviation,
+      reduction_t::volume,
+      reduction_t::norm1,
+      reduction_t::norm2,
+      reduction_t::norm_inf,
+  };
+  if (!out_norm_omit_unstable) {
+    reductions.push_back(reduction_t::minimum_location);
+    reductions.push_back(reduction_t::maximum_location);
+  }
+  if (!out_norm_omit_sumloc_for_backward_compatibility)
+    reductions.push_back(reduction_t::sum_location);
+  return reductions;
+}
+
+void write_reduction(std::ostream &file, const std::string &sep,
+                     const reduction<CCTK_REAL, dim> &red) {
+  DECLARE_CCTK_PARAMETERS;
+  file << sep << red.min << sep << red.max << sep << red.sum << sep
+       << red.avg() << sep << red.sdv() << sep << red.norm0() << sep
+       << red.norm1() << sep << red.norm2() << sep << red.norm_inf();
+  if (!out_norm_omit_unstable) {
+    for (int d = 0; d < dim; ++d)
+      file << sep << red.minloc[d];
+    for (int d = 0; d < dim; ++d)
+      file << sep << red.maxloc[d];
+  }
+  if (!out_norm_omit_sumloc_for_backward_compatibility) {
+    for (int d = 0; d < dim; ++d)
+      file << sep << red.sumloc[d];
+  }
+}
+
+// Output norms of derived quantities. These are evaluated tile by
+// tile while reducing and are never stored.
+void OutputDerivedNorms(const cGH *restrict cctkGH) {
+  DECLARE_CCTK_ARGUMENTS;
+  DECLARE_CCTK_PARAMETERS;
+
+  const std::vector<const derived_quantity_t *> dqs =
+      find_derived_quantities(out_norm_derived);
+  if (dqs.empty())
+    return;
+
+  static Timer timer("OutputDerivedNorms");
+  Interval interval(timer);
+
+  const bool is_root = CCTK_MyProc(nullptr) == 0;
+  const std::string sep = "\t";
+  const std::vector<std::string> reductions = get_reduction_names();
+
+  if (is_root) {
+    static std::once_flag create_directory;
+    std::call_once(create_directory, [&]() {
+      const int mode = 0755;
+      int ierr = CCTK_CreateDirectory(mode, out_dir);
+      assert(ierr >= 0);
+      std::ostringstream buf;
+      buf << out_dir << "/norms";
+      ierr = CCTK_CreateDirectory(mode, buf.str().c_str());
+      assert(ierr >= 0);
+    });
+  }
+
+  static std::set<std::string> have_header;
+  for (const derived_quantity_t *const dq : dqs) {
+    const reduction<CCTK_REAL, dim> red = reduce_derived(*dq);
+
+    if (is_root) {
+      std::string varname = dq->name;
+      for (auto &ch : varname)
+        ch = std::tolower(ch);
+      const std::string name =
+          std::regex_replace(varname, std::regex("::"), "-");
+      std::ostringstream buf;
+      buf << out_dir << "/norms/derived-" << name << ".tsv";
+      const std::string filename = buf.str();
+      std::ofstream file;
+      file.open(filename, std::ios_base::app);
+
+      if (!have_header.count(dq->name)) {
+        have_header.insert(dq->name);
+        int col = 0;
+        file << "# " << ++col << ":iteration";
+        file << sep << ++col << ":time";
+        for (const auto &reduction : reductions)
+          file << sep << ++col << ":" << varname << "." << reduction;
+        file << "\n";
+      }
+
+      file << setprecision(std::numeric_limits<CCTK_REAL>::digits10 + 1)
+           << scientific;
+      file << cctk_iteration << sep << cctk_time;
+      write_reduction(file, sep, red);
+      file << "\n";
+      file.close();
+
+      output_file_description_t ofd;
+      ofd.filename = filename;
+      ofd.description = "CarpetX TSV norms output of a derived quantity";
+      ofd.writer_thorn = CCTK_THORNSTRING;
+      ofd.variables = {dq->name};
+      ofd.iterations = {cctk_iteration};
+      ofd.reductions = get_reduction_types();
+      ofd.format_name = "CarpetX/norms/TSV";
+      ofd.format_version = {1, 1, 0};
+
+      OutputMeta_RegisterOutputFile(std::move(ofd));
+    }
+  }
+}
+
+} // namespace
+
 void OutputNorms(const cGH *restrict cctkGH) {
   DECLARE_CCTK_ARGUMENTS;
   DECLARE_CCTK_PARAMETERS;
 
+  if (out_norm_derived[0] != '\0')
+    OutputDerivedNorms(cctkGH);
+
   if (out_norm_vars[0] == '\0')
     return;
 
@@ -64,28 +219,7 @@ void OutputNorms(const cGH *restrict cctkGH) {
   const std::string sep = "\t";
   const int tl = 0;
   const int numgroups = CCTK_NumGroups();
-  std::vector<std::string> reductions = {"min",    "max",    "sum",
-                                         "avg",    "stddev", "volume",
-                                         "L1norm", "L2norm", "maxabs"};
-  if (!out_norm_omit_unstable) {
-    for (int d = 0; d < dim; ++d) {
-      std::ostringstream buf;
-      buf << "minloc[" << d << "]";
-      reductions.push_back(buf.str());
-    }
-    for (int d = 0; d < dim; ++d) {
-      std::ostringstream buf;
-      buf << "maxloc[" << d << "]";
-      reductions.push_back(buf.str());
-    }
-  }
-  if (!out_norm_omit_sumloc_for_backward_compatibility) {
-    for (int d = 0; d < dim; ++d) {
-      std::ostringstream buf;
-      buf << "sumloc[" << d << "]";
-      reductions.push_back(buf.str());
-    }
-  }
+  const std::vector<std::string> reductions = get_reduction_names();
 
   if (is_root) {
     static std::once_flag create_directory;
@@ -212,21 +346,8 @@ void OutputNorms(const cGH *restrict cctkGH) {
 
       const reduction<CCTK_REAL, dim> red = reduce(gi, vi, tl);
 
-      if (is_root) {
-        file << sep << red.min << sep << red.max << sep << red.sum << sep
-             << red.avg() << sep << red.sdv() << sep << red.norm0() << sep
-             << red.norm1() << sep << red.norm2() << sep << red.norm_inf();
-        if (!out_norm_omit_unstable) {
-          for (int d = 0; d < dim; ++d)
-            file << sep << red.minloc[d];
-          for (int d = 0; d < dim; ++d)
-            file << sep << red.maxloc[d];
-        }
-        if (!out_norm_omit_sumloc_for_backward_compatibility) {
-          for (int d = 0; d < dim; ++d)
-            file << sep << red.sumloc[d];
-        }
-      }
+      if (is_root)
+        write_reduction(file, sep, red);
     }
 
     if (is_root) {
@@ -236,23 +357,7 @@ void OutputNorms(const cGH *restrict cctkGH) {
       ofd.description = "CarpetX TSV norms output";
       ofd.writer_thorn = CCTK_THORNSTRING;
       ofd.iterations = {cctk_iteration};
-      ofd.reductions = {
-          reduction_t::minimum,
-          reduction_t::maximum,
-          reduction_t::sum,
-          reduction_t::average,
-          reduction_t::standard_deviation,
-          reduction_t::volume,
-          reduction_t::norm1,
-          reduction_t::norm2,
-          reduction_t::norm_inf,
-      };
-      if (!out_norm_omit_unstable) {
-        ofd.reductions.push_back(reduction_t::minimum_location);
-        ofd.reductions.push_back(reduction_t::maximum_location);
-      }
-      if (!out_norm_omit_sumloc_for_backward_compatibility)
-        ofd.reductions.push_back(reduction_t::sum_location);
+      ofd.reductions = get_reduction_types();
       ofd.format_name = "CarpetX/norms/TSV";
       ofd.format_version = {1, 1, 0};
 
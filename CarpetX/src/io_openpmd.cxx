@@ -1,5 +1,6 @@
 #include "io_openpmd.hxx"
 
+#include "derived.hxx"
 #include "driver.hxx"
 #include "timer.hxx"
 
@@ -342,6 +343,21 @@ struct carpetx_openpmd_t {
     return buf.str();
   }
 
+  // Allowed characters are only [A-Za-z_]
+  static std::string make_meshname(const derived_quantity_t &dq,
+                                   const int patch, const int level) {
+    std::string name = std::regex_replace(dq.name, std::regex("::"), "_");
+    for (auto &ch : name)
+      ch = std::tolower(ch);
+    std::ostringstream buf;
+    buf << name;
+    if (patch != -1)
+      buf << "_patch" << setw(2) << setfill('0') << patch;
+    if (level != -1)
+      buf << "_lev" << setw(2) << setfill('0') << level;
+    return buf.str();
+  }
+
 #if 0
   static std_tuple<int, int> interpret_meshname(const std::string &meshname) {
     std::smatch match;
@@ -387,10 +403,10 @@ struct carpetx_openpmd_t {
                     const std::string &input_dir,
                     const std::string &input_file);
 
-  void OutputOpenPMD(const cGH *const cctkGH,
-                     const std::vector<bool> &output_group,
-                     const std::string &output_dir,
-                     const std::string &output_file);
+  void OutputOpenPMD(
+      const cGH *const cctkGH, const std::vector<bool> &output_group,
+      const std::string &output_dir, const std::string &output_file,
+      const std::vector<const derived_quantity_t *> &output_derived);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -419,14 +435,14 @@ void InputOpenPMD(const cGH *cctkGH, const std::vector<bool> &input_group,
                                         input_file);
 }
 
-void OutputOpenPMD(const cGH *const cctkGH,
-                   const std::vector<bool> &output_group,
-                   const std::string &output_dir,
-                   const std::string &output_file) {
+void OutputOpenPMD(
+    const cGH *const cctkGH, const std::vector<bool> &output_group,
+    const std::string &output_dir, const std::string &output_file,
+    const std::vector<const derived_quantity_t *> &output_derived) {
   if (!carpetx_openpmd_t::self)
     carpetx_openpmd_t::self = std::make_optional<carpetx_openpmd_t>();
   carpetx_openpmd_t::self->OutputOpenPMD(cctkGH, output_group, output_dir,
-                                         output_file);
+                                         output_file, output_derived);
 }
 
 void ShutdownOpenPMD() { carpetx_openpmd_t::self.reset(); }
@@ -1224,10 +1240,10 @@ void carpetx_openpmd_t::InputOpenPMD(const cGH *const cctkGH,
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void carpetx_openpmd_t::OutputOpenPMD(const cGH *const cctkGH,
-                                      const std::vector<bool> &output_group,
-                                      const std::string &output_dir,
-                                      const std::string &output_file) {
+void carpetx_openpmd_t::OutputOpenPMD(
+    const cGH *const cctkGH, const std::vector<bool> &output_group,
+    const std::string &output_dir, const std::string &output_file,
+    const std::vector<const derived_quantity_t *> &output_derived) {
   DECLARE_CCTK_ARGUMENTS;
   DECLARE_CCTK_PARAMETERS;
 
@@ -1235,7 +1251,8 @@ void carpetx_openpmd_t::OutputOpenPMD(const cGH *const cctkGH,
   static Timer timer("OutputOpenPMD");
   Interval interval(timer);
 
-  if (std::count(output_group.begin(), output_group.end(), true) == 0)
+  if (std::count(output_group.begin(), output_group.end(), true) == 0 &&
+      output_derived.empty())
     return;
 
   if (io_verbose)
@@ -1623,6 +1640,86 @@ void carpetx_openpmd_t::OutputOpenPMD(const cGH *const cctkGH,
         }
       } // for gi
 
+      // Derived quantities have the layout of their first input
+      // group. Each component is evaluated directly into the chunk
+      // buffer that is handed to openPMD.
+      for (const derived_quantity_t *const dq : output_derived) {
+        if (io_verbose)
+          CCTK_VINFO("Writing derived quantity %s...", dq->name.c_str());
+
+        const int gi = get_derived_layout_group(*dq);
+        const auto &groupdata = *leveldata.groupdata.at(gi);
+        const int tl = 0;
+        const amrex::MultiFab &mfab = *groupdata.mfab[tl];
+        const amrex::IndexType &indextype = mfab.ixType();
+        const Arith::vect<bool, 3> is_cell_centred{indextype.cellCentered(0),
+                                                   indextype.cellCentered(1),
+                                                   indextype.cellCentered(2)};
+
+        const int num_local_components = mfab.local_size();
+
+        // Create mesh
+
+        const std::string meshname =
+            make_meshname(*dq, leveldata.patch, leveldata.level);
+        if (io_verbose)
+          CCTK_VINFO("Defining mesh %s...", meshname.c_str());
+        assert(!iter.meshes.contains(meshname));
+        openPMD::Mesh mesh = iter.meshes[meshname];
+
+        mesh.setGeometry(openPMD::Mesh::Geometry::cartesian);
+        mesh.setAxisLabels(reversed(std::vector<std::string>{"x", "y", "z"}));
+        mesh.setGridSpacing(to_vector<CCTK_REAL>(
+            reversed(fmap([](auto x, auto y) { return x / CCTK_REAL(y); },
+                          rdomain.hi - rdomain.lo, idomain.shape() - 1))));
+        mesh.setGridGlobalOffset(to_vector<double>(reversed(rdomain.lo)));
+        mesh.setGridUnitSI(Unit::length);
+        mesh.setTimeOffset(CCTK_REAL(0));
+
+        // Cell centred grids are offset by 1/2
+        const Arith::vect<double, 3> position =
+            fmap([](auto c) { return 0.5 * c; }, is_cell_centred);
+
+        openPMD::MeshRecordComponent record_component =
+            mesh[openPMD::MeshRecordComponent::SCALAR];
+        record_component.setPosition(to_vector<double>(reversed(position)));
+        record_component.resetDataset(dataset);
+
+        // Loop over components (AMReX boxes)
+        for (int local_component = 0; local_component < num_local_components;
+             ++local_component) {
+          const int component = mfab.IndexArray().at(local_component);
+
+          const amrex::Box &validbox =
+              mfab.box(component); // interior (without ghosts)
+          const box_t<int, 3> intbox{
+              .lo = {validbox.smallEnd(0), validbox.smallEnd(1),
+                     validbox.smallEnd(2)},
+              .hi = {validbox.bigEnd(0) + 1, validbox.bigEnd(1) + 1,
+                     validbox.bigEnd(2) + 1}};
+          // It seems that openPMD assumes that chunks do not have
+          // ghost zones
+          assert(!output_ghosts);
+
+          const openPMD::Offset start =
+              to_vector(reversed(intbox.lo - idomain.lo));
+          const openPMD::Extent count = to_vector(reversed(intbox.shape()));
+          const int np = intbox.size();
+          assert(int(count.at(0) * count.at(1) * count.at(2)) == np);
+          for (int d = 0; d < 3; ++d)
+            assert(start.at(d) + count.at(d) <= extent.at(d));
+
+          std::shared_ptr<CCTK_REAL> ptr(new CCTK_REAL[np],
+                                         std::default_delete<CCTK_REAL[]>());
+          // This FArrayBox does not own its memory; it only describes
+          // the layout of the chunk buffer
+          amrex::FArrayBox fab(validbox, 1, ptr.get());
+          evaluate_derived_quantity(*dq, patchdata.patch, leveldata.level,
+                                    component, validbox, fab);
+          record_component.storeChunk(std::move(ptr), start, count);
+        } // for local_component
+      }   // for dq
+
     } // for leveldata
   }   // for patchdata
 
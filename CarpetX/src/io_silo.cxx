@@ -1,5 +1,6 @@
 #include "io_silo.hxx"
 
+#include "derived.hxx"
 #include "driver.hxx"
 #include "io_meta.hxx"
 #include "mpi_types.hxx"
@@ -24,6 +25,7 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
 #if defined __cpp_lib_filesystem && __cpp_lib_filesystem < 201703L
 #include <experimental/filesystem>
@@ -33,6 +35,7 @@ using namespace std::experimental;
 #endif
 #include <fstream>
 #include <iomanip>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <regex>
@@ -128,6 +131,21 @@ std::string make_meshname(const int reflevel = -1, const int component = -1) {
   return DB::legalize_name(buf.str());
 }
 
+std::string make_derived_varname(const derived_quantity_t &dq,
+                                 const int reflevel = -1,
+                                 const int component = -1) {
+  assert((reflevel == -1) == (component == -1));
+  std::string varname = regex_replace(dq.name, regex("::"), "-");
+  for (auto &ch : varname)
+    ch = tolower(ch);
+  std::ostringstream buf;
+  buf << varname;
+  if (reflevel >= 0)
+    buf << ".rl" << setw(2) << setfill('0') << reflevel //
+        << ".c" << setw(8) << setfill('0') << component;
+  return DB::legalize_name(buf.str());
+}
+
 std::string make_varname(const int gi, const int vi, const int reflevel = -1,
                          const int component = -1) {
   assert((reflevel == -1) == (component == -1));
@@ -158,6 +176,65 @@ std::string make_fabarraybasename(const int reflevel) {
   return DB::legalize_name(buf.str());
 }
 
+// Box index: which file holds the data of which component
+std::string make_fabarrayfilesname(const int reflevel) {
+  std::ostringstream buf;
+  buf << "FabArrayFiles.rl" << setw(2) << setfill('0') << reflevel;
+  return DB::legalize_name(buf.str());
+}
+
+// Group sources: which checkpoint iteration holds the data of which
+// group (for incremental checkpoints)
+std::string make_groupsourcesname(const int reflevel) {
+  std::ostringstream buf;
+  buf << "GroupSources.rl" << setw(2) << setfill('0') << reflevel;
+  return DB::legalize_name(buf.str());
+}
+
+int get_centering(const amrex::IndexType &indextype) {
+  const int rank = indextype.cellCentered(0) + indextype.cellCentered(1) +
+                   indextype.cellCentered(2);
+  switch (rank) {
+  case 0:
+    return DB_NODECENT;
+  case 1:
+    return DB_EDGECENT;
+  case 2:
+    return DB_FACECENT;
+  case 3:
+    return DB_ZONECENT;
+  }
+  assert(0);
+}
+
+void read_quadvar(DBfile *const file, const std::string &varname,
+                  const array<int, dim> &dims, const int centering,
+                  CCTK_REAL *const data_ptr) {
+  constexpr int ndims = dim;
+
+  const DB::ptr<DBquadvar> quadvar =
+      DB::make(DBGetQuadvar(file, varname.c_str()));
+  assert(quadvar);
+
+  assert(quadvar->ndims == ndims);
+  assert(ndims <= 3);
+  ptrdiff_t zonecount = 1;
+  for (int d = 0; d < ndims; ++d) {
+    assert(quadvar->dims[d] == dims[d]);
+    zonecount *= dims[d];
+  }
+  assert(quadvar->datatype == db_datatype_v<CCTK_REAL>);
+  assert(quadvar->centering == centering);
+  assert(quadvar->nvals == 1);
+
+  // TODO: check DBOPT_COORDSYS: int cartesian = DB_CARTESIAN;
+  const int column_major = 0;
+  assert(quadvar->major_order == column_major);
+
+  const void *const read_ptr = quadvar->vals[0];
+  memcpy(data_ptr, read_ptr, zonecount * sizeof(CCTK_REAL));
+}
+
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -478,22 +555,203 @@ void InputSilo(const cGH *restrict const cctkGH,
 
   interval_setup = nullptr;
 
+  static Timer timer_index("InputSilo.index");
+  auto interval_index = make_unique<Interval>(timer_index);
+
+  // TODOPATCH: Handle multiple patches
+  assert(ghext->num_patches() == 1);
+  const int nlevels = ghext->patchdata.at(0).leveldata.size();
+
+  const int metafile_ioproc = 0;
+  DB::ptr<DBfile> metafile;
+  if (myproc == metafile_ioproc) {
+    const std::string metafilename =
+        input_dir + "/" + make_filename(input_file, cctk_iteration);
+    // We could use DB_UNKNOWN instead of DB_HDF5
+    metafile = DB::make(DBOpen(metafilename.c_str(), DB_HDF5, DB_READ));
+    assert(metafile);
+  }
+  const std::string dirname = DB::legalize_name(driver_name);
+
+  // Read an int array of the given length from the driver state if
+  // it exists, and broadcast it
+  const auto read_int_array = [&](const std::string &name,
+                                  std::vector<int> &values) {
+    const std::string varname = dirname + "/" + name;
+    int have_var = false;
+    if (myproc == metafile_ioproc)
+      have_var = DBInqVarExists(metafile.get(), varname.c_str());
+    MPI_Bcast(&have_var, 1, MPI_INT, metafile_ioproc, mpi_comm);
+    if (!have_var)
+      return false;
+    if (myproc == metafile_ioproc) {
+      const int vartype = DBGetVarType(metafile.get(), varname.c_str());
+      assert(vartype == DB_INT);
+      const int varlength = DBGetVarLength(metafile.get(), varname.c_str());
+      assert(varlength == int(values.size()));
+      const int ierr =
+          DBReadVar(metafile.get(), varname.c_str(), values.data());
+      assert(!ierr);
+    }
+    MPI_Bcast(values.data(), values.size(), MPI_INT, metafile_ioproc,
+              mpi_comm);
+    return true;
+  };
+
+  // Read the group sources, which record which checkpoint iteration
+  // holds the data of which group. Incremental checkpoints refer to
+  // earlier checkpoints for groups that did not change. Full
+  // checkpoints do not have group sources; all data are then in the
+  // files of the current iteration.
+  std::vector<std::vector<int> > group_sources(nlevels); // [level][gi]
+  for (int level = 0; level < nlevels; ++level) {
+    group_sources.at(level).resize(CCTK_NumGroups());
+    if (!read_int_array(make_groupsourcesname(level), group_sources.at(level)))
+      std::fill(group_sources.at(level).begin(), group_sources.at(level).end(),
+                cctk_iteration);
+  }
+  const auto source_iteration = [&](const int level, const int gi) {
+    const int iteration = group_sources.at(level).at(gi);
+    if (iteration < 0)
+      CCTK_VERROR("Group %s was not checkpointed on level %d",
+                  CCTK_FullGroupName(gi), level);
+    return iteration;
+  };
+
+  // Read the box index, which records which file holds which
+  // component. Checkpoints written before the box index existed do
+  // not have it; we then fall back to reading on the I/O processes.
+  std::vector<std::vector<int> > component_files; // [level][component]
+  if (recover_silo_direct_read) {
+    const auto &patchdata = ghext->patchdata.at(0);
+    component_files.resize(nlevels);
+    for (const auto &leveldata : patchdata.leveldata) {
+      std::vector<int> &files = component_files.at(leveldata.level);
+      files.resize(leveldata.fab->size());
+      if (!read_int_array(make_fabarrayfilesname(leveldata.level), files)) {
+        component_files.clear();
+        if (is_root)
+          CCTK_VINFO("Silo checkpoint has no box index; reading components "
+                     "on I/O processes");
+        break;
+      }
+    }
+  }
+  metafile = nullptr;
+  const bool read_direct = !component_files.empty();
+
+  interval_index = nullptr;
+
   static Timer timer_data("InputSilo.data");
   auto interval_data = make_unique<Interval>(timer_data);
 
-  // Read data
+  // Read data directly: Every process reads the components it owns,
+  // opening only those files that hold them. There is no
+  // communication.
+  if (read_direct) {
+    std::map<std::pair<int, int>, DB::ptr<DBfile> >
+        files; // [(iteration, file index)]
+    const auto get_file = [&](const int iteration, const int fileindex) {
+      auto &file = files[{iteration, fileindex}];
+      if (!file) {
+        const std::string filename =
+            input_dir + "/" + make_subdirname(input_file, iteration) + "/" +
+            make_filename(input_file, iteration, fileindex);
+        // We could use DB_UNKNOWN instead of DB_HDF5
+        file = DB::make(DBOpen(filename.c_str(), DB_HDF5, DB_READ));
+        assert(file);
+      }
+      return file.get();
+    };
+
+    // TODOPATCH: Handle multiple patches
+    assert(ghext->num_patches() == 1);
+    const int patch = 0;
+    auto &patchdata = ghext->patchdata.at(patch);
+
+    // Loop over levels
+    for (const auto &leveldata : patchdata.leveldata) {
+      if (io_verbose)
+        CCTK_VINFO("Reading patch %d level %d", patchdata.patch,
+                   leveldata.level);
+      const std::vector<int> &level_files =
+          component_files.at(leveldata.level);
+
+      // Loop over groups
+      for (int gi = 0; gi < CCTK_NumGroups(); ++gi) {
+        if (!input_group.at(gi))
+          continue;
+        if (CCTK_GroupTypeI(gi) != CCTK_GF)
+          continue;
+        if (io_verbose)
+          CCTK_VINFO("  Reading group %s", CCTK_FullGroupName(gi));
+
+        auto &groupdata = *leveldata.groupdata.at(gi);
+        const int numvars = groupdata.numvars;
+        const int tl = 0;
+        amrex::MultiFab &mfab = *groupdata.mfab[tl];
+        const int centering = get_centering(mfab.ixType());
+        // Edge- and face-centred variables are not supported (see below)
+        assert(centering != DB_EDGECENT && centering != DB_FACECENT);
+
+        // Loop over local components (AMReX boxes)
+        const int num_local_components = mfab.local_size();
+        for (int local_component = 0; local_component < num_local_components;
+             ++local_component) {
+          const int component = mfab.IndexArray().at(local_component);
+
+          static Timer timer_var("InputSilo.var");
+          Interval interval_var(timer_var);
+
+          const amrex::Box &fabbox = mfab.fabbox(component); // exterior
+          array<int, ndims> dims;
+          for (int d = 0; d < ndims; ++d)
+            dims[d] = fabbox.length(d);
+          ptrdiff_t zonecount = 1;
+          for (int d = 0; d < ndims; ++d)
+            zonecount *= dims[d];
+          assert(zonecount >= 0 && zonecount <= INT_MAX);
+
+          DBfile *const file =
+              get_file(source_iteration(leveldata.level, gi),
+                       level_files.at(component));
+          amrex::FArrayBox &fab = mfab[component];
+          for (int vi = 0; vi < numvars; ++vi) {
+            const std::string varname =
+                make_varname(gi, vi, leveldata.level, component);
+            read_quadvar(file, varname, dims, centering,
+                         fab.dataPtr() + vi * zonecount);
+          }
+        } // for local_component
+
+        for (int vi = 0; vi < numvars; ++vi)
+          groupdata.valid.at(tl).at(vi).set_all(
+              make_valid_all(), []() { return "read from Silo file"; });
+
+      } // for gi
+    }   // for leveldata
+
+    interval_data = nullptr;
+    return;
+  }
+
+  // Read data on I/O processes and send it to the owners
   {
-    DB::ptr<DBfile> file;
-    if (read_file) {
-      const std::string subdirname =
-          make_subdirname(input_file, cctk_iteration);
-      const std::string filename =
-          input_dir + "/" + subdirname + "/" +
-          make_filename(input_file, cctk_iteration, myproc / ioproc_every);
-      // We could use DB_UNKNOWN instead of DB_HDF5
-      file = DB::make(DBOpen(filename.c_str(), DB_HDF5, DB_READ));
-      assert(file);
-    }
+    std::map<int, DB::ptr<DBfile> > files; // [iteration]
+    const auto get_file = [&](const int iteration) {
+      assert(read_file);
+      auto &file = files[iteration];
+      if (!file) {
+        const std::string subdirname = make_subdirname(input_file, iteration);
+        const std::string filename =
+            input_dir + "/" + subdirname + "/" +
+            make_filename(input_file, iteration, myproc / ioproc_every);
+        // We could use DB_UNKNOWN instead of DB_HDF5
+        file = DB::make(DBOpen(filename.c_str(), DB_HDF5, DB_READ));
+        assert(file);
+      }
+      return file.get();
+    };
 
     // TODOPATCH: Handle multiple patches
     assert(ghext->num_patches() == 1);
@@ -582,22 +840,7 @@ void InputSilo(const cGH *restrict const cctkGH,
             const std::string meshname =
                 make_meshname(leveldata.level, component);
 
-            const int centering = [&]() {
-              const int rank = indextype.cellCentered(0) +
-                               indextype.cellCentered(1) +
-                               indextype.cellCentered(2);
-              switch (rank) {
-              case 0:
-                return DB_NODECENT;
-              case 1:
-                return DB_EDGECENT;
-              case 2:
-                return DB_FACECENT;
-              case 3:
-                return DB_ZONECENT;
-              }
-              assert(0);
-            }();
+            const int centering = get_centering(indextype);
 
             if (centering == DB_EDGECENT || centering == DB_FACECENT) {
               // Need to find the other 2 edge- or face-centered
@@ -614,26 +857,8 @@ void InputSilo(const cGH *restrict const cctkGH,
               if (io_verbose)
                 CCTK_VINFO("      Reading variable %s", varname.c_str());
 
-              const DB::ptr<DBquadvar> quadvar =
-                  DB::make(DBGetQuadvar(file.get(), varname.c_str()));
-              assert(quadvar);
-
-              assert(quadvar->ndims == ndims);
-              assert(ndims <= 3);
-              for (int d = 0; d < ndims; ++d)
-                assert(quadvar->dims[d] == dims[d]);
-              assert(quadvar->datatype == db_datatype_v<CCTK_REAL>);
-              assert(quadvar->centering == centering);
-              assert(quadvar->nvals == 1);
-
-              // TODO: check DBOPT_COORDSYS: int cartesian = DB_CARTESIAN;
-              const int column_major = 0;
-              assert(quadvar->major_order == column_major);
-
-              const void *const read_ptr = quadvar->vals[0];
-
-              void *const data_ptr = data + vi * zonecount;
-              memcpy(data_ptr, read_ptr, zonecount * sizeof(CCTK_REAL));
+              read_quadvar(get_file(source_iteration(leveldata.level, gi)),
+                           varname, dims, centering, data + vi * zonecount);
             } // for vi
           }   // if read_file
 
@@ -669,7 +894,9 @@ void InputSilo(const cGH *restrict const cctkGH,
 
 void OutputSilo(const cGH *restrict const cctkGH,
                 const std::vector<bool> &output_group,
-                const std::string &output_dir, const std::string &output_file) {
+                const std::string &output_dir, const std::string &output_file,
+                const bool incremental,
+                const std::vector<const derived_quantity_t *> &output_derived) {
   DECLARE_CCTK_ARGUMENTS;
   DECLARE_CCTK_PARAMETERS;
 
@@ -679,7 +906,27 @@ void OutputSilo(const cGH *restrict const cctkGH,
   static Timer timer("OutputSilo");
   Interval interval(timer);
 
-  if (std::count(output_group.begin(), output_group.end(), true) == 0)
+  // The items to output are grid function groups and derived
+  // quantities. A derived quantity has the layout of its first input
+  // group; it is evaluated component by component into a staging
+  // buffer just before it is written.
+  struct output_item_t {
+    int gi;
+    const derived_quantity_t *dq;
+  };
+  std::vector<output_item_t> output_items;
+  for (int gi = 0; gi < CCTK_NumGroups(); ++gi) {
+    if (!output_group.at(gi))
+      continue;
+#warning "TODO: Output grid arrays"
+    if (CCTK_GroupTypeI(gi) != CCTK_GF)
+      continue;
+    output_items.push_back({gi, nullptr});
+  }
+  for (const derived_quantity_t *const dq : output_derived)
+    output_items.push_back({get_derived_layout_group(*dq), dq});
+
+  if (output_items.empty())
     return;
 
   if (io_verbose)
@@ -724,6 +971,91 @@ void OutputSilo(const cGH *restrict const cctkGH,
 
   constexpr int ndims = dim;
 
+  // TODOPATCH: Handle multiple patches
+  assert(ghext->num_patches() == 1);
+
+  // For incremental output, determine for each group on each level
+  // which iteration's files hold its data. Groups that have not been
+  // modified since they were last written (i.e. whose validity stamps
+  // did not change) are not written again; the metadata file refers
+  // to the earlier files instead.
+  std::vector<std::vector<int> > group_sources; // [level][gi]
+  if (incremental) {
+    struct written_t {
+      std::uint64_t stamp;
+      int iteration;
+    };
+    struct incremental_state_t {
+      int ioproc_every = -1;
+      int num_incremental = 0;
+      std::map<std::pair<int, int>, written_t> written; // [(level, gi)]
+    };
+    static std::map<std::string, incremental_state_t> states; // [path]
+    incremental_state_t &state = states[output_dir + "/" + output_file];
+
+    const bool write_full =
+        state.ioproc_every != ioproc_every ||
+        state.num_incremental >= checkpoint_incremental_full_every;
+    if (write_full) {
+      state.ioproc_every = ioproc_every;
+      state.num_incremental = 0;
+      state.written.clear();
+    } else {
+      ++state.num_incremental;
+    }
+
+    const auto &patchdata = ghext->patchdata.at(0);
+    const int nlevels = patchdata.leveldata.size();
+    const int ngroups = CCTK_NumGroups();
+    std::vector<std::uint64_t> stamps(nlevels * ngroups, 0);
+    // Stamps are process-local; a group counts as unchanged only if
+    // it is unchanged on all processes
+    std::vector<int> unchanged(nlevels * ngroups, false);
+    for (const auto &leveldata : patchdata.leveldata) {
+      for (int gi = 0; gi < ngroups; ++gi) {
+        if (!output_group.at(gi) || CCTK_GroupTypeI(gi) != CCTK_GF)
+          continue;
+        const int n = leveldata.level * ngroups + gi;
+        const auto &groupdata = *leveldata.groupdata.at(gi);
+        const int tl = 0;
+        for (const auto &why_valid : groupdata.valid.at(tl))
+          stamps.at(n) = std::max(stamps.at(n), why_valid.get_stamp());
+        const auto it = state.written.find({leveldata.level, gi});
+        unchanged.at(n) =
+            it != state.written.end() && it->second.stamp == stamps.at(n);
+      }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, unchanged.data(), unchanged.size(), MPI_INT,
+                  MPI_LAND, mpi_comm);
+
+    int num_written = 0, num_skipped = 0;
+    group_sources.resize(nlevels);
+    for (int level = 0; level < nlevels; ++level) {
+      group_sources.at(level).resize(ngroups, -1);
+      for (int gi = 0; gi < ngroups; ++gi) {
+        if (!output_group.at(gi) || CCTK_GroupTypeI(gi) != CCTK_GF)
+          continue;
+        const int n = level * ngroups + gi;
+        written_t &written = state.written[{level, gi}];
+        if (unchanged.at(n)) {
+          ++num_skipped;
+        } else {
+          written = {stamps.at(n), cctk_iteration};
+          ++num_written;
+        }
+        group_sources.at(level).at(gi) = written.iteration;
+      }
+    }
+    if (io_verbose)
+      CCTK_VINFO("Incremental Silo output: writing %d and skipping %d "
+                 "unchanged groups (over all levels)",
+                 num_written, num_skipped);
+  }
+  const auto source_iteration = [&](const int level, const int gi) {
+    return group_sources.empty() ? cctk_iteration
+                                 : group_sources.at(level).at(gi);
+  };
+
   interval_setup = nullptr;
 
   static Timer timer_data("OutputSilo.data");
@@ -785,17 +1117,13 @@ void OutputSilo(const cGH *restrict const cctkGH,
     // Loop over levels
     for (const auto &leveldata : patchdata.leveldata) {
 
-      // Loop over groups
+      // Loop over groups and derived quantities
       set<mesh_props_t> have_meshes;
-      for (int gi = 0; gi < CCTK_NumGroups(); ++gi) {
-        if (!output_group.at(gi))
-          continue;
-#warning "TODO: Output grid arrays"
-        if (CCTK_GroupTypeI(gi) != CCTK_GF)
-          continue;
-
+      amrex::FArrayBox derived_fab;
+      for (const output_item_t &item : output_items) {
+        const int gi = item.gi;
         const auto &groupdata = *leveldata.groupdata.at(gi);
-        const int numvars = groupdata.numvars;
+        const int numvars = item.dq ? 1 : groupdata.numvars;
         const int tl = 0;
         const amrex::MultiFab &mfab = *groupdata.mfab[tl];
         const amrex::IndexType &indextype = mfab.ixType();
@@ -805,6 +1133,10 @@ void OutputSilo(const cGH *restrict const cctkGH,
         const mesh_props_t mesh_props{ngrow};
         const bool have_mesh = have_meshes.count(mesh_props);
 
+        // Unchanged data are already held by earlier files
+        const bool write_data =
+            item.dq || source_iteration(leveldata.level, gi) == cctk_iteration;
+
         // Loop over components (AMReX boxes)
         const int nfabs = dm.size();
         for (int component = 0; component < nfabs; ++component) {
@@ -897,19 +1229,30 @@ void OutputSilo(const cGH *restrict const cctkGH,
             assert(!ierr);
           } // if write mesh
 
+          if (!write_data)
+            continue;
+
           // Communicate variable
           static Timer timer_mpi("OutputSilo.mpi");
           auto interval_mpi = make_unique<Interval>(timer_mpi);
           const int mpi_tag = 22900; // randomly chosen
           std::vector<CCTK_REAL> buffer;
+          const CCTK_REAL *send_data = nullptr;
+          if (send_this_fab) {
+            if (item.dq) {
+              evaluate_derived_quantity(*item.dq, patch, leveldata.level,
+                                        component, fabbox, derived_fab);
+              send_data = derived_fab.dataPtr();
+            } else {
+              send_data = mfab[component].dataPtr();
+            }
+          }
           const CCTK_REAL *data = nullptr;
           if (send_this_fab && write_this_fab) {
-            const amrex::FArrayBox &fab = mfab[component];
-            data = fab.dataPtr();
+            data = send_data;
           } else if (send_this_fab) {
-            const amrex::FArrayBox &fab = mfab[component];
             assert(numvars * zonecount <= INT_MAX);
-            MPI_Send(fab.dataPtr(), numvars * zonecount,
+            MPI_Send(send_data, numvars * zonecount,
                      mpi_datatype<CCTK_REAL>::value, ioproc, mpi_tag, mpi_comm);
           } else {
             buffer.resize(numvars * zonecount);
@@ -929,22 +1272,7 @@ void OutputSilo(const cGH *restrict const cctkGH,
             const std::string meshname =
                 make_meshname(leveldata.level, component);
 
-            const int centering = [&]() {
-              const int rank = indextype.cellCentered(0) +
-                               indextype.cellCentered(1) +
-                               indextype.cellCentered(2);
-              switch (rank) {
-              case 0:
-                return DB_NODECENT;
-              case 1:
-                return DB_EDGECENT;
-              case 2:
-                return DB_FACECENT;
-              case 3:
-                return DB_ZONECENT;
-              }
-              assert(0);
-            }();
+            const int centering = get_centering(indextype);
 
             const DB::ptr<DBoptlist> optlist = DB::make(DBMakeOptlist(10));
             assert(optlist);
@@ -984,7 +1312,9 @@ void OutputSilo(const cGH *restrict const cctkGH,
 
             for (int vi = 0; vi < numvars; ++vi) {
               const std::string varname =
-                  make_varname(gi, vi, leveldata.level, component);
+                  item.dq ? make_derived_varname(*item.dq, leveldata.level,
+                                                 component)
+                          : make_varname(gi, vi, leveldata.level, component);
 
               const void *const data_ptr = data + vi * zonecount;
 
@@ -997,7 +1327,7 @@ void OutputSilo(const cGH *restrict const cctkGH,
 
         } // for component
 
-      } // for gi
+      } // for item
     }   // for leveldata
   }     // write data
 
@@ -1035,19 +1365,14 @@ void OutputSilo(const cGH *restrict const cctkGH,
       assert(!ierr);
     }
 
-    // Loop over groups
+    // Loop over groups and derived quantities
     set<mesh_props_t> have_meshes;
-    for (int gi = 0; gi < CCTK_NumGroups(); ++gi) {
-      if (!output_group.at(gi))
-        continue;
-#warning "TODO: Output grid arrays"
-      if (CCTK_GroupTypeI(gi) != CCTK_GF)
-        continue;
-
+    for (const output_item_t &item : output_items) {
+      const int gi = item.gi;
       const auto &patchdata0 = ghext->patchdata.at(0);
       const auto &leveldata0 = patchdata0.leveldata.at(0);
       const auto &groupdata0 = *leveldata0.groupdata.at(gi);
-      const int numvars = groupdata0.numvars;
+      const int numvars = item.dq ? 1 : groupdata0.numvars;
       const int tl = 0;
       const amrex::MultiFab &mfab0 = *groupdata0.mfab[tl];
       const amrex::IndexType &indextype = mfab0.ixType();
@@ -1553,7 +1878,8 @@ void OutputSilo(const cGH *restrict const cctkGH,
         assert(!ierr);
 
         for (int vi = 0; vi < numvars; ++vi) {
-          const std::string multivarname = make_varname(gi, vi);
+          const std::string multivarname =
+              item.dq ? make_derived_varname(*item.dq) : make_varname(gi, vi);
 
           std::vector<std::string> varnames;
           const int patch = 0;
@@ -1566,13 +1892,16 @@ void OutputSilo(const cGH *restrict const cctkGH,
             const int nfabs = dm.size();
             for (int c = 0; c < nfabs; ++c) {
               const int proc = dm[c];
+              const int iteration =
+                  item.dq ? cctk_iteration
+                          : source_iteration(leveldata.level, gi);
               const std::string proc_filename =
-                  make_subdirname(output_file, cctk_iteration) + "/" +
-                  make_filename(output_file, cctk_iteration,
-                                proc / ioproc_every);
+                  make_subdirname(output_file, iteration) + "/" +
+                  make_filename(output_file, iteration, proc / ioproc_every);
               const std::string varname =
                   proc_filename + ":" +
-                  make_varname(gi, vi, leveldata.level, c);
+                  (item.dq ? make_derived_varname(*item.dq, leveldata.level, c)
+                           : make_varname(gi, vi, leveldata.level, c));
               varnames.push_back(varname);
             }
           }
@@ -1588,7 +1917,7 @@ void OutputSilo(const cGH *restrict const cctkGH,
         } // for vi
       }   // write multivar
 
-    } // for gi
+    } // for item
 
     // Write internal driver state
     {
@@ -1610,6 +1939,39 @@ void OutputSilo(const cGH *restrict const cctkGH,
         assert(!ierr);
       }
 
+      // Write box index (which file holds which component). This
+      // allows every process to read the components it owns directly
+      // when recovering, independent of the number of processes.
+      for (const auto &leveldata : patchdata.leveldata) {
+        const amrex::DistributionMapping &dm =
+            leveldata.fab->DistributionMap();
+        const int nfabs = dm.size();
+        std::vector<int> files(nfabs);
+        for (int component = 0; component < nfabs; ++component)
+          files[component] = dm[component] / ioproc_every;
+        const int dims = nfabs;
+        const std::string varname =
+            dirname + "/" + make_fabarrayfilesname(leveldata.level);
+        ierr = DBWrite(metafile.get(), varname.c_str(), files.data(), &dims, 1,
+                       DB_INT);
+        assert(!ierr);
+      }
+
+      // Write group sources (which iteration's files hold which
+      // group) for incremental output
+      if (!group_sources.empty()) {
+        for (const auto &leveldata : patchdata.leveldata) {
+          const std::vector<int> &sources =
+              group_sources.at(leveldata.level);
+          const int dims = sources.size();
+          const std::string varname =
+              dirname + "/" + make_groupsourcesname(leveldata.level);
+          ierr = DBWrite(metafile.get(), varname.c_str(), sources.data(),
+                         &dims, 1, DB_INT);
+          assert(!ierr);
+        }
+      }
+
       // Write FabArrayBase (component positions and shapes)
       for (const auto &leveldata : patchdata.leveldata) {
         const amrex::FabArrayBase &fab = *leveldata.fab;
@@ -1660,6 +2022,8 @@ void OutputSilo(const cGH *restrict const cctkGH,
           ofd.variables.push_back(CCTK_FullVarName(firstvar + vi));
         }
       }
+      for (const derived_quantity_t *const dq : output_derived)
+        ofd.variables.push_back(dq->name);
       ofd.iterations = {cctk_iteration};
       for (int d = 0; d < dim; ++d)
         ofd.output_directions.push_back(d);
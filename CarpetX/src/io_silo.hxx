@@ -5,6 +5,8 @@
 
 #ifdef HAVE_CAPABILITY_Silo
 
+#include "derived.hxx"
+
 #include <string>
 #include <vector>
 
@@ -18,7 +20,10 @@ void InputSilo(const cGH *cctkGH, const std::vector<bool> &input_group,
                const std::string &input_dir, const std::string &input_file);
 
 void OutputSilo(const cGH *cctkGH, const std::vector<bool> &output_group,
-                const std::string &output_dir, const std::string &output_file);
+                const std::string &output_dir, const std::string &output_file,
+                bool incremental = false,
+                const std::vector<const derived_quantity_t *> &output_derived =
+                    {});
 
 } // namespace CarpetX
 
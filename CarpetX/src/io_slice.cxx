@@ -0,0 +1,402 @@
+#include "io_slice.hxx"
+
+#include "driver.hxx"
+#include "timer.hxx"
+
+#include <div.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#ifdef HAVE_CAPABILITY_ADIOS2
+
+#if !defined ADIOS2_USE_MPI || !ADIOS2_USE_MPI
+#error                                                                         \
+    "CarpetX requires an MPI-enabled ADIOS2 library. Please compile ADIOS2 with MPI support and enable its use by defining ADIOS2_USE_MPI."
+#endif
+#include <adios2.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace CarpetX {
+
+struct carpetx_slice_t {
+  carpetx_slice_t() = default;
+
+  carpetx_slice_t(const carpetx_slice_t &) = delete;
+  carpetx_slice_t(carpetx_slice_t &&) = default;
+  carpetx_slice_t &operator=(const carpetx_slice_t &) = delete;
+  carpetx_slice_t &operator=(carpetx_slice_t &&) = default;
+
+  static std::optional<carpetx_slice_t> self;
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+  static constexpr bool io_verbose = false;
+
+  static constexpr int max_num_slices = 8;
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+  // A block of data that this process writes: the part of one
+  // component that intersects a slice, or the downsampled component
+  struct block_t {
+    std::string prefix; // variable name suffix
+    int component;
+    adios2::Dims shape, start, count;
+    std::array<int, dim> imin, imax; // fine grid index range
+    int slice_dir;                   // -1 for downsampled volumes
+    int factor;                      // downsampling factor
+    std::vector<CCTK_REAL> data;     // [var][point]
+  };
+
+  static std::string make_varname(const int gi, const int vi, const int patch,
+                                  const int reflevel,
+                                  const std::string &prefix) {
+    const int v0 = CCTK_FirstVarIndexI(gi);
+    std::ostringstream buf;
+    buf << CCTK_FullVarName(v0 + vi)                     //
+        << ".m" << setw(2) << setfill('0') << patch      //
+        << ".rl" << setw(2) << setfill('0') << reflevel //
+        << "." << prefix;
+    return buf.str();
+  }
+
+  template <typename T>
+  void define_attribute(const std::string &name, const T &value) {
+    if (!io.InquireAttribute<T>(name))
+      io.DefineAttribute<T>(name, value);
+  }
+  template <typename T>
+  void define_attribute(const std::string &name, const std::vector<T> &value) {
+    if (!io.InquireAttribute<T>(name))
+      io.DefineAttribute<T>(name, value.data(), value.size());
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+  adios2::ADIOS adios;
+  adios2::IO io;
+  adios2::Engine engine;
+
+  void OutputSlices(const cGH *const cctkGH,
+                    const std::vector<bool> &output_group,
+                    const std::string &output_dir,
+                    const std::string &output_file);
+  ~carpetx_slice_t();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+void OutputSlices(const cGH *const cctkGH,
+                  const std::vector<bool> &output_group,
+                  const std::string &output_dir,
+                  const std::string &output_file) {
+  if (!carpetx_slice_t::self)
+    carpetx_slice_t::self = std::make_optional<carpetx_slice_t>();
+  carpetx_slice_t::self->OutputSlices(cctkGH, output_group, output_dir,
+                                      output_file);
+}
+
+void ShutdownSlices() { carpetx_slice_t::self.reset(); }
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::optional<carpetx_slice_t> carpetx_slice_t::self;
+
+void carpetx_slice_t::OutputSlices(const cGH *const cctkGH,
+                                   const std::vector<bool> &output_group,
+                                   const std::string &output_dir,
+                                   const std::string &output_file) {
+  DECLARE_CCTK_ARGUMENTS;
+  DECLARE_CCTK_PARAMETERS;
+
+  // Set up timers
+  static Timer timer("OutputSlices");
+  Interval interval(timer);
+
+  if (std::count(output_group.begin(), output_group.end(), true) == 0)
+    return;
+
+  // Collect slices
+  std::vector<std::pair<int, CCTK_REAL> > slices; // [slice](dir, coord)
+  for (int n = 0; n < max_num_slices; ++n) {
+    if (CCTK_EQUALS(out_slice_normals[n], "none"))
+      continue;
+    const int dir = CCTK_EQUALS(out_slice_normals[n], "x")   ? 0
+                    : CCTK_EQUALS(out_slice_normals[n], "y") ? 1
+                                                             : 2;
+    slices.emplace_back(dir, out_slice_coords[n]);
+  }
+  const int factor = out_downsample_factor;
+  if (slices.empty() && factor == 0)
+    return;
+
+  if (io_verbose)
+    CCTK_VINFO("OutputSlices...");
+
+  try {
+
+    if (!io) {
+      // "Fortran" enables column-major mode
+      adios = adios2::ADIOS("", MPI_COMM_WORLD, "Fortran");
+      // The name "Slices" must be unique in the ADIOS object
+      io = adios.DeclareIO("Slices");
+
+      std::ostringstream buf;
+      const int mode = 0755;
+      static once_flag create_directory;
+      call_once(create_directory, [&]() {
+        const int ierr = CCTK_CreateDirectory(mode, output_dir.c_str());
+        assert(ierr >= 0);
+      });
+      buf << output_dir << "/" << output_file << ".slices.bp5";
+      const std::string filename = buf.str();
+      engine = io.Open(filename, adios2::Mode::Write);
+    }
+
+    for (std::size_t n = 0; n < slices.size(); ++n) {
+      std::ostringstream buf;
+      buf << "slice" << setw(2) << setfill('0') << n;
+      define_attribute<std::string>(buf.str() + "/normal",
+                                    std::string(1, "xyz"[slices[n].first]));
+      define_attribute<double>(buf.str() + "/coord", slices[n].second);
+    }
+    if (factor > 0)
+      define_attribute<int>("downsampled/factor", factor);
+
+    engine.BeginStep();
+
+    // Blocks need to remain allocated until the step ends
+    std::vector<block_t> blocks;
+
+    for (const auto &patchdata : ghext->patchdata) {
+      for (const auto &leveldata : patchdata.leveldata) {
+
+        const amrex::Geometry &geom = patchdata.amrcore->Geom(leveldata.level);
+
+        const int numgroups = CCTK_NumGroups();
+        for (int gi = 0; gi < numgroups; ++gi) {
+          if (!output_group.at(gi))
+            continue;
+          if (CCTK_GroupTypeI(gi) != CCTK_GF)
+            continue;
+
+          const auto &groupdata = *leveldata.groupdata.at(gi);
+          const int numvars = groupdata.numvars;
+          const int tl = 0;
+          const amrex::MultiFab &mfab = *groupdata.mfab[tl];
+          // Domain in the index space of this group
+          const amrex::Box gdom = amrex::convert(geom.Domain(), mfab.ixType());
+
+          std::array<CCTK_REAL, dim> x0, dx;
+          for (int d = 0; d < dim; ++d) {
+            dx[d] = geom.CellSize(d);
+            x0[d] = geom.ProbLo(d) + groupdata.indextype[d] * dx[d] / 2;
+          }
+
+          // Find the blocks that this process writes
+          std::vector<block_t> group_blocks;
+          const int num_local_components = mfab.local_size();
+          for (int local_component = 0;
+               local_component < num_local_components; ++local_component) {
+            const int component = mfab.IndexArray().at(local_component);
+            const amrex::Box &vbx = mfab.box(component); // interior
+
+            for (std::size_t n = 0; n < slices.size(); ++n) {
+              const int sd = slices[n].first;
+              const int iplane = lrint((slices[n].second - x0[sd]) / dx[sd]);
+              if (iplane < vbx.smallEnd(sd) || iplane > vbx.bigEnd(sd))
+                continue;
+              block_t block;
+              std::ostringstream buf;
+              buf << "slice" << setw(2) << setfill('0') << n;
+              block.prefix = buf.str();
+              block.component = component;
+              for (int d = 0; d < dim; ++d) {
+                block.imin[d] = d == sd ? iplane : vbx.smallEnd(d);
+                block.imax[d] = d == sd ? iplane + 1 : vbx.bigEnd(d) + 1;
+                if (d == sd)
+                  continue;
+                block.shape.push_back(gdom.length(d));
+                block.start.push_back(vbx.smallEnd(d) - gdom.smallEnd(d));
+                block.count.push_back(vbx.length(d));
+              }
+              block.slice_dir = sd;
+              block.factor = 1;
+              group_blocks.push_back(std::move(block));
+            }
+
+            if (factor > 0) {
+              // Use the cell centred box so that coarse cells never
+              // straddle components. Vertex centred values on the
+              // upper domain boundary are thus not represented.
+              const amrex::Box &cbx = leveldata.fab->box(component);
+              const amrex::Box &cdom = geom.Domain();
+              block_t block;
+              block.prefix = "downsampled";
+              block.component = component;
+              for (int d = 0; d < dim; ++d) {
+                if (cbx.smallEnd(d) % factor != 0 ||
+                    (cbx.bigEnd(d) + 1) % factor != 0 ||
+                    cdom.smallEnd(d) % factor != 0 ||
+                    (cdom.bigEnd(d) + 1) % factor != 0)
+                  CCTK_VERROR("The grid is not aligned with "
+                              "CarpetX::out_downsample_factor=%d. The "
+                              "blocking factor and the domain size must be "
+                              "multiples of the downsampling factor.",
+                              factor);
+                block.imin[d] = cbx.smallEnd(d);
+                block.imax[d] = cbx.bigEnd(d) + 1;
+                block.shape.push_back(cdom.length(d) / factor);
+                block.start.push_back((cbx.smallEnd(d) - cdom.smallEnd(d)) /
+                                      factor);
+                block.count.push_back(cbx.length(d) / factor);
+              }
+              block.slice_dir = -1;
+              block.factor = factor;
+              group_blocks.push_back(std::move(block));
+            }
+          } // for local_component
+
+          // Extract and downsample data, in parallel over blocks
+          const int nblocks = group_blocks.size();
+#pragma omp parallel for schedule(dynamic)
+          for (int b = 0; b < nblocks; ++b) {
+            block_t &block = group_blocks[b];
+            const amrex::Array4<const CCTK_REAL> vars =
+                mfab.const_array(block.component);
+            const int f = block.factor;
+            std::array<int, dim> cmin, cshape;
+            std::size_t np = 1;
+            for (int d = 0; d < dim; ++d) {
+              cmin[d] = div_floor(block.imin[d], f);
+              cshape[d] = div_floor(block.imax[d] - block.imin[d], f);
+              np *= cshape[d];
+            }
+            block.data.resize(numvars * np);
+            const CCTK_REAL scale = CCTK_REAL(1) / (f * f * f);
+            for (int vi = 0; vi < numvars; ++vi) {
+              CCTK_REAL *restrict const ptr = &block.data[vi * np];
+              for (int k = 0; k < cshape[2]; ++k) {
+                for (int j = 0; j < cshape[1]; ++j) {
+                  for (int i = 0; i < cshape[0]; ++i) {
+                    const int i0 = (cmin[0] + i) * f;
+                    const int j0 = (cmin[1] + j) * f;
+                    const int k0 = (cmin[2] + k) * f;
+                    CCTK_REAL sum = 0;
+                    for (int kk = 0; kk < f; ++kk)
+                      for (int jj = 0; jj < f; ++jj)
+                        for (int ii = 0; ii < f; ++ii)
+                          sum += vars(i0 + ii, j0 + jj, k0 + kk, vi);
+                    ptr[i + cshape[0] * (j + cshape[1] * k)] = scale * sum;
+                  }
+                }
+              }
+            }
+          }
+
+          // Describe the coordinates of each kind of output
+          for (int d = 0; d < dim; ++d)
+            assert(gdom.smallEnd(d) == geom.Domain().smallEnd(d));
+          {
+            std::ostringstream buf;
+            buf << CCTK_FullGroupName(gi) << ".m" << setw(2) << setfill('0')
+                << patchdata.patch << ".rl" << setw(2) << setfill('0')
+                << leveldata.level;
+            const std::string name = buf.str();
+            std::vector<double> origin(dim), spacing(dim);
+            for (int d = 0; d < dim; ++d) {
+              origin[d] = x0[d] + gdom.smallEnd(d) * dx[d];
+              spacing[d] = dx[d];
+            }
+            define_attribute<double>(name + "/origin", origin);
+            define_attribute<double>(name + "/spacing", spacing);
+            if (factor > 0) {
+              for (int d = 0; d < dim; ++d) {
+                // Coarse cells are centred between the fine points
+                // they average
+                origin[d] += (factor - 1) * dx[d] / 2;
+                spacing[d] *= factor;
+              }
+              define_attribute<double>(name + "/downsampled/origin", origin);
+              define_attribute<double>(name + "/downsampled/spacing", spacing);
+            }
+          }
+
+          // Write blocks
+          for (const block_t &block : group_blocks) {
+            std::size_t np = 1;
+            for (const auto c : block.count)
+              np *= c;
+            for (int vi = 0; vi < numvars; ++vi) {
+              const std::string varname = make_varname(
+                  gi, vi, patchdata.patch, leveldata.level, block.prefix);
+              adios2::Variable<CCTK_REAL> var =
+                  io.InquireVariable<CCTK_REAL>(varname);
+              if (!var)
+                var = io.DefineVariable<CCTK_REAL>(varname, block.shape);
+              else
+                var.SetShape(block.shape);
+              var.SetSelection({block.start, block.count});
+              engine.Put(var, &block.data[vi * np]);
+            }
+          }
+
+          for (auto &block : group_blocks)
+            blocks.push_back(std::move(block));
+        } // for gi
+
+      } // for leveldata
+    }   // for patchdata
+
+    engine.PerformPuts();
+    engine.EndStep();
+
+  } catch (std::invalid_argument &e) {
+    std::cerr << "Invalid argument exception: " << e.what() << "\n";
+    CCTK_Abort(nullptr, 1);
+  } catch (std::ios_base::failure &e) {
+    std::cerr << "IO System base failure exception: " << e.what() << "\n";
+    CCTK_Abort(nullptr, 1);
+  } catch (std::exception &e) {
+    std::cerr << "Exception: " << e.what() << "\n";
+    CCTK_Abort(nullptr, 1);
+  }
+
+  if (io_verbose)
+    CCTK_VINFO("OutputSlices done.");
+}
+
+carpetx_slice_t::~carpetx_slice_t() {
+  if (engine) {
+    if (io_verbose)
+      CCTK_VINFO("ADIOS2: Closing slice engine...");
+    engine.Close();
+  }
+}
+
+} // namespace CarpetX
+
+#else
+
+namespace CarpetX {
+void ShutdownSlices() {}
+} // namespace CarpetX
+
+#endif // #ifdef HAVE_CAPABILITY_ADIOS2
@@ -0,0 +1,23 @@
+#ifndef CARPETX_CARPETX_IO_SLICE_HXX
+#define CARPETX_CARPETX_IO_SLICE_HXX
+
+#include <cctk.h>
+
+#ifdef HAVE_CAPABILITY_ADIOS2
+
+#include <string>
+#include <vector>
+
+namespace CarpetX {
+
+// Output coordinate-aligned 2d planes and box-averaged (downsampled)
+// 3d volumes of grid functions via ADIOS2
+void OutputSlices(const cGH *cctkGH, const std::vector<bool> &output_group,
+                  const std::string &output_dir,
+                  const std::string &output_file);
+
+} // namespace CarpetX
+
+#endif
+
+#endif // #ifndef CARPETX_CARPETX_IO_SLICE_HXX
@@ -1,5 +1,6 @@
 #include "io_tsv.hxx"
 
+#include "derived.hxx"
 #include "driver.hxx"
 #include "mpi_types.hxx"
 #include "timer.hxx"
@@ -7,8 +8,11 @@
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
+#include <mpi.h>
+
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <fstream>
 #include <iomanip>
 #include <limits>
@@ -16,6 +20,7 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -212,20 +217,242 @@ void WriteTSVArrays(const cGH *restrict cctkGH, const string &filename,
   }
 }
 
+namespace {
+// Write data on a line without gathering it onto a single process.
+// Each process sorts its own points. The points are then
+// redistributed by their position along the line so that each
+// process holds a contiguous range, where duplicates are removed.
+// Finally, all processes write their range with a collective MPI-IO
+// call.
+//
+// `data` holds `nvalues` values per point: `nintvalues` integer values
+// (patch, level, grid point index, isghost), the coordinates, and the
+// values named by `varnames`.
+void WriteTSVGFsDistributed(const cGH *restrict cctkGH, const string &filename,
+                            const int gi, const vect<bool, dim> &outdirs,
+                            const bool binary, const int nintvalues,
+                            const int nvalues, const vector<string> &varnames,
+                            const vector<CCTK_REAL> &data) {
+  const MPI_Comm comm = amrex::ParallelDescriptor::Communicator();
+  const int myproc = amrex::ParallelDescriptor::MyProc();
+  const int nprocs = amrex::ParallelDescriptor::NProcs();
+
+  // Enumerate all possible points on the line ("slots"). Slots are
+  // ordered by patch, level, and grid point index, which is the order
+  // in which points are written.
+  struct line_extent_t {
+    vect<int, dim> imin, shape;
+    int64_t offset;
+  };
+  vector<vector<line_extent_t> > line_extents; // [patch][level]
+  int64_t nslots = 0;
+  for (const auto &patchdata : ghext->patchdata) {
+    line_extents.emplace_back();
+    for (const auto &leveldata : patchdata.leveldata) {
+      const int tl = 0;
+      const auto &mfab = *leveldata.groupdata.at(gi)->mfab.at(tl);
+      amrex::Box bnd = mfab.boxArray().minimalBox();
+      bnd.grow(mfab.nGrowVect());
+      line_extent_t line_extent;
+      int64_t npoints = 1;
+      for (int d = 0; d < dim; ++d) {
+        line_extent.imin[d] = bnd.smallEnd(d);
+        line_extent.shape[d] = outdirs[d] ? bnd.length(d) : 1;
+        npoints *= line_extent.shape[d];
+      }
+      line_extent.offset = nslots;
+      nslots += npoints;
+      line_extents.back().push_back(line_extent);
+    }
+  }
+  const auto get_slot = [&](const CCTK_REAL *restrict const point) {
+    const int patch = int(point[0]);
+    const int level = int(point[1]);
+    const line_extent_t &line_extent = line_extents.at(patch).at(level);
+    int64_t slot = 0;
+    for (int d = 0; d < dim; ++d) {
+      if (outdirs[d]) {
+        const int i = int(point[2 + d]) - line_extent.imin[d];
+        assert(i >= 0 && i < line_extent.shape[d]);
+        slot = slot * line_extent.shape[d] + i;
+      }
+    }
+    return line_extent.offset + slot;
+  };
+  const auto get_owner = [&](const int64_t slot) {
+    return int(slot * nprocs / max(nslots, int64_t(1)));
+  };
+
+  // Sort points by slot, and remove duplicates. Prefer interior over
+  // ghost points.
+  const auto sort_points = [&](const vector<CCTK_REAL> &points) {
+    assert(points.size() % nvalues == 0);
+    const int npoints = points.size() / nvalues;
+    vector<tuple<int64_t, bool, int> > keys(npoints);
+    for (int n = 0; n < npoints; ++n) {
+      const CCTK_REAL *restrict const point = &points.at(n * nvalues);
+      keys.at(n) = make_tuple(get_slot(point), bool(point[2 + dim]), n);
+    }
+    sort(keys.begin(), keys.end());
+    const auto last =
+        unique(keys.begin(), keys.end(), [](const auto &a, const auto &b) {
+          return get<0>(a) == get<0>(b);
+        });
+    keys.erase(last, keys.end());
+    return keys;
+  };
+
+  // Sort local points and send them to their owners
+  vector<CCTK_REAL> sorted_data;
+  vector<int> sendcounts(nprocs, 0);
+  {
+    const auto keys = sort_points(data);
+    sorted_data.reserve(keys.size() * nvalues);
+    for (const auto &key : keys) {
+      const int n = get<2>(key);
+      sorted_data.insert(sorted_data.end(), &data.at(n * nvalues),
+                         &data.at(n * nvalues) + nvalues);
+      sendcounts.at(get_owner(get<0>(key))) += nvalues;
+    }
+  }
+  vector<int> recvcounts(nprocs);
+  MPI_Alltoall(sendcounts.data(), 1, MPI_INT, recvcounts.data(), 1, MPI_INT,
+               comm);
+  vector<int> senddispls(nprocs), recvdispls(nprocs);
+  int total_send = 0, total_recv = 0;
+  for (int p = 0; p < nprocs; ++p) {
+    senddispls.at(p) = total_send;
+    recvdispls.at(p) = total_recv;
+    assert(total_send <= INT_MAX - sendcounts.at(p));
+    assert(total_recv <= INT_MAX - recvcounts.at(p));
+    total_send += sendcounts.at(p);
+    total_recv += recvcounts.at(p);
+  }
+  vector<CCTK_REAL> owned_data(total_recv);
+  MPI_Alltoallv(sorted_data.data(), sendcounts.data(), senddispls.data(),
+                mpi_datatype<CCTK_REAL>::value, owned_data.data(),
+                recvcounts.data(), recvdispls.data(),
+                mpi_datatype<CCTK_REAL>::value, comm);
+  sorted_data = {};
+
+  // Merge the sorted runs we received, removing duplicates between
+  // processes
+  const auto keys = sort_points(owned_data);
+
+  // Format our part of the file
+  int64_t total_npoints = keys.size();
+  MPI_Allreduce(MPI_IN_PLACE, &total_npoints, 1, MPI_INT64_T, MPI_SUM, comm);
+  string buffer;
+  {
+    ostringstream buf;
+    const string sep = "\t";
+    buf << setprecision(numeric_limits<CCTK_REAL>::digits10 + 1) << scientific;
+    if (myproc == 0) {
+      if (binary) {
+        const int ncols = 2 + (nintvalues - 1) + (nvalues - nintvalues);
+        buf << "# carpetx-line-binary-1.0.0\n"
+            << "# real_size: " << sizeof(CCTK_REAL) << sep
+            << "columns: " << ncols << sep << "records: " << total_npoints
+            << "\n";
+      }
+      // Output header
+      int col = 0;
+      buf << "# " << ++col << ":iteration";
+      buf << sep << ++col << ":time";
+      buf << sep << ++col << ":patch";
+      buf << sep << ++col << ":level";
+      for (int d = 0; d < dim; ++d)
+        buf << sep << ++col << ":"
+            << "ijk"[d];
+      for (int d = 0; d < dim; ++d)
+        buf << sep << ++col << ":"
+            << "xyz"[d];
+      for (const auto &varname : varnames)
+        buf << sep << ++col << ":" << varname;
+      buf << "\n";
+    }
+    if (binary) {
+      // Each record holds all columns as `CCTK_REAL` values
+      vector<CCTK_REAL> record;
+      for (const auto &key : keys) {
+        const CCTK_REAL *restrict const point =
+            &owned_data.at(get<2>(key) * nvalues);
+        record.clear();
+        record.push_back(cctkGH->cctk_iteration);
+        record.push_back(cctkGH->cctk_time);
+        for (int v = 0; v < nvalues; ++v)
+          if (v != dim + 2) // skip `isghost` marker
+            record.push_back(point[v]);
+        buf.write(reinterpret_cast<const char *>(record.data()),
+                  record.size() * sizeof(CCTK_REAL));
+      }
+    } else {
+      for (const auto &key : keys) {
+        const CCTK_REAL *restrict const point =
+            &owned_data.at(get<2>(key) * nvalues);
+        buf << cctkGH->cctk_iteration << sep << cctkGH->cctk_time;
+        for (int v = 0; v < nintvalues; ++v)
+          if (v != dim + 2) // skip `isghost` marker
+            buf << sep << int(point[v]);
+        for (int v = nintvalues; v < nvalues; ++v)
+          buf << sep << point[v];
+        buf << "\n";
+      }
+    }
+    buffer = buf.str();
+  }
+
+  // Write the file collectively
+  long long mysize = buffer.size();
+  long long myoffset = 0;
+  MPI_Exscan(&mysize, &myoffset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+  if (myproc == 0)
+    myoffset = 0;
+
+  MPI_File file;
+  int ierr = MPI_File_open(comm, filename.c_str(),
+                           MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                           &file);
+  assert(!ierr);
+  ierr = MPI_File_set_size(file, 0);
+  assert(!ierr);
+  assert(buffer.size() <= INT_MAX);
+  ierr = MPI_File_write_at_all(file, myoffset, buffer.data(), buffer.size(),
+                               MPI_BYTE, MPI_STATUS_IGNORE);
+  assert(!ierr);
+  ierr = MPI_File_close(&file);
+  assert(!ierr);
+}
+} // namespace
+
+// Output either the grid functions of group `gi`, or (if `derived` is
+// given) a derived quantity. A derived quantity is evaluated on the
+// line only and uses the layout of the group `gi` of its first input.
 void WriteTSVGFs(const cGH *restrict cctkGH, const string &filename,
                  const int gi, const vect<bool, dim> &outdirs,
-                 const vect<CCTK_REAL, dim> &outcoords) {
+                 const vect<CCTK_REAL, dim> &outcoords,
+                 const derived_quantity_t *const derived = nullptr) {
+  DECLARE_CCTK_PARAMETERS;
+
   const auto &groupdata0 =
       *ghext->patchdata.at(0).leveldata.at(0).groupdata.at(gi);
 
+  vector<string> varnames;
+  if (derived)
+    varnames.push_back(derived->name);
+  else
+    for (int vi = 0; vi < groupdata0.numvars; ++vi)
+      varnames.push_back(CCTK_VarName(groupdata0.firstvarindex + vi));
+  const int numvalues = varnames.size();
+
   // Number of values transmitted per grid point
-  const int nintvalues = 1                  // patch
-                         + 1                // level
-                         + dim              // grid point index
-                         + 1;               // isghost
-  const int nvalues = nintvalues            // integer values
-                      + dim                 // coordinates
-                      + groupdata0.numvars; // grid function values
+  const int nintvalues = 1         // patch
+                         + 1       // level
+                         + dim     // grid point index
+                         + 1;      // isghost
+  const int nvalues = nintvalues   // integer values
+                      + dim        // coordinates
+                      + numvalues; // grid function values
 
   // Data transmitted from this process
   vector<CCTK_REAL> data;
@@ -263,6 +490,9 @@ void WriteTSVGFs(const cGH *restrict cctkGH, const string &filename,
       const vect<int, dim> nghosts = {mfab.nGrow(0), mfab.nGrow(1),
                                       mfab.nGrow(2)};
 
+      // Staging buffer for derived quantities
+      amrex::FArrayBox derived_fab;
+
       for (amrex::MFIter mfi(mfab); mfi.isValid(); ++mfi) {
         const amrex::Array4<const CCTK_REAL> &vars = mfab.array(mfi);
 
@@ -302,6 +532,14 @@ void WriteTSVGFs(const cGH *restrict cctkGH, const string &filename,
         }
 
         if (output_something) {
+          if (derived)
+            evaluate_derived_quantity(
+                *derived, patchdata.patch, leveldata.level, mfi,
+                amrex::Box(amrex::IntVect(imin[0], imin[1], imin[2]),
+                           amrex::IntVect(imax[0] - 1, imax[1] - 1,
+                                          imax[2] - 1),
+                           mfab.ixType()),
+                derived_fab);
           for (int k = imin[2]; k < imax[2]; ++k) {
             for (int j = imin[1]; j < imax[1]; ++j) {
               for (int i = imin[0]; i < imax[0]; ++i) {
@@ -315,8 +553,11 @@ void WriteTSVGFs(const cGH *restrict cctkGH, const string &filename,
                 data.push_back(isghost);
                 for (int d = 0; d < dim; ++d)
                   data.push_back(x0[d] + I[d] * dx[d]);
-                for (int vi = 0; vi < groupdata.numvars; ++vi)
-                  data.push_back(vars(i, j, k, vi));
+                if (derived)
+                  data.push_back(derived_fab(amrex::IntVect(i, j, k)));
+                else
+                  for (int vi = 0; vi < groupdata.numvars; ++vi)
+                    data.push_back(vars(i, j, k, vi));
                 assert(data.size() == old_size + nvalues);
               }
             }
@@ -327,6 +568,13 @@ void WriteTSVGFs(const cGH *restrict cctkGH, const string &filename,
   }       // for patchdata
   assert(data.size() % nvalues == 0);
 
+  if (CCTK_EQUALS(out_tsv_mode, "distributed")) {
+    const bool binary = CCTK_EQUALS(out_tsv_format, "binary");
+    WriteTSVGFsDistributed(cctkGH, filename, gi, outdirs, binary, nintvalues,
+                           nvalues, varnames, data);
+    return;
+  }
+
   const MPI_Comm comm = amrex::ParallelDescriptor::Communicator();
   const int myproc = amrex::ParallelDescriptor::MyProc();
   const int nprocs = amrex::ParallelDescriptor::NProcs();
@@ -387,10 +635,6 @@ void WriteTSVGFs(const cGH *restrict cctkGH, const string &filename,
     const auto last = unique(iptr.begin(), iptr.end(), compare_eq);
     iptr.erase(last, iptr.end());
 
-    vector<string> varnames;
-    for (int vi = 0; vi < groupdata0.numvars; ++vi)
-      varnames.push_back(CCTK_VarName(groupdata0.firstvarindex + vi));
-
     const string sep = "\t";
     ofstream file(filename);
     // get more precision for floats, could also use
@@ -434,12 +678,41 @@ void OutputTSV(const cGH *restrict cctkGH) {
   DECLARE_CCTK_ARGUMENTS;
   DECLARE_CCTK_PARAMETERS;
 
-  if (out_tsv_vars[0] == '\0')
+  if (out_tsv_vars[0] == '\0' && out_tsv_derived[0] == '\0')
     return;
 
   static Timer timer("OutputTSVUni");
   Interval interval(timer);
 
+  const bool binary = CCTK_EQUALS(out_tsv_format, "binary");
+  if (binary && !CCTK_EQUALS(out_tsv_mode, "distributed"))
+    CCTK_VERROR("The binary line output format requires "
+                "CarpetX::out_tsv_mode = \"distributed\"");
+  const string gf_suffix = binary ? ".bin" : ".tsv";
+
+  // Output derived quantities
+  for (const derived_quantity_t *const dq :
+       find_derived_quantities(out_tsv_derived)) {
+    string name = dq->name;
+    name = regex_replace(name, regex("::"), "-");
+    for (auto &ch : name)
+      ch = tolower(ch);
+    ostringstream buf;
+    buf << out_dir << "/derived-" << name << ".it" << setw(6) << setfill('0')
+        << cctk_iteration;
+    const string basename = buf.str();
+    const int gi = get_derived_layout_group(*dq);
+    WriteTSVGFs(cctkGH, basename + ".x" + gf_suffix, gi, {true, false, false},
+                {0, out_xline_y, out_xline_z}, dq);
+    WriteTSVGFs(cctkGH, basename + ".y" + gf_suffix, gi, {false, true, false},
+                {out_yline_x, 0, out_yline_z}, dq);
+    WriteTSVGFs(cctkGH, basename + ".z" + gf_suffix, gi, {false, false, true},
+                {out_zline_x, out_zline_y, 0}, dq);
+  }
+
+  if (out_tsv_vars[0] == '\0')
+    return;
+
   // Find output groups
   const vector<bool> group_enabled = [&] {
     vector<bool> enabled(CCTK_NumGroups(), false);
@@ -483,12 +756,12 @@ void OutputTSV(const cGH *restrict cctkGH) {
         WriteTSVArrays(cctkGH, basename + ".z.tsv", gi, 2);
         break;
       case CCTK_GF:
-        WriteTSVGFs(cctkGH, basename + ".x.tsv", gi, {true, false, false},
-                    {0, out_xline_y, out_xline_z});
-        WriteTSVGFs(cctkGH, basename + ".y.tsv", gi, {false, true, false},
-                    {out_yline_x, 0, out_yline_z});
-        WriteTSVGFs(cctkGH, basename + ".z.tsv", gi, {false, false, true},
-                    {out_zline_x, out_zline_y, 0});
+        WriteTSVGFs(cctkGH, basename + ".x" + gf_suffix, gi,
+                    {true, false, false}, {0, out_xline_y, out_xline_z});
+        WriteTSVGFs(cctkGH, basename + ".y" + gf_suffix, gi,
+                    {false, true, false}, {out_yline_x, 0, out_yline_z});
+        WriteTSVGFs(cctkGH, basename + ".z" + gf_suffix, gi,
+                    {false, false, true}, {out_zline_x, out_zline_y, 0});
         break;
       default:
         assert(0);
@@ -1,147 +1,397 @@
 #include "driver.hxx"
+#include "schedule.hxx"
 
 #include <cctk.h>
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
 #include <AMReX.H>
+#include <AMReX_MLABecLaplacian.H>
 #include <AMReX_MLMG.H>
 #include <AMReX_MLNodeLaplacian.H>
+#include <AMReX_MultiFabUtil.H>
 
+#include <array>
+#include <cassert>
 #include <cmath>
+#include <optional>
+#include <sstream>
+#include <type_traits>
 #include <vector>
 
 namespace CarpetX {
 using namespace std;
 
-extern "C" void CarpetX_SolvePoisson(const CCTK_INT gi_sol,
-                                     const CCTK_INT gi_rhs,
-                                     const CCTK_INT gi_res,
-                                     const CCTK_REAL reltol,
-                                     const CCTK_REAL abstol,
-                                     CCTK_REAL *restrict const res_initial,
-                                     CCTK_REAL *restrict const res_final) {
-  assert(gi_rhs >= 0);
-  assert(gi_sol >= 0);
-  const bool have_res = gi_res >= 0;
-  if (have_res)
-    assert(gi_res >= 0);
-  const int tl = 0;
-  const int vi = 0;
+namespace {
+
+// A grid function variable, decoded from its Cactus variable index
+struct linsolve_var_t {
+  int vn, gi, vi;
+  linsolve_var_t(const int vn) : vn(vn) {
+    assert(vn >= 0);
+    gi = CCTK_GroupIndexFromVarI(vn);
+    assert(gi >= 0);
+    vi = vn - CCTK_FirstVarIndexI(gi);
+    assert(vi >= 0);
+  }
+};
+
+typedef array<array<amrex::LinOpBCType, dim>, 2> linop_bcs_t;
 
-  // Create operator
+// Domain boundary conditions of the elliptic operator for variable
+// `vi` of a group. Dirichlet values are taken from the boundary points
+// (vertex-centred) or ghost points (cell-centred) of the solution.
+linop_bcs_t
+get_linop_bcs(const GHExt::PatchData &patchdata,
+              const GHExt::PatchData::LevelData::GroupData &groupdata,
+              const int vi) {
+  linop_bcs_t bcs;
+  for (int f = 0; f < 2; ++f) {
+    for (int d = 0; d < dim; ++d) {
+      auto &bc = bcs[f][d];
+      switch (patchdata.symmetries[f][d]) {
+      case symmetry_t::none:
+        switch (groupdata.boundaries[f][d]) {
+        case boundary_t::none:
+          // Keep the current boundary values of the solution
+        case boundary_t::dirichlet:
+          bc = amrex::LinOpBCType::Dirichlet;
+          break;
+        case boundary_t::neumann:
+          bc = amrex::LinOpBCType::Neumann;
+          break;
+        default: {
+          ostringstream buf;
+          buf << groupdata.boundaries[f][d];
+          CCTK_VERROR("Group %s: The boundary condition \"%s\" is not "
+                      "supported by the multigrid solver",
+                      CCTK_FullGroupName(groupdata.groupindex),
+                      buf.str().c_str());
+        }
+        }
+        break;
+      case symmetry_t::interpatch:
+        CCTK_VERROR("Group %s: Interpatch boundaries are not supported by the "
+                    "multigrid solver",
+                    CCTK_FullGroupName(groupdata.groupindex));
+        break;
+      case symmetry_t::periodic:
+        bc = amrex::LinOpBCType::Periodic;
+        break;
+      case symmetry_t::reflection:
+        // Odd variables vanish on a vertex-centred symmetry plane
+        if (groupdata.parities.at(vi)[d] > 0)
+          bc = amrex::LinOpBCType::Neumann;
+        else if (groupdata.indextype[d] == 0)
+          bc = amrex::LinOpBCType::Dirichlet;
+        else
+          bc = amrex::LinOpBCType::reflect_odd;
+        break;
+      default:
+        assert(0);
+      }
+    }
+  }
+  return bcs;
+}
+
+// Solve div (sigma grad sol) = rhs on one patch for several variables
+void solve_elliptic(const int patch, const vector<linsolve_var_t> &sol_vars,
+                    const vector<linsolve_var_t> &rhs_vars,
+                    const vector<int> &res_vns, const int vn_sigma,
+                    const bool warm_start, const CCTK_REAL reltol,
+                    const CCTK_REAL abstol,
+                    CCTK_REAL *restrict const res_initial,
+                    CCTK_REAL *restrict const res_final) {
+  const int tl = 0;
+  const int nvars = sol_vars.size();
 
-  assert(ghext->patchdata.size() == 1);
-  const int patch = 0;
   const auto &patchdata = ghext->patchdata.at(patch);
-  amrex::Vector<amrex::Geometry> geoms(patchdata.leveldata.size());
-  amrex::Vector<amrex::BoxArray> grids(patchdata.leveldata.size());
-  amrex::Vector<amrex::DistributionMapping> dmaps(patchdata.leveldata.size());
-  for (int level = 0; level < int(patchdata.leveldata.size()); ++level) {
+  const int nlevels = patchdata.leveldata.size();
+  amrex::Vector<amrex::Geometry> geoms(nlevels);
+  amrex::Vector<amrex::BoxArray> grids(nlevels);
+  amrex::Vector<amrex::DistributionMapping> dmaps(nlevels);
+  for (int level = 0; level < nlevels; ++level) {
     geoms.at(level) = patchdata.amrcore->Geom(level);
     grids.at(level) = patchdata.amrcore->boxArray(level);
     dmaps.at(level) = patchdata.amrcore->DistributionMap(level);
   }
 
-  amrex::MLNodeLaplacian mlnodelaplacian(geoms, grids, dmaps);
-
-  // TODO: Look at Geometry for this
-  mlnodelaplacian.setDomainBC(
-      {amrex::LinOpBCType::Dirichlet, amrex::LinOpBCType::Dirichlet,
-       amrex::LinOpBCType::Dirichlet},
-      {amrex::LinOpBCType::Dirichlet, amrex::LinOpBCType::Dirichlet,
-       amrex::LinOpBCType::Dirichlet});
-
-  vector<amrex::MultiFab> sigmas(patchdata.leveldata.size());
-  for (int level = 0; level < int(patchdata.leveldata.size()); ++level) {
-    auto &sigma = sigmas.at(level);
-    sigma.define(patchdata.amrcore->boxArray(level),
-                 patchdata.amrcore->DistributionMap(level), 1, 0);
-    sigma.setVal(1.0);
-    mlnodelaplacian.setSigma(level, sigma);
-  }
+  const auto get_groupdata = [&](const int level, const int gi)
+      -> GHExt::PatchData::LevelData::GroupData & {
+    return *patchdata.leveldata.at(level).groupdata.at(gi);
+  };
+  // Alias a single variable of a group as MultiFab
+  const auto get_mfab = [&](const int level, const linsolve_var_t &var) {
+    const auto &groupdata = get_groupdata(level, var.gi);
+    return amrex::MultiFab(*groupdata.mfab.at(tl), amrex::make_alias, var.vi,
+                           1);
+  };
 
-  mlnodelaplacian.setVerbose(10);
+  // Coefficient sigma (cell-centred), or nullopt if sigma = 1
+  const optional<linsolve_var_t> sigma_var =
+      vn_sigma >= 0 ? make_optional<linsolve_var_t>(vn_sigma) : nullopt;
+  if (sigma_var) {
+    const auto &groupdata = get_groupdata(0, sigma_var->gi);
+    if (groupdata.indextype != array<int, dim>{1, 1, 1})
+      CCTK_VERROR("Group %s: The coefficient sigma must be cell-centred",
+                  CCTK_FullGroupName(sigma_var->gi));
+    // Cell-centred operators average sigma to faces, which requires
+    // the outer boundary and ghost zones
+    for (int level = 0; level < nlevels; ++level)
+      error_if_invalid(get_groupdata(level, sigma_var->gi), sigma_var->vi, tl,
+                       make_valid_int() | make_valid_outer() |
+                           make_valid_ghosts(),
+                       []() { return "CarpetX::SolveElliptic sigma"; });
+  }
 
-  // Create solver
+  // Variables with the same centering and boundary conditions share an
+  // operator
+  vector<bool> is_solved(nvars, false);
+  for (int n0 = 0; n0 < nvars; ++n0) {
+    if (is_solved.at(n0))
+      continue;
 
-  amrex::MLMG mlmg(mlnodelaplacian);
+    const auto &groupdata0 = get_groupdata(0, sol_vars.at(n0).gi);
+    const array<int, dim> indextype = groupdata0.indextype;
+    const bool is_vertex = indextype == array<int, dim>{0, 0, 0};
+    const bool is_cell = indextype == array<int, dim>{1, 1, 1};
+    if (!is_vertex && !is_cell)
+      CCTK_VERROR("Group %s: The multigrid solver supports only vertex- or "
+                  "cell-centred variables",
+                  CCTK_FullGroupName(groupdata0.groupindex));
+    const linop_bcs_t bcs = get_linop_bcs(patchdata, groupdata0,
+                                          sol_vars.at(n0).vi);
 
-  amrex::Vector<amrex::MultiFab *> ress(patchdata.leveldata.size());
-  amrex::Vector<amrex::MultiFab *> sols(patchdata.leveldata.size());
-  amrex::Vector<const amrex::MultiFab *> rhss(patchdata.leveldata.size());
-  for (int level = 0; level < int(patchdata.leveldata.size()); ++level) {
-    const auto &restrict leveldata = patchdata.leveldata.at(level);
-    const auto &restrict groupdata_rhs = *leveldata.groupdata.at(gi_rhs);
-    rhss.at(level) = groupdata_rhs.mfab.at(tl).get();
-    const auto &restrict groupdata_sol = *leveldata.groupdata.at(gi_sol);
-    sols.at(level) = groupdata_sol.mfab.at(tl).get();
-    if (have_res) {
-      const auto &restrict groupdata_res = *leveldata.groupdata.at(gi_res);
-      ress.at(level) = groupdata_res.mfab.at(tl).get();
+    vector<int> ns;
+    for (int n = n0; n < nvars; ++n) {
+      const auto &groupdata = get_groupdata(0, sol_vars.at(n).gi);
+      if (!is_solved.at(n) && groupdata.indextype == indextype &&
+          get_linop_bcs(patchdata, groupdata, sol_vars.at(n).vi) == bcs) {
+        ns.push_back(n);
+        is_solved.at(n) = true;
+      }
     }
-  }
 
-  mlmg.setVerbose(10);
-  mlmg.setBottomVerbose(10);
+    const auto solve_vars = [&](auto &linop) {
+      using linop_t = decay_t<decltype(linop)>;
 
-  // Solve
+      linop.setDomainBC(bcs[0], bcs[1]);
+      linop.setVerbose(10);
 
-  if (have_res) {
-    mlmg.compResidual(ress, sols, rhss);
-    *res_initial = 0;
-    for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-      *res_initial =
-          fmax(*res_initial, ress.at(level)->norminf(vi, 0, false, true));
-  } else {
-    *res_initial = NAN;
-  }
+      if constexpr (is_same_v<linop_t, amrex::MLNodeLaplacian>) {
+        for (int level = 0; level < nlevels; ++level) {
+          if (sigma_var) {
+            linop.setSigma(level, get_mfab(level, *sigma_var));
+          } else {
+            amrex::MultiFab sigma(grids.at(level), dmaps.at(level), 1, 0);
+            sigma.setVal(1.0);
+            linop.setSigma(level, sigma);
+          }
+        }
+      } else {
+        linop.setScalars(0.0, -1.0);
+        for (int level = 0; level < nlevels; ++level) {
+          array<amrex::MultiFab, dim> faces;
+          for (int d = 0; d < dim; ++d)
+            faces[d].define(
+                amrex::convert(grids.at(level),
+                               amrex::IntVect::TheDimensionVector(d)),
+                dmaps.at(level), 1, 0);
+          if (sigma_var) {
+            amrex::Vector<amrex::MultiFab *> face_ptrs;
+            for (int d = 0; d < dim; ++d)
+              face_ptrs.push_back(&faces[d]);
+            amrex::average_cellcenter_to_face(face_ptrs,
+                                              get_mfab(level, *sigma_var),
+                                              geoms.at(level));
+          } else {
+            for (int d = 0; d < dim; ++d)
+              faces[d].setVal(1.0);
+          }
+          linop.setBCoeffs(level, amrex::GetArrOfConstPtrs(faces));
+        }
+      }
+
+      // The solver can be re-used for all right hand sides
+      amrex::MLMG mlmg(linop);
+      mlmg.setVerbose(10);
+      mlmg.setBottomVerbose(10);
+
+      for (const int n : ns) {
+        const linsolve_var_t &sol_var = sol_vars.at(n);
+        const linsolve_var_t &rhs_var = rhs_vars.at(n);
+        const bool have_res = res_vns.at(n) >= 0;
+        const optional<linsolve_var_t> res_var =
+            have_res ? make_optional<linsolve_var_t>(res_vns.at(n)) : nullopt;
+        if (get_groupdata(0, rhs_var.gi).indextype != indextype ||
+            (have_res && get_groupdata(0, res_var->gi).indextype != indextype))
+          CCTK_VERROR("Group %s: The solution, right hand side, and residual "
+                      "must have the same centering",
+                      CCTK_FullGroupName(sol_var.gi));
+
+        vector<amrex::MultiFab> sol_mfabs, rhs_mfabs, res_mfabs;
+        sol_mfabs.reserve(nlevels);
+        rhs_mfabs.reserve(nlevels);
+        res_mfabs.reserve(nlevels);
+        amrex::Vector<amrex::MultiFab *> sols(nlevels), ress(nlevels);
+        amrex::Vector<const amrex::MultiFab *> rhss(nlevels);
+        for (int level = 0; level < nlevels; ++level) {
+          error_if_invalid(get_groupdata(level, rhs_var.gi), rhs_var.vi, tl,
+                           make_valid_int(),
+                           []() { return "CarpetX::SolveElliptic rhs"; });
+          if (warm_start)
+            error_if_invalid(get_groupdata(level, sol_var.gi), sol_var.vi, tl,
+                             make_valid_int(),
+                             []() { return "CarpetX::SolveElliptic sol"; });
+          sol_mfabs.push_back(get_mfab(level, sol_var));
+          sols.at(level) = &sol_mfabs.back();
+          rhs_mfabs.push_back(get_mfab(level, rhs_var));
+          rhss.at(level) = &rhs_mfabs.back();
+          if (have_res) {
+            res_mfabs.push_back(get_mfab(level, *res_var));
+            ress.at(level) = &res_mfabs.back();
+          }
+        }
+
+        if (!warm_start) {
+          // Start from zero, keeping the Dirichlet boundary values
+          for (int level = 0; level < nlevels; ++level) {
+            const auto &geom = geoms.at(level);
+            amrex::Box interior =
+                amrex::convert(geom.Domain(), sols.at(level)->ixType());
+            for (int d = 0; d < dim; ++d)
+              if (indextype[d] == 0 && !geom.isPeriodic(d))
+                interior.grow(d, -1);
+            sols.at(level)->setVal(0.0, interior, 0, 1);
+          }
+        }
+
+        // The boundary values of cell-centred solutions are taken from
+        // their outer boundary and ghost zones
+        if constexpr (is_same_v<linop_t, amrex::MLABecLaplacian>)
+          for (int level = 0; level < nlevels; ++level) {
+            error_if_invalid(get_groupdata(level, sol_var.gi), sol_var.vi, tl,
+                             make_valid_outer() | make_valid_ghosts(),
+                             []() { return "CarpetX::SolveElliptic sol"; });
+            linop.setLevelBC(level, sols.at(level));
+          }
+
+        const auto norm_inf = [&](const auto &mfabs) {
+          CCTK_REAL norm = 0;
+          for (int level = 0; level < nlevels; ++level)
+            norm = fmax(norm, mfabs.at(level)->norminf(0, 0, false, true));
+          return norm;
+        };
+
+        if (have_res)
+          mlmg.compResidual(ress, sols, rhss);
 
 #pragma omp critical
-  {
-    CCTK_VINFO("Before solving:");
-    for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-      CCTK_VINFO("norm_inf rhs[%d]: %g", level,
-                 double(rhss.at(level)->norminf(vi, 0, false, true)));
-    for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-      CCTK_VINFO("norm_inf sol[%d]: %g", level,
-                 double(sols.at(level)->norminf(vi, 0, false, true)));
-    if (have_res)
-      for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-        CCTK_VINFO("norm_inf res[%d]: %g", level,
-                   double(ress.at(level)->norminf(vi, 0, false, true)));
-  }
+        {
+          CCTK_VINFO("Before solving %s:", CCTK_VarName(sol_var.vn));
+          CCTK_VINFO("norm_inf rhs: %g", double(norm_inf(rhss)));
+          CCTK_VINFO("norm_inf sol: %g", double(norm_inf(sols)));
+          if (have_res)
+            CCTK_VINFO("norm_inf res: %g", double(norm_inf(ress)));
+        }
+        if (have_res)
+          res_initial[n] = fmax(res_initial[n], norm_inf(ress));
 
-  // const CCTK_REAL rtol = 0.0;
-  // const CCTK_REAL atol = 1.0e-12;
-  const CCTK_REAL maxerr = mlmg.solve(sols, rhss, reltol, abstol);
+        const CCTK_REAL maxerr = mlmg.solve(sols, rhss, reltol, abstol);
 #pragma omp critical
-  CCTK_VINFO("Solution error (norm_inf): %g", double(maxerr));
-
-  if (have_res) {
-    mlmg.compResidual(ress, sols, rhss);
-    *res_final = 0;
-    for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-      *res_final =
-          fmax(*res_final, ress.at(level)->norminf(vi, 0, false, true));
-  } else {
-    *res_final = NAN;
-  }
+        CCTK_VINFO("Solution error (norm_inf): %g", double(maxerr));
+
+        if (have_res)
+          mlmg.compResidual(ress, sols, rhss);
 
 #pragma omp critical
-  {
-    CCTK_VINFO("After solving:");
-    for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-      CCTK_VINFO("norm_inf rhs[%d]: %g", level,
-                 double(rhss.at(level)->norminf(vi, 0, false, true)));
-    for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-      CCTK_VINFO("norm_inf sol[%d]: %g", level,
-                 double(sols.at(level)->norminf(vi, 0, false, true)));
-    if (have_res)
-      for (int level = 0; level < int(patchdata.leveldata.size()); ++level)
-        CCTK_VINFO("norm_inf res[%d]: %g", level,
-                   double(ress.at(level)->norminf(vi, 0, false, true)));
+        {
+          CCTK_VINFO("After solving %s:", CCTK_VarName(sol_var.vn));
+          CCTK_VINFO("norm_inf sol: %g", double(norm_inf(sols)));
+          if (have_res)
+            CCTK_VINFO("norm_inf res: %g", double(norm_inf(ress)));
+        }
+        if (have_res)
+          res_final[n] = fmax(res_final[n], norm_inf(ress));
+
+        // The solver sets the interior; ghost zones need to be
+        // synchronized again
+        for (int level = 0; level < nlevels; ++level) {
+          auto &valid = get_groupdata(level, sol_var.gi)
+                            .valid.at(tl)
+                            .at(sol_var.vi);
+          valid.set_int(true, []() { return "CarpetX::SolveElliptic sol"; });
+          valid.set_ghosts(false,
+                           []() { return "CarpetX::SolveElliptic sol"; });
+          if (have_res) {
+            auto &valid = get_groupdata(level, res_var->gi)
+                              .valid.at(tl)
+                              .at(res_var->vi);
+            valid.set_int(true,
+                          []() { return "CarpetX::SolveElliptic res"; });
+            valid.set_ghosts(false,
+                             []() { return "CarpetX::SolveElliptic res"; });
+          }
+        }
+      }
+    };
+
+    if (is_vertex) {
+      amrex::MLNodeLaplacian linop(geoms, grids, dmaps);
+      solve_vars(linop);
+    } else {
+      amrex::MLABecLaplacian linop(geoms, grids, dmaps);
+      solve_vars(linop);
+    }
+  }
+}
+
+} // namespace
+
+// Solve the elliptic equations div (sigma grad sol[n]) = rhs[n] with
+// AMReX's geometric multigrid on the AMR hierarchy. `vn_sigma` is a
+// cell-centred grid function, or -1 for sigma = 1. `vns_res` may
+// contain -1 to skip calculating residuals. With `warm_start`, the
+// current solution is the initial guess.
+extern "C" void CarpetX_SolveElliptic(
+    const CCTK_INT nvars, const CCTK_INT *restrict const vns_sol,
+    const CCTK_INT *restrict const vns_rhs,
+    const CCTK_INT *restrict const vns_res, const CCTK_INT vn_sigma,
+    const CCTK_INT warm_start, const CCTK_REAL reltol, const CCTK_REAL abstol,
+    CCTK_REAL *restrict const res_initial,
+    CCTK_REAL *restrict const res_final) {
+  assert(nvars >= 0);
+  vector<linsolve_var_t> sol_vars, rhs_vars;
+  vector<int> res_vns;
+  for (int n = 0; n < nvars; ++n) {
+    sol_vars.emplace_back(vns_sol[n]);
+    rhs_vars.emplace_back(vns_rhs[n]);
+    res_vns.push_back(vns_res[n]);
+    res_initial[n] = res_final[n] = vns_res[n] >= 0 ? 0 : NAN;
   }
+
+  // Patches are solved independently; `get_linop_bcs` rejects
+  // interpatch boundaries
+  for (int patch = 0; patch < int(ghext->patchdata.size()); ++patch)
+    solve_elliptic(patch, sol_vars, rhs_vars, res_vns, vn_sigma, warm_start,
+                   reltol, abstol, res_initial, res_final);
+}
+
+extern "C" void CarpetX_SolvePoisson(const CCTK_INT gi_sol,
+                                     const CCTK_INT gi_rhs,
+                                     const CCTK_INT gi_res,
+                                     const CCTK_REAL reltol,
+                                     const CCTK_REAL abstol,
+                                     CCTK_REAL *restrict const res_initial,
+                                     CCTK_REAL *restrict const res_final) {
+  assert(gi_rhs >= 0);
+  assert(gi_sol >= 0);
+  const CCTK_INT vn_sol = CCTK_FirstVarIndexI(gi_sol);
+  const CCTK_INT vn_rhs = CCTK_FirstVarIndexI(gi_rhs);
+  const CCTK_INT vn_res = gi_res >= 0 ? CCTK_FirstVarIndexI(gi_res) : -1;
+  CarpetX_SolveElliptic(1, &vn_sol, &vn_rhs, &vn_res, -1, 1, reltol, abstol,
+                        res_initial, res_final);
 }
 
 } // namespace CarpetX
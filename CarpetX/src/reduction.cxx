@@ -1,3 +1,4 @@
+#include "derived.hxx"
 #include "driver.hxx"
 #include "mpi_types.hxx"
 #include "reduction.hxx"
@@ -243,4 +244,94 @@ reduction<CCTK_REAL, dim> reduce(int gi, int vi, int tl) {
   return red;
 }
 
+reduction<CCTK_REAL, dim> reduce_derived(const derived_quantity_t &dq) {
+  DECLARE_CCTK_PARAMETERS;
+
+  const int layout_gi = get_derived_layout_group(dq);
+  const int tl = 0;
+
+  reduction<CCTK_REAL, dim> red;
+  // TODO: Parallelize over patches and levels
+  for (auto &restrict patchdata : ghext->patchdata) {
+    for (auto &restrict leveldata : patchdata.leveldata) {
+      const auto &restrict groupdata = *leveldata.groupdata.at(layout_gi);
+      const amrex::MultiFab &mfab = *groupdata.mfab.at(tl);
+      unique_ptr<amrex::iMultiFab> finemask_imfab;
+
+      for (const int vn : dq.inputs) {
+        const int gi = CCTK_GroupIndexFromVarI(vn);
+        const int vi = vn - CCTK_FirstVarIndexI(gi);
+        warn_if_invalid(*leveldata.groupdata.at(gi), vi, tl, make_valid_int(),
+                        [&]() {
+                          return "Before reduction of derived quantity \"" +
+                                 dq.name + "\"";
+                        });
+      }
+
+      const vect<int, dim> indextype = groupdata.indextype;
+
+      const auto &restrict geom = patchdata.amrcore->Geom(leveldata.level);
+      const CCTK_REAL *restrict const x01 = geom.ProbLo();
+      const CCTK_REAL *restrict const dx1 = geom.CellSize();
+      const vect<CCTK_REAL, dim> dx = {dx1[0], dx1[1], dx1[2]};
+      const vect<CCTK_REAL, dim> x0v = {x01[0], x01[1], x01[2]};
+      const auto x0 = x0v + indextype * dx / 2;
+
+      const int fine_level = leveldata.level + 1;
+      if (fine_level < int(patchdata.leveldata.size())) {
+        const auto &restrict fine_leveldata =
+            patchdata.leveldata.at(fine_level);
+        const auto &restrict fine_groupdata =
+            *fine_leveldata.groupdata.at(layout_gi);
+        const amrex::MultiFab &fine_mfab = *fine_groupdata.mfab.at(tl);
+
+        const amrex::IntVect reffact{2, 2, 2};
+
+        finemask_imfab = make_unique<amrex::iMultiFab>(makeFineMask(
+            mfab, fine_mfab.boxArray(), reffact, geom.periodicity(),
+            /*coarse value*/ 0, /* fine value */ 1));
+      }
+
+      auto mfitinfo = amrex::MFItInfo().SetDynamic(true).EnableTiling();
+#pragma omp parallel reduction(reduction : red)
+      {
+        // Staging buffer for the derived quantity, reused for all
+        // tiles of this thread
+        amrex::FArrayBox fab;
+        for (amrex::MFIter mfi(mfab, mfitinfo); mfi.isValid(); ++mfi) {
+          const amrex::Box &bx = mfi.tilebox(); // current tile (no ghosts)
+          const vect<int, dim> tmin{bx.smallEnd(0), bx.smallEnd(1),
+                                    bx.smallEnd(2)};
+          const vect<int, dim> tmax{bx.bigEnd(0) + 1, bx.bigEnd(1) + 1,
+                                    bx.bigEnd(2) + 1};
+          const amrex::Box &vbx =
+              mfi.validbox(); // interior region (without ghosts)
+          const vect<int, dim> imin{vbx.smallEnd(0), vbx.smallEnd(1),
+                                    vbx.smallEnd(2)};
+          const vect<int, dim> imax{vbx.bigEnd(0) + 1, vbx.bigEnd(1) + 1,
+                                    vbx.bigEnd(2) + 1};
+
+          evaluate_derived_quantity(dq, patchdata.patch, leveldata.level, mfi,
+                                    bx, fab);
+          const amrex::Array4<const CCTK_REAL> &vars = fab.const_array();
+
+          unique_ptr<amrex::Array4<const int> > finemask;
+          if (finemask_imfab)
+            finemask = make_unique<amrex::Array4<const int> >(
+                finemask_imfab->array(mfi));
+
+          red += reduce_array(vars, 0, tmin, tmax, indextype, imin, imax,
+                              finemask.get(), x0, dx);
+        }
+      }
+    }
+  }
+
+  MPI_Datatype datatype = reduction_mpi_datatype<CCTK_REAL, dim>();
+  MPI_Op op = reduction_mpi_op();
+  MPI_Allreduce(MPI_IN_PLACE, &red, 1, datatype, op, MPI_COMM_WORLD);
+
+  return red;
+}
+
 } // namespace CarpetX
@@ -129,6 +129,11 @@ MPI_Op reduction_mpi_op();
 
 reduction<CCTK_REAL, dim> reduce(int gi, int vi, int tl);
 
+// Reduce a derived quantity (see derived.hxx) over the whole grid
+// hierarchy
+struct derived_quantity_t;
+reduction<CCTK_REAL, dim> reduce_derived(const derived_quantity_t &dq);
+
 } // namespace CarpetX
 
 #endif // #ifndef CARPETX_CARPETX_REDUCTION_HXX
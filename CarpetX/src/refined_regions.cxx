@@ -0,0 +1,146 @@
+#include "refined_regions.hxx"
+
+#include "regrid_policy.hxx"
+
+#include <cctk.h>
+
+#include <AMReX_BoxList.H>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace CarpetX {
+
+namespace {
+std::optional<std::vector<refined_region_t> > refined_regions;
+
+// Whether the cell-centred box `box` intersects a region. Boxes that
+// only touch the region's boundary do not intersect it.
+bool box_intersects_region(const refined_region_t &region,
+                           const amrex::Geometry &geom, const amrex::Box &box) {
+  const CCTK_REAL *restrict const x0 = geom.ProbLo();
+  const CCTK_REAL *restrict const dx = geom.CellSize();
+  // Distance of the closest point of the box from the region's
+  // centre, scaled by the region's radius
+  std::array<CCTK_REAL, 3> X;
+  for (int d = 0; d < 3; ++d) {
+    using std::clamp;
+    const CCTK_REAL xmin = x0[d] + box.smallEnd(d) * dx[d];
+    const CCTK_REAL xmax = x0[d] + (box.bigEnd(d) + 1) * dx[d];
+    const CCTK_REAL c = region.centre[d];
+    X[d] = (clamp(c, xmin, xmax) - c) / region.radius[d];
+  }
+  switch (region.shape) {
+  case region_shape_t::cube: {
+    using std::abs, std::max;
+    return max({abs(X[0]), abs(X[1]), abs(X[2])}) < 1;
+  }
+  case region_shape_t::sphere:
+    return X[0] * X[0] + X[1] * X[1] + X[2] * X[2] < 1;
+  default:
+    assert(0);
+  }
+}
+} // namespace
+
+void set_refined_regions(const std::vector<refined_region_t> &regions) {
+  for (const auto &region : regions) {
+    if (region.level <= 0)
+      CCTK_VERROR("Refined regions must describe refined levels, but a region "
+                  "for level %d was set",
+                  region.level);
+    for (int d = 0; d < 3; ++d)
+      if (!(region.radius[d] > 0))
+        CCTK_VERROR("Refined regions must have positive radii, but a region "
+                    "for level %d has the radius %g in direction %d",
+                    region.level, double(region.radius[d]), d);
+  }
+  refined_regions = regions;
+}
+
+void clear_refined_regions() { refined_regions.reset(); }
+
+bool have_refined_regions() { return bool(refined_regions); }
+
+std::vector<refined_region_t> get_refined_regions(const int patch,
+                                                  const int level) {
+  assert(refined_regions);
+  std::vector<refined_region_t> regions;
+  for (const auto &region : *refined_regions)
+    if (region.patch == patch && region.level == level)
+      regions.push_back(region);
+  return regions;
+}
+
+amrex::BoxArray make_refined_regions_boxarray(
+    const std::vector<refined_region_t> &regions, const amrex::Geometry &geom,
+    const amrex::IntVect &blocking_factor, const amrex::IntVect &max_grid_size,
+    const amrex::BoxArray &coarse_ba, const int n_proper) {
+  const amrex::Box &domain = geom.Domain();
+  const CCTK_REAL *restrict const x0 = geom.ProbLo();
+  const CCTK_REAL *restrict const dx = geom.CellSize();
+
+  const amrex::BoxArray nested =
+      get_nesting_region(domain, coarse_ba, n_proper);
+
+  // Find all blocks that intersect a region. Regions might overlap;
+  // each block is kept only once. Blocks that are not properly nested
+  // in the next coarser level are dropped.
+  std::set<std::array<int, 3> > blocks;
+  for (const auto &region : regions) {
+    int num_dropped = 0;
+    // Bounding box of the region, aligned with the blocking factor
+    amrex::IntVect lo, hi;
+    for (int d = 0; d < 3; ++d) {
+      using std::floor, std::max, std::min;
+      const int imin = int(
+          floor((region.centre[d] - region.radius[d] - x0[d]) / dx[d]));
+      const int imax = int(
+          floor((region.centre[d] + region.radius[d] - x0[d]) / dx[d]));
+      const int dlo = domain.smallEnd(d);
+      const int bf = blocking_factor[d];
+      lo[d] = dlo + (max(imin, dlo) - dlo) / bf * bf;
+      hi[d] = min(imax, domain.bigEnd(d));
+    }
+    for (int k = lo[2]; k <= hi[2]; k += blocking_factor[2])
+      for (int j = lo[1]; j <= hi[1]; j += blocking_factor[1])
+        for (int i = lo[0]; i <= hi[0]; i += blocking_factor[0]) {
+          const amrex::IntVect blo(i, j, k);
+          const amrex::Box block(blo, blo + blocking_factor - 1);
+          if (blocks.count({i, j, k}) ||
+              !box_intersects_region(region, geom, block))
+            continue;
+          if (nested.contains(block))
+            blocks.insert({i, j, k});
+          else
+            ++num_dropped;
+        }
+    if (num_dropped > 0)
+      CCTK_VWARN(CCTK_WARN_ALERT,
+                 "The refined region for patch %d level %d with centre "
+                 "[%g,%g,%g] and radius [%g,%g,%g] is not properly nested in "
+                 "the next coarser level. %d blocks of this region are not "
+                 "refined.",
+                 region.patch, region.level, double(region.centre[0]),
+                 double(region.centre[1]), double(region.centre[2]),
+                 double(region.radius[0]), double(region.radius[1]),
+                 double(region.radius[2]), num_dropped);
+  }
+
+  amrex::BoxList boxes;
+  for (const auto &blo : blocks) {
+    const amrex::IntVect lo(blo[0], blo[1], blo[2]);
+    boxes.push_back(amrex::Box(lo, lo + blocking_factor - 1));
+  }
+  boxes.simplify();
+  amrex::BoxArray ba(std::move(boxes));
+  ba.maxSize(max_grid_size);
+  return ba;
+}
+
+} // namespace CarpetX
@@ -0,0 +1,54 @@
+#ifndef CARPETX_CARPETX_REFINED_REGIONS_HXX
+#define CARPETX_CARPETX_REFINED_REGIONS_HXX
+
+#include <cctk.h>
+
+#include <AMReX_BoxArray.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_IntVect.H>
+
+#include <array>
+#include <vector>
+
+namespace CarpetX {
+
+// Refined regions can be described analytically instead of by setting
+// the regridding error on every grid point. CarpetX then constructs
+// the refined levels directly from these regions, skipping both the
+// error estimate and AMReX's clustering of tagged cells.
+
+enum class region_shape_t { cube, sphere };
+
+struct refined_region_t {
+  int patch;
+  int level; // the refined level that contains this region
+  region_shape_t shape;
+  std::array<CCTK_REAL, 3> centre;
+  std::array<CCTK_REAL, 3> radius; // in each direction
+};
+
+// Set the refined regions that are used at the next regridding. This
+// replaces all previously set regions.
+void set_refined_regions(const std::vector<refined_region_t> &regions);
+
+// Regrid via the regridding error again
+void clear_refined_regions();
+
+// Whether refined regions have been set
+bool have_refined_regions();
+
+// The refined regions of a level of a patch
+std::vector<refined_region_t> get_refined_regions(int patch, int level);
+
+// Construct the boxes of a refined level from its refined regions.
+// The boxes consist of blocks of the blocking factor that intersect a
+// region and are properly nested in the next coarser level. Blocks
+// that are not properly nested are dropped with a warning.
+amrex::BoxArray make_refined_regions_boxarray(
+    const std::vector<refined_region_t> &regions, const amrex::Geometry &geom,
+    const amrex::IntVect &blocking_factor, const amrex::IntVect &max_grid_size,
+    const amrex::BoxArray &coarse_ba, int n_proper);
+
+} // namespace CarpetX
+
+#endif // #ifndef CARPETX_CARPETX_REFINED_REGIONS_HXX
@@ -0,0 +1,91 @@
+#include "regrid_policy.hxx"
+
+#include <cctk.h>
+#include <cctk_Parameters.h>
+
+#include <AMReX_BoxList.H>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <set>
+
+namespace CarpetX {
+
+amrex::BoxArray get_nesting_region(const amrex::Box &domain,
+                                   const amrex::BoxArray &coarse_ba,
+                                   const int n_proper) {
+  amrex::BoxArray fine_coarse_ba = coarse_ba;
+  fine_coarse_ba.refine(2);
+  amrex::BoxArray outside(amrex::complementIn(domain, fine_coarse_ba));
+  outside.grow(2 * n_proper);
+  return amrex::BoxArray(amrex::complementIn(domain, outside));
+}
+
+amrex::BoxArray apply_regrid_policy(const amrex::BoxArray &new_ba,
+                                    const amrex::BoxArray &old_ba,
+                                    const amrex::BoxArray &coarse_ba,
+                                    const amrex::Box &domain,
+                                    const amrex::IntVect &blocking_factor,
+                                    const amrex::IntVect &max_grid_size,
+                                    const int n_proper) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (new_ba.empty())
+    return new_ba;
+
+  const amrex::BoxArray nested =
+      get_nesting_region(domain, coarse_ba, n_proper);
+
+  // Keep the old boxes if they cover all proposed cells, are not much
+  // larger than the proposed boxes, and are still properly nested.
+  // This also keeps the old boxes if they describe the same region
+  // as the proposed boxes, but split differently.
+  if (!old_ba.empty()) {
+    amrex::BoxArray grown_new_ba = new_ba;
+    grown_new_ba.grow(regrid_padding + regrid_hysteresis);
+    if (old_ba.contains(new_ba) && grown_new_ba.contains(old_ba) &&
+        nested.contains(old_ba))
+      return old_ba;
+  }
+
+  if (regrid_padding == 0)
+    return new_ba;
+
+  // Pad the proposed boxes. Add all blocks of the blocking factor that
+  // are within `regrid_padding` cells of a proposed box and that are
+  // properly nested. Blocks that overlap a proposed box are always
+  // kept.
+  std::set<std::array<int, 3> > blocks;
+  for (const amrex::Box &box : new_ba.boxList()) {
+    const amrex::Box grown_box = amrex::grow(box, regrid_padding) & domain;
+    amrex::IntVect lo;
+    for (int d = 0; d < 3; ++d) {
+      const int dlo = domain.smallEnd(d);
+      const int bf = blocking_factor[d];
+      lo[d] = dlo + (grown_box.smallEnd(d) - dlo) / bf * bf;
+    }
+    const amrex::IntVect &hi = grown_box.bigEnd();
+    for (int k = lo[2]; k <= hi[2]; k += blocking_factor[2])
+      for (int j = lo[1]; j <= hi[1]; j += blocking_factor[1])
+        for (int i = lo[0]; i <= hi[0]; i += blocking_factor[0]) {
+          const amrex::IntVect blo(i, j, k);
+          const amrex::Box block(blo, blo + blocking_factor - 1);
+          if (!blocks.count({i, j, k}) &&
+              (block.intersects(box) || nested.contains(block)))
+            blocks.insert({i, j, k});
+        }
+  }
+
+  amrex::BoxList boxes;
+  for (const auto &blo : blocks) {
+    const amrex::IntVect lo(blo[0], blo[1], blo[2]);
+    boxes.push_back(amrex::Box(lo, lo + blocking_factor - 1));
+  }
+  boxes.simplify();
+  amrex::BoxArray ba(std::move(boxes));
+  ba.maxSize(max_grid_size);
+  return ba;
+}
+
+} // namespace CarpetX
@@ -0,0 +1,34 @@
+#ifndef CARPETX_CARPETX_REGRID_POLICY_HXX
+#define CARPETX_CARPETX_REGRID_POLICY_HXX
+
+#include <AMReX_Box.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_IntVect.H>
+
+namespace CarpetX {
+
+// The part of a refined level's domain that is properly nested in the
+// next coarser level, i.e. that keeps a distance of `n_proper` coarse
+// cells from the coarse level's boundary
+amrex::BoxArray get_nesting_region(const amrex::Box &domain,
+                                   const amrex::BoxArray &coarse_ba,
+                                   int n_proper);
+
+// Decide which boxes a refined level should use after regridding.
+// `new_ba` are the boxes proposed by the regridding algorithm,
+// `old_ba` are the level's current boxes (empty for a new level), and
+// `coarse_ba` are the boxes that the next coarser level will use. The
+// old boxes are kept if they still cover the proposed boxes and are
+// not much larger than them (see the parameters `regrid_padding` and
+// `regrid_hysteresis`). Otherwise the proposed boxes are padded.
+amrex::BoxArray apply_regrid_policy(const amrex::BoxArray &new_ba,
+                                    const amrex::BoxArray &old_ba,
+                                    const amrex::BoxArray &coarse_ba,
+                                    const amrex::Box &domain,
+                                    const amrex::IntVect &blocking_factor,
+                                    const amrex::IntVect &max_grid_size,
+                                    int n_proper);
+
+} // namespace CarpetX
+
+#endif // #ifndef CARPETX_CARPETX_REGRID_POLICY_HXX
@@ -1,5 +1,6 @@
 #include "driver.hxx"
 #include "fillpatch.hxx"
+#include "interp.hxx"
 #include "io.hxx"
 #include "loop.hxx"
 #include "schedule.hxx"
@@ -33,6 +34,7 @@ static inline int omp_in_parallel() { return 0; }
 #include <sys/time.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <map>
@@ -81,11 +83,98 @@ double gettime() {
 // Used to pass active levels from AMReX's regridding functions
 optional<active_levels_t> active_levels;
 
+void RefluxCrseInit(const cGH *cctkGH, int level);
+void RefluxFineAdd(const cGH *cctkGH, int level);
 void Reflux(const cGH *cctkGH, int level);
 void Restrict(const cGH *cctkGH, int level, const vector<int> &groups);
 void Restrict(const cGH *cctkGH, int level);
 
 namespace {
+// Time and time step size of the coarsest level. The cGH holds these
+// as well, except while a finer subcycling level is being evolved,
+// when it holds the time and time step size of that level instead.
+CCTK_REAL coarse_time = NAN;
+CCTK_REAL coarse_delta_time = NAN;
+
+// Time at which a level is currently valid. This is only meaningful
+// during evolution.
+CCTK_REAL level_time(const GHExt::PatchData::LevelData &leveldata) {
+  const auto &leveldata0 = ghext->patchdata.at(leveldata.patch).leveldata.at(0);
+  return coarse_time +
+         CCTK_REAL(leveldata.iteration - leveldata0.iteration) *
+             coarse_delta_time;
+}
+
+// Time step size of a level. This is only meaningful during evolution.
+CCTK_REAL level_delta_time(const GHExt::PatchData::LevelData &leveldata) {
+  return CCTK_REAL(leveldata.delta_iteration) * coarse_delta_time;
+}
+
+// Area of the cell faces normal to direction `dir`
+CCTK_REAL face_area(const amrex::Geometry &geom, const int dir) {
+  const amrex::Real *const dx = geom.CellSize();
+  CCTK_REAL area = 1;
+  for (int d = 0; d < dim; ++d)
+    if (d != dir)
+      area *= dx[d];
+  return area;
+}
+
+// Determine the time step size. Without subcycling, all levels take
+// the time step of the finest level. With subcycling, this is the
+// time step of the coarsest level, and finer levels take
+// correspondingly smaller steps.
+void set_delta_time(cGH *restrict const cctkGH) {
+  DECLARE_CCTK_PARAMETERS;
+
+  CCTK_REAL mindx = 1.0 / 0.0;
+  for (const auto &patchdata : ghext->patchdata) {
+    const amrex::Geometry &geom = patchdata.amrcore->Geom(0);
+    const CCTK_REAL *restrict const dx = geom.CellSize();
+    CCTK_REAL mindx1 = 1.0 / 0.0;
+    for (int d = 0; d < dim; ++d)
+      mindx1 = fmin(mindx1, dx[d]);
+    if (!use_subcycling_wip)
+      mindx1 = ldexp(mindx1, -(int(patchdata.leveldata.size()) - 1));
+    mindx = fmin(mindx, mindx1);
+  }
+  cctkGH->cctk_delta_time = dtfac * mindx;
+#pragma omp critical
+  CCTK_VINFO("Iteration: %d   time: %g   delta_time: %g",
+             cctkGH->cctk_iteration, double(cctkGH->cctk_time),
+             double(cctkGH->cctk_delta_time));
+}
+
+// Remember the state of the evolved grid functions on a level before
+// it takes a time step
+void save_old_state(GHExt::PatchData::LevelData &leveldata) {
+  for (auto &groupdataptr : leveldata.groupdata) {
+    if (!groupdataptr)
+      continue;
+    auto &groupdata = *groupdataptr;
+    if (!groupdata.do_checkpoint || groupdata.mfab.empty())
+      continue;
+    const amrex::MultiFab &mfab = *groupdata.mfab.at(0);
+    if (!groupdata.mfab_old ||
+        groupdata.mfab_old->boxArray() != mfab.boxArray() ||
+        groupdata.mfab_old->DistributionMap() != mfab.DistributionMap())
+      groupdata.mfab_old = make_unique<amrex::MultiFab>(
+          mfab.boxArray(), mfab.DistributionMap(), mfab.nComp(), 0);
+    amrex::MultiFab::Copy(*groupdata.mfab_old, mfab, 0, 0, mfab.nComp(), 0);
+  }
+}
+
+// Any patch's data for a level. Levels with the same index are always
+// at the same iteration and use the same time step size on all
+// patches.
+const GHExt::PatchData::LevelData &get_leveldata(const int level) {
+  int patch = 0;
+  while (level >= int(ghext->patchdata.at(patch).leveldata.size()))
+    ++patch;
+  return ghext->patchdata.at(patch).leveldata.at(level);
+}
+
+
 // Convert a (direction, face) pair to an AMReX Orientation
 amrex::Orientation orient(int d, int f) {
   return amrex::Orientation(d, amrex::Orientation::Side(f));
@@ -830,21 +919,31 @@ void active_levels_t::loop_fine_to_coarse(
 void active_levels_t::loop_parallel(
     const std::function<void(int patch, int level, int index, int component,
                              const cGH *cctkGH)> &kernel) const {
+  DECLARE_CCTK_PARAMETERS;
   assert(omp_get_num_threads() == 1);
   task_manager tasks;
 
+  const int num_threads = omp_get_max_threads();
   loop_coarse_to_fine([&](const auto &restrict leveldata) {
-    int component = 0;
-    const auto mfitinfo = amrex::MFItInfo().DisableDeviceSync().EnableTiling();
-    const auto &fab0 = *leveldata.fab;
-    for (amrex::MFIter mfi(fab0, mfitinfo); mfi.isValid(); ++mfi, ++component) {
-      const int index = mfi.index();
-      tasks.submit_serially([&kernel, &leveldata, index, component]() {
+    const int num_components = leveldata.component_indices.size();
+    for (int component = 0; component < num_components; ++component) {
+      const int index = leveldata.component_indices[component];
+      const auto task = [&kernel, &leveldata, index, component]() {
         const int patch = leveldata.patch;
         const int level = leveldata.level;
         cGH *restrict const localGH = leveldata.get_local_cctkGH(component);
         kernel(patch, level, index, component, localGH);
-      });
+      };
+      if (numa_aware) {
+        // Assign consecutive tiles to the same thread. This mapping
+        // does not change until the level is regridded, so that each
+        // tile's memory stays local to the thread accessing it.
+        tasks.submit_serially(task,
+                              int(std::int64_t(component) * num_threads /
+                                  num_components));
+      } else {
+        tasks.submit_serially(task);
+      }
     }
   });
 
@@ -859,11 +958,9 @@ void active_levels_t::loop_serially(
     const std::function<void(int patch, int level, int index, int component,
                              const cGH *cctkGH)> &kernel) const {
   loop_coarse_to_fine([&](const auto &restrict leveldata) {
-    int component = 0;
-    const auto mfitinfo = amrex::MFItInfo().DisableDeviceSync().EnableTiling();
-    const auto &fab0 = *leveldata.fab;
-    for (amrex::MFIter mfi(fab0, mfitinfo); mfi.isValid(); ++mfi, ++component) {
-      const int index = mfi.index();
+    const int num_components = leveldata.component_indices.size();
+    for (int component = 0; component < num_components; ++component) {
+      const int index = leveldata.component_indices[component];
       const int patch = leveldata.patch;
       const int level = leveldata.level;
       cGH *restrict const localGH = leveldata.get_local_cctkGH(component);
@@ -1120,23 +1217,7 @@ int Initialise(tFleshConfig *config) {
       patchdata.amrcore->cactus_is_initialized = true;
 
     // Determine time step size
-    {
-      CCTK_REAL mindx = 1.0 / 0.0;
-      for (const auto &patchdata : ghext->patchdata) {
-        const amrex::Geometry &geom = patchdata.amrcore->Geom(0);
-        const CCTK_REAL *restrict const dx = geom.CellSize();
-        CCTK_REAL mindx1 = 1.0 / 0.0;
-        for (int d = 0; d < dim; ++d)
-          mindx1 = fmin(mindx1, dx[d]);
-        mindx1 = ldexp(mindx1, -(int(patchdata.leveldata.size()) - 1));
-        mindx = fmin(mindx, mindx1);
-      }
-      cctkGH->cctk_delta_time = dtfac * mindx;
-#pragma omp critical
-      CCTK_VINFO("Iteration: %d   time: %g   delta_time: %g",
-                 cctkGH->cctk_iteration, double(cctkGH->cctk_time),
-                 double(cctkGH->cctk_delta_time));
-    }
+    set_delta_time(cctkGH);
 
   } else {
     // Set up initial conditions
@@ -1153,23 +1234,7 @@ int Initialise(tFleshConfig *config) {
         patchdata.amrcore->MakeNewGrids(time);
 
       // Determine time step size
-      {
-        CCTK_REAL mindx = 1.0 / 0.0;
-        for (const auto &patchdata : ghext->patchdata) {
-          const amrex::Geometry &geom = patchdata.amrcore->Geom(0);
-          const CCTK_REAL *restrict const dx = geom.CellSize();
-          CCTK_REAL mindx1 = 1.0 / 0.0;
-          for (int d = 0; d < dim; ++d)
-            mindx1 = fmin(mindx1, dx[d]);
-          mindx1 = ldexp(mindx1, -(int(patchdata.leveldata.size()) - 1));
-          mindx = fmin(mindx, mindx1);
-        }
-        cctkGH->cctk_delta_time = dtfac * mindx;
-#pragma omp critical
-        CCTK_VINFO("Iteration: %d   time: %g   delta_time: %g",
-                   cctkGH->cctk_iteration, double(cctkGH->cctk_time),
-                   double(cctkGH->cctk_delta_time));
-      }
+      set_delta_time(cctkGH);
 
       assert(!active_levels);
       active_levels = make_optional<active_levels_t>(0, 1);
@@ -1309,23 +1374,7 @@ int Initialise(tFleshConfig *config) {
 
         if (did_modify_any_level) {
           // Determine time step size
-          {
-            CCTK_REAL mindx = 1.0 / 0.0;
-            for (const auto &patchdata : ghext->patchdata) {
-              const amrex::Geometry &geom = patchdata.amrcore->Geom(0);
-              const CCTK_REAL *restrict const dx = geom.CellSize();
-              CCTK_REAL mindx1 = 1.0 / 0.0;
-              for (int d = 0; d < dim; ++d)
-                mindx1 = fmin(mindx1, dx[d]);
-              mindx1 = ldexp(mindx1, -(int(patchdata.leveldata.size()) - 1));
-              mindx = fmin(mindx, mindx1);
-            }
-            cctkGH->cctk_delta_time = dtfac * mindx;
-#pragma omp critical
-            CCTK_VINFO("Iteration: %d   time: %g   delta_time: %g",
-                       cctkGH->cctk_iteration, double(cctkGH->cctk_time),
-                       double(cctkGH->cctk_delta_time));
-          }
+          set_delta_time(cctkGH);
 
           assert(!active_levels);
           active_levels = make_optional<active_levels_t>(
@@ -1474,8 +1523,7 @@ void CycleTimelevels(cGH *restrict const cctkGH) {
   static Timer timer("CycleTimelevels");
   Interval interval(timer);
 
-  cctkGH->cctk_iteration += 1;
-  cctkGH->cctk_time += cctkGH->cctk_delta_time;
+  // The caller has already advanced the iteration and time
   update_cctkGHs(cctkGH);
 
   // TODO: Parallelize over groups
@@ -1505,6 +1553,7 @@ void CycleTimelevels(cGH *restrict const cctkGH) {
                  groupdata.mfab.end());
           rotate(groupdata.valid.begin(), groupdata.valid.end() - 1,
                  groupdata.valid.end());
+          leveldata.update_local_cctkGHs_data(gi);
           for (int vi = 0; vi < groupdata.numvars; ++vi)
             groupdata.valid.at(0).at(vi).set_all(valid_t(), []() {
               return "CycletimeLevels (invalidate current time level)";
@@ -1678,23 +1727,7 @@ int Evolve(tFleshConfig *config) {
 
       if (did_modify_any_level) {
         // Determine time step size
-        {
-          CCTK_REAL mindx = 1.0 / 0.0;
-          for (const auto &patchdata : ghext->patchdata) {
-            const amrex::Geometry &geom = patchdata.amrcore->Geom(0);
-            const CCTK_REAL *restrict const dx = geom.CellSize();
-            CCTK_REAL mindx1 = 1.0 / 0.0;
-            for (int d = 0; d < dim; ++d)
-              mindx1 = fmin(mindx1, dx[d]);
-            mindx1 = ldexp(mindx1, -(int(patchdata.leveldata.size()) - 1));
-            mindx = fmin(mindx, mindx1);
-          }
-          cctkGH->cctk_delta_time = dtfac * mindx;
-#pragma omp critical
-          CCTK_VINFO("Iteration: %d   time: %g   delta_time: %g",
-                     cctkGH->cctk_iteration, double(cctkGH->cctk_time),
-                     double(cctkGH->cctk_delta_time));
-        }
+        set_delta_time(cctkGH);
 
         assert(!active_levels);
         active_levels = make_optional<active_levels_t>(first_modified_level,
@@ -1702,98 +1735,178 @@ int Evolve(tFleshConfig *config) {
         CCTK_Traverse(cctkGH, "CCTK_BASEGRID");
         CCTK_Traverse(cctkGH, "CCTK_POSTREGRID");
         active_levels = optional<active_levels_t>();
+      } else {
+#pragma omp critical
+        CCTK_VINFO("  grid hierarchy unchanged");
       }
     } // Regrid
 
-    // Find smallest iteration number. Levels at this iteration will
-    // be evolved.
-    rat64 iteration = ghext->patchdata.at(0).leveldata.at(0).iteration;
-    using std::min;
-    for (const auto &patchdata : ghext->patchdata)
-      for (const auto &leveldata : patchdata.leveldata)
-        iteration = min(iteration, leveldata.iteration);
-
-    // Loop over all levels, in batches that combine levels that don't
-    // subcycle. The level range is [min_level, max_level).
-    int min_level = 0;
-    while (min_level < ghext->num_levels()) {
-      // Find end of batch
-      int max_level = min_level + 1;
-
-      while (max_level < ghext->num_levels()) {
-        bool level_is_subcycling_level = false;
-        for (const auto &patchdata : ghext->patchdata)
-          if (max_level < int(patchdata.leveldata.size()))
-            level_is_subcycling_level |=
-                patchdata.leveldata.at(max_level).is_subcycling_level;
-        if (level_is_subcycling_level)
-          break;
-        ++max_level;
-      }
-
-      // Skip this batch of levels if it is not active at the current
-      // iteration
-      rat64 level_iteration = -1;
+    // Take one time step on the coarsest level, and as many time
+    // steps on the finer levels as they need to catch up with it
+    // (Berger-Oliger). Without subcycling, all levels form a single
+    // batch and take exactly one step.
+    const rat64 next_coarse_iteration =
+        get_leveldata(0).iteration + get_leveldata(0).delta_iteration;
+    for (;;) {
+      // Find smallest iteration number. Levels at this iteration will
+      // be evolved.
+      rat64 iteration = get_leveldata(0).iteration;
+      using std::min;
       for (const auto &patchdata : ghext->patchdata)
-        if (min_level < int(patchdata.leveldata.size()))
-          level_iteration = patchdata.leveldata.at(min_level).iteration;
-      assert(level_iteration != -1);
-      if (level_iteration > iteration)
+        for (const auto &leveldata : patchdata.leveldata)
+          iteration = min(iteration, leveldata.iteration);
+      if (iteration >= next_coarse_iteration)
         break;
 
-      active_levels = make_optional<active_levels_t>(min_level, max_level);
+      // Loop over all levels, in batches that combine levels that
+      // don't subcycle. The level range is [min_level, max_level).
+      // Coarser batches are evolved before finer ones so that the
+      // finer ones can interpolate their ghost zones in time.
+      for (int min_level = 0, max_level; min_level < ghext->num_levels();
+           min_level = max_level) {
+        // Find end of batch
+        max_level = min_level + 1;
+        while (max_level < ghext->num_levels()) {
+          bool level_is_subcycling_level = false;
+          for (const auto &patchdata : ghext->patchdata)
+            if (max_level < int(patchdata.leveldata.size()))
+              level_is_subcycling_level |=
+                  patchdata.leveldata.at(max_level).is_subcycling_level;
+          if (level_is_subcycling_level)
+            break;
+          ++max_level;
+        }
+
+        // Skip this batch of levels if it is not active at the
+        // current iteration
+        if (get_leveldata(min_level).iteration > iteration)
+          continue;
 
-      // Advance iteration number on this batch of levels
-      active_levels->loop_serially([&](auto &restrict leveldata) {
-        leveldata.iteration += leveldata.delta_iteration;
-      });
+        active_levels = make_optional<active_levels_t>(min_level, max_level);
 
-      // We cannot invalidate all non-evolved variables. ODESolvers
-      // calculates things in ODESolvers_Poststep, and we want to use
-      // them in the next iteration.
-      // InvalidateTimelevels(cctkGH);
+        // The next finer batch interpolates in time between the old
+        // and the new state of the finest level of this batch
+        if (max_level < ghext->num_levels())
+          for (auto &patchdata : ghext->patchdata)
+            if (max_level < int(patchdata.leveldata.size()))
+              save_old_state(patchdata.leveldata.at(max_level - 1));
 
-      CycleTimelevels(cctkGH);
+        // Advance iteration number on this batch of levels
+        active_levels->loop_serially([&](auto &restrict leveldata) {
+          leveldata.iteration += leveldata.delta_iteration;
+        });
 
-      CCTK_Traverse(cctkGH, "CCTK_PRESTEP");
-      CCTK_Traverse(cctkGH, "CCTK_EVOL");
+        // Advance the time. The cGH holds the iteration number and
+        // time of the coarsest level; finer subcycling levels see
+        // their own time and time step size while they are evolved.
+        if (min_level == 0) {
+          cctkGH->cctk_iteration += 1;
+          cctkGH->cctk_time += cctkGH->cctk_delta_time;
+          coarse_time = cctkGH->cctk_time;
+          coarse_delta_time = cctkGH->cctk_delta_time;
+        } else {
+          const auto &leveldata = get_leveldata(min_level);
+          cctkGH->cctk_time = level_time(leveldata);
+          cctkGH->cctk_delta_time =
+              coarse_delta_time * CCTK_REAL(leveldata.delta_iteration);
+        }
 
-      // Reflux
-      // TODO: These loop bounds are wrong for subcycling
-      assert(active_levels);
-      for (int level = ghext->num_levels() - 2; level >= 0; --level)
-        Reflux(cctkGH, level);
-
-      if (!restrict_during_sync) {
-        // Restrict
-        // TODO: These loop bounds are wrong for subcycling
-        for (int level = ghext->num_levels() - 2; level >= 0; --level)
-          Restrict(cctkGH, level);
-        CCTK_Traverse(cctkGH, "CCTK_POSTRESTRICT");
-      }
+        // We cannot invalidate all non-evolved variables. ODESolvers
+        // calculates things in ODESolvers_Poststep, and we want to use
+        // them in the next iteration.
+        // InvalidateTimelevels(cctkGH);
 
-      CCTK_Traverse(cctkGH, "CCTK_POSTSTEP");
-      CCTK_Traverse(cctkGH, "CCTK_CHECKPOINT");
-      CCTK_Traverse(cctkGH, "CCTK_ANALYSIS");
-      const double output_start_time = gettime();
-      CCTK_OutputGH(cctkGH);
-      const double output_finish_time = gettime();
-      total_evolution_output_time += output_finish_time - output_start_time;
+        CycleTimelevels(cctkGH);
 
-      active_levels = optional<active_levels_t>();
-    } // for min_level
+        CCTK_Traverse(cctkGH, "CCTK_PRESTEP");
+        CCTK_Traverse(cctkGH, "CCTK_EVOL");
+
+        // Reflux and restrict within this batch, where all levels are
+        // at the same time
+        assert(active_levels);
+        for (int level = max_level - 2; level >= min_level; --level) {
+          RefluxCrseInit(cctkGH, level);
+          RefluxFineAdd(cctkGH, level);
+          Reflux(cctkGH, level);
+        }
+        if (!restrict_during_sync) {
+          for (int level = max_level - 2; level >= min_level; --level)
+            Restrict(cctkGH, level);
+          CCTK_Traverse(cctkGH, "CCTK_POSTRESTRICT");
+        }
+
+        // Set up the flux register towards the next finer batch, and
+        // accumulate the fluxes of this batch towards the next coarser
+        // batch
+        if (max_level < ghext->num_levels())
+          RefluxCrseInit(cctkGH, max_level - 1);
+        if (min_level > 0)
+          RefluxFineAdd(cctkGH, min_level - 1);
+
+        // Reflux and restrict coarser levels once this batch has caught
+        // up with them. Only the next coarser level is refluxed: each
+        // coarser level was already refluxed when its own next finer
+        // level caught up with it, and its flux register is not reset
+        // until that level takes its next step.
+        int first_caught_up_level = min_level;
+        while (first_caught_up_level > 0 &&
+               get_leveldata(first_caught_up_level).iteration ==
+                   get_leveldata(first_caught_up_level - 1).iteration)
+          --first_caught_up_level;
+        if (first_caught_up_level < min_level) {
+          Reflux(cctkGH, min_level - 1);
+          if (!restrict_during_sync) {
+            for (int level = min_level - 1; level >= first_caught_up_level;
+                 --level)
+              Restrict(cctkGH, level);
+            active_levels = make_optional<active_levels_t>(
+                first_caught_up_level, min_level);
+            CCTK_Traverse(cctkGH, "CCTK_POSTRESTRICT");
+            active_levels =
+                make_optional<active_levels_t>(min_level, max_level);
+          }
+        }
+
+        CCTK_Traverse(cctkGH, "CCTK_POSTSTEP");
+
+        // Restore the time of the coarsest level
+        if (min_level > 0) {
+          cctkGH->cctk_time = coarse_time;
+          cctkGH->cctk_delta_time = coarse_delta_time;
+          update_cctkGHs(cctkGH);
+        }
+
+        active_levels = optional<active_levels_t>();
+      } // for min_level
+    }   // for iteration
+
+    // All levels are now at the same time
+    active_levels = make_optional<active_levels_t>();
+    CCTK_Traverse(cctkGH, "CCTK_CHECKPOINT");
+    CCTK_Traverse(cctkGH, "CCTK_ANALYSIS");
+    const double output_start_time = gettime();
+    CCTK_OutputGH(cctkGH);
+    const double output_finish_time = gettime();
+    total_evolution_output_time += output_finish_time - output_start_time;
+    active_levels = optional<active_levels_t>();
 
     const double finish_time = gettime();
     double num_cells = 0;
+    double num_cell_updates = 0;
     for (const auto &patch : ghext->patchdata)
-      for (const auto &level : patch.leveldata)
+      for (const auto &level : patch.leveldata) {
         num_cells += level.fab->boxArray().d_numPts();
-    total_cell_updates += num_cells;
+        // Finer subcycling levels take several steps per iteration
+        num_cell_updates += level.fab->boxArray().d_numPts() /
+                            CCTK_REAL(level.delta_iteration);
+      }
+    total_cell_updates += num_cell_updates;
     ++total_iterations;
     const double iteration_time = finish_time - start_time;
     total_evolution_time += iteration_time;
     const double iterations_per_second = 1 / iteration_time;
-    const double cell_updates_per_second = num_cells * iterations_per_second;
+    const double cell_updates_per_second =
+        num_cell_updates * iterations_per_second;
     CCTK_VINFO("Simulation time: %g   "
                "Iterations per second: %g   "
                "Simulation time per second: %g",
@@ -2071,15 +2184,27 @@ int CallFunction(void *function, cFunctionData *restrict attribute,
 
   const mode_t mode = decode_mode(attribute);
   switch (mode) {
-  case mode_t::local:
+  case mode_t::local: {
+    // Measure the cost of each component for load balancing. (On
+    // GPUs, this measures only the time to launch kernels.)
+    const bool measure_costs = CCTK_EQUALS(load_balance_cost, "measured");
     // Call function once per tile
     active_levels->loop_parallel([&](int patch, int level, int index,
                                      int component, const cGH *local_cctkGH) {
       update_cctkGH(const_cast<cGH *>(local_cctkGH), cctkGH);
+      const double t0 = measure_costs ? omp_get_wtime() : 0;
       CCTK_CallFunction(function, attribute, const_cast<cGH *>(local_cctkGH));
+      if (measure_costs) {
+        const double t1 = omp_get_wtime();
+        double &box_cost =
+            ghext->patchdata.at(patch).leveldata.at(level).box_costs.at(index);
+#pragma omp atomic
+        box_cost += t1 - t0;
+      }
     });
     synchronize();
     break;
+  }
 
   case mode_t::meta:
   case mode_t::global:
@@ -2326,7 +2451,10 @@ int SyncGroupsByDirI(const cGH *restrict cctkGH, int numgroups,
 
   if (restrict_during_sync) {
     active_levels->loop_fine_to_coarse([&](const auto &leveldata) {
-      if (leveldata.level < ghext->num_levels() - 1)
+      // With subcycling, restrict only from finer levels that have
+      // caught up with this level
+      if (leveldata.level < ghext->num_levels() - 1 &&
+          get_leveldata(leveldata.level + 1).iteration == leveldata.iteration)
         Restrict(cctkGH, leveldata.level, groups);
     });
     // FIXME: cannot call POSTRESTRICT since this could contain a SYNC leading
@@ -2412,6 +2540,10 @@ int SyncGroupsByDirI(const cGH *restrict cctkGH, int numgroups,
   task_manager tasks2;
   task_manager tasks3;
 
+  // Coarse level data interpolated in time. These need to live until
+  // all tasks have finished.
+  vector<unique_ptr<amrex::MultiFab> > time_interpolated_mfabs;
+
   for (const int gi : groups) {
     active_levels->loop_serially([&](auto &restrict leveldata) {
       auto &restrict groupdata = *leveldata.groupdata.at(gi);
@@ -2449,11 +2581,39 @@ int SyncGroupsByDirI(const cGH *restrict cctkGH, int numgroups,
 
         for (int tl = 0; tl < sync_tl; ++tl) {
 
+          const amrex::MultiFab *cmfab = coarsegroupdata.mfab.at(tl).get();
+
+          // With subcycling, the coarse level might already be ahead
+          // in time. Interpolate linearly in time between its old and
+          // its current state. Only evolved groups keep an old state;
+          // all others use the current coarse data.
+          if (tl == 0 && leveldata.iteration != coarseleveldata.iteration &&
+              coarsegroupdata.mfab_old) {
+            assert(leveldata.iteration < coarseleveldata.iteration);
+            const CCTK_REAL time1 = level_time(coarseleveldata);
+            const CCTK_REAL time0 =
+                time1 - CCTK_REAL(coarseleveldata.delta_iteration) *
+                            coarse_delta_time;
+            // Use the time of the cGH, which takes substeps of time
+            // integrators into account
+            const CCTK_REAL alpha =
+                (cctkGH->cctk_time - time0) / (time1 - time0);
+            auto mfab_interp = make_unique<amrex::MultiFab>(
+                cmfab->boxArray(), cmfab->DistributionMap(), cmfab->nComp(),
+                0);
+            amrex::MultiFab::LinComb(*mfab_interp, 1 - alpha,
+                                     *coarsegroupdata.mfab_old, 0, alpha,
+                                     *cmfab, 0, 0, cmfab->nComp(), 0);
+            cmfab = mfab_interp.get();
+            time_interpolated_mfabs.push_back(std::move(mfab_interp));
+          }
+
           tasks1.submit_serially([&tasks2, &tasks3, &leveldata, &groupdata,
-                                  &coarsegroupdata, interpolator, tl]() {
+                                  &coarsegroupdata, cmfab, interpolator,
+                                  tl]() {
             FillPatch_ProlongateGhosts(tasks2, tasks3, groupdata,
                                        coarsegroupdata, *groupdata.mfab.at(tl),
-                                       *coarsegroupdata.mfab.at(tl),
+                                       *cmfab,
                                        ghext->patchdata.at(leveldata.patch)
                                            .amrcore->Geom(leveldata.level),
                                        ghext->patchdata.at(leveldata.patch)
@@ -2526,7 +2686,10 @@ int SyncGroupsByDirI(const cGH *restrict cctkGH, int numgroups,
       for (int var = 0; var < groupdata.numvars; ++var)
         cactusvarinds.push_back(groupdata.firstvarindex + var);
     }
+    assert(!interpolating_patch_boundaries);
+    interpolating_patch_boundaries = true;
     MultiPatch_Interpolate(cctkGH, cactusvarinds.size(), cactusvarinds.data());
+    interpolating_patch_boundaries = false;
 
     for (const int gi : groups) {
       const auto &patchdata0 = ghext->patchdata.at(0);
@@ -2560,21 +2723,21 @@ int SyncGroupsByDirI(const cGH *restrict cctkGH, int numgroups,
   return numgroups; // number of groups synchronized
 }
 
-void Reflux(const cGH *cctkGH, int level) {
-  DECLARE_CCTK_PARAMETERS;
-
-  if (!do_reflux)
-    return;
-
-  static Timer timer("Reflux");
-  Interval interval(timer);
-
+namespace {
+// Loop over all grid function groups that have a flux register between
+// a level and the next finer level
+void loop_flux_registers(
+    const int level,
+    const std::function<void(
+        const GHExt::PatchData &patchdata, int gi,
+        GHExt::PatchData::LevelData::GroupData &groupdata,
+        const GHExt::PatchData::LevelData::GroupData &finegroupdata)>
+        &kernel) {
   for (const auto &patchdata : ghext->patchdata) {
     if (level + 1 < int(patchdata.leveldata.size())) {
-      auto &leveldata = patchdata.leveldata.at(level);
+      const auto &leveldata = patchdata.leveldata.at(level);
       const auto &fineleveldata = patchdata.leveldata.at(level + 1);
       for (int gi = 0; gi < int(leveldata.groupdata.size()); ++gi) {
-        const int tl = 0;
         cGroup group;
         int ierr = CCTK_GroupData(gi, &group);
         assert(!ierr);
@@ -2584,66 +2747,138 @@ void Reflux(const cGH *cctkGH, int level) {
 
         auto &groupdata = *leveldata.groupdata.at(gi);
         const auto &finegroupdata = *fineleveldata.groupdata.at(gi);
-        const nan_handling_t nan_handling = groupdata.do_checkpoint
-                                                ? nan_handling_t::forbid_nans
-                                                : nan_handling_t::allow_nans;
 
         // If the group has associated fluxes
-        if (finegroupdata.freg) {
-
-          // Check coarse and fine data and fluxes are valid
-          for (int vi = 0; vi < finegroupdata.numvars; ++vi) {
-            error_if_invalid(finegroupdata, vi, tl, make_valid_int(), []() {
-              return "Reflux before refluxing: Fine level data";
-            });
-            error_if_invalid(groupdata, vi, tl, make_valid_int(), []() {
-              return "Reflux before refluxing: Coarse level data";
-            });
-          }
-          for (int d = 0; d < dim; ++d) {
-            const int flux_gi = finegroupdata.fluxes.at(d);
-            const auto &flux_finegroupdata =
-                *fineleveldata.groupdata.at(flux_gi);
-            const auto &flux_groupdata = *leveldata.groupdata.at(flux_gi);
-            for (int vi = 0; vi < finegroupdata.numvars; ++vi) {
-              error_if_invalid(
-                  flux_finegroupdata, vi, tl, make_valid_int(), [&]() {
-                    ostringstream buf;
-                    buf << "Reflux: Fine level flux in direction " << d;
-                    return buf.str();
-                  });
-              error_if_invalid(flux_groupdata, vi, tl, make_valid_int(), [&]() {
-                ostringstream buf;
-                buf << "Reflux: Coarse level flux in direction " << d;
-                return buf.str();
-              });
-            }
-          }
-
-          for (int d = 0; d < dim; ++d) {
-            const int flux_gi = finegroupdata.fluxes.at(d);
-            const auto &flux_finegroupdata =
-                *fineleveldata.groupdata.at(flux_gi);
-            const auto &flux_groupdata = *leveldata.groupdata.at(flux_gi);
-            finegroupdata.freg->CrseInit(*flux_groupdata.mfab.at(tl), d, 0, 0,
-                                         flux_groupdata.numvars, -1);
-            finegroupdata.freg->FineAdd(*flux_finegroupdata.mfab.at(tl), d, 0,
-                                        0, flux_finegroupdata.numvars, 1);
-          }
-          const amrex::Geometry &geom = patchdata.amrcore->Geom(level);
-          finegroupdata.freg->Reflux(*groupdata.mfab.at(tl), 1.0, 0, 0,
-                                     groupdata.numvars, geom);
-
-          const active_levels_t active_levels(level, level + 1);
-          for (int vi = 0; vi < finegroupdata.numvars; ++vi)
-            check_valid_gf(active_levels, gi, vi, tl, nan_handling, []() {
-              return "Reflux after refluxing: Fine level data";
-            });
-        }
+        if (finegroupdata.freg)
+          kernel(patchdata, gi, groupdata, finegroupdata);
       } // for gi
     } // if level exists
   } // for patchdata
 }
+} // namespace
+
+// Initialize the flux registers between a level and the next finer
+// level with the coarse fluxes. This needs to happen after the coarse
+// level has taken a time step, and before the fine level has.
+//
+// The flux grid functions hold flux densities, i.e. the amount
+// transported per face area and per time (see e.g. FluxWaveToyX).
+// AMReX's FluxRegister expects the amount transported through a face
+// during a time step, so the fluxes are scaled by the face area and
+// the level's time step size when they are added to the registers.
+void RefluxCrseInit(const cGH *cctkGH, int level) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (!do_reflux)
+    return;
+
+  static Timer timer("RefluxCrseInit");
+  Interval interval(timer);
+
+  loop_flux_registers(level, [&](const auto &patchdata, const int gi,
+                                 auto &groupdata, const auto &finegroupdata) {
+    const int tl = 0;
+    const auto &leveldata = patchdata.leveldata.at(level);
+    const amrex::Geometry &geom = patchdata.amrcore->Geom(level);
+    const CCTK_REAL dt = level_delta_time(leveldata);
+    for (int d = 0; d < dim; ++d) {
+      const int flux_gi = finegroupdata.fluxes.at(d);
+      const auto &flux_groupdata = *leveldata.groupdata.at(flux_gi);
+      for (int vi = 0; vi < finegroupdata.numvars; ++vi)
+        error_if_invalid(flux_groupdata, vi, tl, make_valid_int(), [&]() {
+          ostringstream buf;
+          buf << "Reflux: Coarse level flux in direction " << d;
+          return buf.str();
+        });
+      finegroupdata.freg->CrseInit(*flux_groupdata.mfab.at(tl), d, 0, 0,
+                                   flux_groupdata.numvars,
+                                   -dt * face_area(geom, d));
+    }
+  });
+}
+
+// Add the fine fluxes of a level's next finer level to the flux
+// registers. With subcycling, this happens after each fine time step.
+// Each substep's fluxes are scaled by the fine face area and the fine
+// time step size (see RefluxCrseInit).
+void RefluxFineAdd(const cGH *cctkGH, int level) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (!do_reflux)
+    return;
+
+  static Timer timer("RefluxFineAdd");
+  Interval interval(timer);
+
+  loop_flux_registers(level, [&](const auto &patchdata, const int gi,
+                                 auto &groupdata, const auto &finegroupdata) {
+    const int tl = 0;
+    const auto &fineleveldata = patchdata.leveldata.at(level + 1);
+    const amrex::Geometry &finegeom = patchdata.amrcore->Geom(level + 1);
+    const CCTK_REAL finedt = level_delta_time(fineleveldata);
+    for (int d = 0; d < dim; ++d) {
+      const int flux_gi = finegroupdata.fluxes.at(d);
+      const auto &flux_finegroupdata = *fineleveldata.groupdata.at(flux_gi);
+      for (int vi = 0; vi < finegroupdata.numvars; ++vi)
+        error_if_invalid(flux_finegroupdata, vi, tl, make_valid_int(), [&]() {
+          ostringstream buf;
+          buf << "Reflux: Fine level flux in direction " << d;
+          return buf.str();
+        });
+      finegroupdata.freg->FineAdd(*flux_finegroupdata.mfab.at(tl), d, 0, 0,
+                                  flux_finegroupdata.numvars,
+                                  finedt * face_area(finegeom, d));
+    }
+  });
+}
+
+// Correct the coarse level data with the flux registers. This needs
+// to happen once the next finer level has caught up with the coarse
+// level.
+void Reflux(const cGH *cctkGH, int level) {
+  DECLARE_CCTK_PARAMETERS;
+
+  if (!do_reflux)
+    return;
+
+  static Timer timer("Reflux");
+  Interval interval(timer);
+
+  loop_flux_registers(level, [&](const auto &patchdata, const int gi,
+                                 auto &groupdata, const auto &finegroupdata) {
+    const int tl = 0;
+    const nan_handling_t nan_handling = groupdata.do_checkpoint
+                                            ? nan_handling_t::forbid_nans
+                                            : nan_handling_t::allow_nans;
+
+    // Check coarse and fine data are valid
+    for (int vi = 0; vi < finegroupdata.numvars; ++vi) {
+      error_if_invalid(finegroupdata, vi, tl, make_valid_int(), []() {
+        return "Reflux before refluxing: Fine level data";
+      });
+      error_if_invalid(groupdata, vi, tl, make_valid_int(), []() {
+        return "Reflux before refluxing: Coarse level data";
+      });
+    }
+
+    const amrex::Geometry &geom = patchdata.amrcore->Geom(level);
+    finegroupdata.freg->Reflux(*groupdata.mfab.at(tl), 1.0, 0, 0,
+                               groupdata.numvars, geom);
+
+    // The ghost zones and outer boundaries now need to be
+    // synchronized again, e.g. in POSTRESTRICT
+    const active_levels_t active_levels(level, level + 1);
+    for (int vi = 0; vi < finegroupdata.numvars; ++vi) {
+      groupdata.valid.at(tl).at(vi).set_invalid(
+          make_valid_outer() | make_valid_ghosts(),
+          []() { return "Reflux"; });
+      poison_invalid_gf(active_levels, gi, vi, tl);
+      check_valid_gf(active_levels, gi, vi, tl, nan_handling, []() {
+        return "Reflux after refluxing: Fine level data";
+      });
+    }
+  });
+}
 
 void Restrict(const cGH *cctkGH, int level, const vector<int> &groups) {
   DECLARE_CCTK_PARAMETERS;
@@ -1,5 +1,7 @@
 #include "task_manager.hxx"
 
+#include <omp.h>
+
 #include <cassert>
 
 namespace CarpetX {
@@ -10,27 +12,58 @@ task_manager::~task_manager() { assert(tasks.empty()); }
 
 void task_manager::submit_serially(task_t task) {
   tasks.push_back(std::move(task));
+  task_threads.push_back(-1);
+}
+
+void task_manager::submit_serially(task_t task, const int thread) {
+  assert(thread >= 0);
+  tasks.push_back(std::move(task));
+  task_threads.push_back(thread);
+  have_task_threads = true;
 }
 
 void task_manager::submit(task_t task) {
 #pragma omp critical(CarpetX_task_manager_submit)
-  tasks.push_back(std::move(task));
+  {
+    tasks.push_back(std::move(task));
+    task_threads.push_back(-1);
+  }
 }
 
 void task_manager::run_tasks_serially() {
   for (const auto &task : tasks)
     task();
   tasks.clear();
+  task_threads.clear();
+  have_task_threads = false;
 }
 
 void task_manager::run_tasks() {
   const std::size_t ntasks = tasks.size();
   if (ntasks == 0)
     return;
+  if (!have_task_threads) {
 #pragma omp parallel for schedule(dynamic)
-  for (std::size_t n = 0; n < ntasks; ++n)
-    tasks[n]();
+    for (std::size_t n = 0; n < ntasks; ++n)
+      tasks[n]();
+  } else {
+    // Each thread runs the tasks that were submitted to it. Tasks
+    // without a thread are distributed round-robin.
+#pragma omp parallel
+    {
+      const int num_threads = omp_get_num_threads();
+      const int thread_num = omp_get_thread_num();
+      for (std::size_t n = 0; n < ntasks; ++n) {
+        const int thread =
+            task_threads[n] >= 0 ? task_threads[n] : int(n % num_threads);
+        if (thread % num_threads == thread_num)
+          tasks[n]();
+      }
+    }
+  }
   tasks.clear();
+  task_threads.clear();
+  have_task_threads = false;
 }
 
 } // namespace CarpetX
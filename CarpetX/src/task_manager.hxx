@@ -11,12 +11,17 @@ using task_t = std::function<void()>;
 
 class task_manager {
   std::vector<task_t> tasks;
+  // The thread that runs each task, or -1 for any thread
+  std::vector<int> task_threads;
+  bool have_task_threads = false;
 
 public:
   task_manager();
   ~task_manager();
   void submit(task_t task);
   void submit_serially(task_t task);
+  // Run the task on a particular OpenMP thread
+  void submit_serially(task_t task, int thread);
   void run_tasks();
   void run_tasks_serially();
 };
@@ -8,6 +8,7 @@
 #include <cctk_Parameters.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <functional>
@@ -53,6 +54,11 @@ YAML::Emitter &operator<<(YAML::Emitter &yaml, const valid_t v) {
   return yaml;
 }
 
+std::uint64_t next_valid_stamp() {
+  static std::atomic<std::uint64_t> stamp{0};
+  return ++stamp;
+}
+
 std::string why_valid_t::explanation() const {
   const auto valstr = [](bool v) { return v ? "valid" : "invalid"; };
   std::ostringstream buf;
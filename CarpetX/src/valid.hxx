@@ -8,6 +8,7 @@
 #include <yaml-cpp/yaml.h>
 #include <zlib.h>
 
+#include <cstdint>
 #include <functional>
 #include <iomanip>
 #include <iostream>
@@ -105,9 +106,15 @@ template <> struct less<valid_t> {
 } // namespace std
 namespace CarpetX {
 
+// Return a new, globally increasing modification stamp
+std::uint64_t next_valid_stamp();
+
 class why_valid_t {
   valid_t valid;
   std::function<std::string()> why_int, why_outer, why_ghosts;
+  // Modification stamp. This changes every time the validity is set,
+  // i.e. every time the data may have been modified.
+  std::uint64_t stamp;
 
 public:
   // The constructor that doesn't give a reason should never be called
@@ -117,12 +124,15 @@ public:
   why_valid_t(bool b, const std::function<std::string()> &why)
       : why_valid_t(valid_t(b), why) {}
   why_valid_t(const valid_t &val, const std::function<std::string()> &why)
-      : valid(val), why_int(why), why_outer(why), why_ghosts(why) {}
+      : valid(val), why_int(why), why_outer(why), why_ghosts(why),
+        stamp(next_valid_stamp()) {}
 
   const valid_t &get() const { return valid; }
+  std::uint64_t get_stamp() const { return stamp; }
 
   void set(const valid_t &which, const valid_t &val,
            const std::function<std::string()> &why) {
+    stamp = next_valid_stamp();
     valid = (valid & ~which) | (val & which);
     if (which.valid_int)
       why_int = why;
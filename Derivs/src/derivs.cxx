@@ -1,5 +1,12 @@
 #include "derivs.hxx"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace Derivs {
 using namespace Arith;
 using namespace Loop;
@@ -27,12 +34,34 @@ calc_copy(const GF3D5<T> &gf, const GF3D5layout layout,
       });
 }
 
-template <int CI, int CJ, int CK, typename T>
-CCTK_ATTRIBUTE_NOINLINE void
-calc_derivs(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
-            const GF3D5layout layout, const GridDescBaseDevice &grid,
-            const GF3D2<const T> &gf0, const vect<T, dim> dx,
-            const int deriv_order) {
+// Pointwise derivatives, either with run-time strides (if `NI` and `NJ`
+// are zero) or for the fixed allocated shape `NI` x `NJ`
+template <int deriv_order, int NI, int NJ, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_DEVICE CCTK_HOST vec<simd<T>, dim>
+pointwise_deriv(const GF3D2<const T> &gf, const simdl<T> &mask,
+                const vect<int, dim> &I, const vect<T, dim> &dx) {
+  if constexpr (NI == 0 && NJ == 0)
+    return calc_deriv<deriv_order>(gf, mask, I, dx);
+  else
+    return calc_deriv_fixed<deriv_order, NI, NJ>(gf, mask, I, dx);
+}
+
+template <int deriv_order, int NI, int NJ, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_DEVICE CCTK_HOST smat<simd<T>, dim>
+pointwise_deriv2(const GF3D2<const T> &gf, const simdl<T> &mask,
+                 const vect<int, dim> &I, const vect<T, dim> &dx) {
+  if constexpr (NI == 0 && NJ == 0)
+    return calc_deriv2<deriv_order>(gf, mask, I, dx);
+  else
+    return calc_deriv2_fixed<deriv_order, NI, NJ>(gf, mask, I, dx);
+}
+
+template <int CI, int CJ, int CK, int NI, int NJ, typename T>
+CCTK_ATTRIBUTE_ALWAYS_INLINE void
+calc_derivs_impl(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+                 const GF3D5layout layout, const GridDescBaseDevice &grid,
+                 const GF3D2<const T> &gf0, const vect<T, dim> dx,
+                 const int deriv_order) {
   using vreal = simd<T>;
   using vbool = simdl<T>;
   constexpr std::size_t vsize = std::tuple_size_v<vreal>;
@@ -49,7 +78,7 @@ calc_derivs(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
               mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
           const GF3D5index index(layout, p.I);
           const auto val = gf0(mask, p.I);
-          const auto dval = calc_deriv<2>(gf0, mask1, p.I, dx);
+          const auto dval = pointwise_deriv<2, NI, NJ>(gf0, mask1, p.I, dx);
           gf.store(mask, index, val);
           dgf.store(mask, index, dval);
         });
@@ -65,7 +94,7 @@ calc_derivs(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
               mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
           const GF3D5index index(layout, p.I);
           const auto val = gf0(mask, p.I);
-          const auto dval = calc_deriv<4>(gf0, mask1, p.I, dx);
+          const auto dval = pointwise_deriv<4, NI, NJ>(gf0, mask1, p.I, dx);
           gf.store(mask, index, val);
           dgf.store(mask, index, dval);
         });
@@ -81,7 +110,7 @@ calc_derivs(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
               mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
           const GF3D5index index(layout, p.I);
           const auto val = gf0(mask, p.I);
-          const auto dval = calc_deriv<6>(gf0, mask1, p.I, dx);
+          const auto dval = pointwise_deriv<6, NI, NJ>(gf0, mask1, p.I, dx);
           gf.store(mask, index, val);
           dgf.store(mask, index, dval);
         });
@@ -92,12 +121,12 @@ calc_derivs(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
   }
 }
 
-template <int CI, int CJ, int CK, typename T>
-CCTK_ATTRIBUTE_NOINLINE void
-calc_derivs2(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
-             const smat<GF3D5<T>, dim> &ddgf, const GF3D5layout layout,
-             const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
-             const vect<T, dim> dx, const int deriv_order) {
+template <int CI, int CJ, int CK, int NI, int NJ, typename T>
+CCTK_ATTRIBUTE_ALWAYS_INLINE void
+calc_derivs2_impl(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+                  const smat<GF3D5<T>, dim> &ddgf, const GF3D5layout layout,
+                  const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+                  const vect<T, dim> dx, const int deriv_order) {
   using vreal = simd<T>;
   using vbool = simdl<T>;
   constexpr std::size_t vsize = std::tuple_size_v<vreal>;
@@ -114,8 +143,8 @@ calc_derivs2(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
               mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
           const GF3D5index index(layout, p.I);
           const auto val = gf0(mask, p.I);
-          const auto dval = calc_deriv<2>(gf0, mask1, p.I, dx);
-          const auto ddval = calc_deriv2<2>(gf0, mask1, p.I, dx);
+          const auto dval = pointwise_deriv<2, NI, NJ>(gf0, mask1, p.I, dx);
+          const auto ddval = pointwise_deriv2<2, NI, NJ>(gf0, mask1, p.I, dx);
           gf.store(mask, index, val);
           dgf.store(mask, index, dval);
           ddgf.store(mask, index, ddval);
@@ -132,8 +161,8 @@ calc_derivs2(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
               mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
           const GF3D5index index(layout, p.I);
           const auto val = gf0(mask, p.I);
-          const auto dval = calc_deriv<4>(gf0, mask1, p.I, dx);
-          const auto ddval = calc_deriv2<4>(gf0, mask1, p.I, dx);
+          const auto dval = pointwise_deriv<4, NI, NJ>(gf0, mask1, p.I, dx);
+          const auto ddval = pointwise_deriv2<4, NI, NJ>(gf0, mask1, p.I, dx);
           gf.store(mask, index, val);
           dgf.store(mask, index, dval);
           ddgf.store(mask, index, ddval);
@@ -150,8 +179,8 @@ calc_derivs2(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
               mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
           const GF3D5index index(layout, p.I);
           const auto val = gf0(mask, p.I);
-          const auto dval = calc_deriv<6>(gf0, mask1, p.I, dx);
-          const auto ddval = calc_deriv2<6>(gf0, mask1, p.I, dx);
+          const auto dval = pointwise_deriv<6, NI, NJ>(gf0, mask1, p.I, dx);
+          const auto ddval = pointwise_deriv2<6, NI, NJ>(gf0, mask1, p.I, dx);
           gf.store(mask, index, val);
           dgf.store(mask, index, dval);
           ddgf.store(mask, index, ddval);
@@ -163,6 +192,387 @@ calc_derivs2(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
   }
 }
 
+template <int CI, int CJ, int CK, int NI, int NJ, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs_fixed(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+                  const GF3D5layout layout, const GridDescBaseDevice &grid,
+                  const GF3D2<const T> &gf0, const vect<T, dim> dx,
+                  const int deriv_order) {
+  static_assert(NI > 0 && NJ > 0);
+  assert(gf0.delta(0, 1, 0) == NI && gf0.delta(0, 0, 1) == NI * NJ);
+  calc_derivs_impl<CI, CJ, CK, NI, NJ>(gf, dgf, layout, grid, gf0, dx,
+                                       deriv_order);
+}
+
+template <int CI, int CJ, int CK, int NI, int NJ, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs2_fixed(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+                   const smat<GF3D5<T>, dim> &ddgf, const GF3D5layout layout,
+                   const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+                   const vect<T, dim> dx, const int deriv_order) {
+  static_assert(NI > 0 && NJ > 0);
+  assert(gf0.delta(0, 1, 0) == NI && gf0.delta(0, 0, 1) == NI * NJ);
+  calc_derivs2_impl<CI, CJ, CK, NI, NJ>(gf, dgf, ddgf, layout, grid, gf0, dx,
+                                        deriv_order);
+}
+
+// Allocated extents in the x and y directions for which we instantiate
+// derivative kernels with fixed strides. These are vertex centred
+// components with 16 or 32 cells (the default maximum grid size) and 2,
+// 3, or 4 ghost zones. Other shapes use run-time strides. Keep this list
+// in sync with the explicit instantiations below.
+using fixed_shapes = std::integer_sequence<int, 21, 23, 25, 37, 39, 41>;
+
+template <int CI, int CJ, int CK, typename T, int... NS>
+bool calc_derivs_dispatch(std::integer_sequence<int, NS...>,
+                          const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+                          const GF3D5layout layout,
+                          const GridDescBaseDevice &grid,
+                          const GF3D2<const T> &gf0, const vect<T, dim> dx,
+                          const int deriv_order) {
+  const int dj = gf0.delta(0, 1, 0);
+  const int dk = gf0.delta(0, 0, 1);
+  return ((dj == NS && dk == NS * NS &&
+           (calc_derivs_fixed<CI, CJ, CK, NS, NS>(gf, dgf, layout, grid, gf0,
+                                                  dx, deriv_order),
+            true)) ||
+          ...);
+}
+
+template <int CI, int CJ, int CK, typename T, int... NS>
+bool calc_derivs2_dispatch(std::integer_sequence<int, NS...>,
+                           const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+                           const smat<GF3D5<T>, dim> &ddgf,
+                           const GF3D5layout layout,
+                           const GridDescBaseDevice &grid,
+                           const GF3D2<const T> &gf0, const vect<T, dim> dx,
+                           const int deriv_order) {
+  const int dj = gf0.delta(0, 1, 0);
+  const int dk = gf0.delta(0, 0, 1);
+  return ((dj == NS && dk == NS * NS &&
+           (calc_derivs2_fixed<CI, CJ, CK, NS, NS>(gf, dgf, ddgf, layout,
+                                                   grid, gf0, dx, deriv_order),
+            true)) ||
+          ...);
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+            const GF3D5layout layout, const GridDescBaseDevice &grid,
+            const GF3D2<const T> &gf0, const vect<T, dim> dx,
+            const int deriv_order) {
+  if (calc_derivs_dispatch<CI, CJ, CK>(fixed_shapes(), gf, dgf, layout, grid,
+                                       gf0, dx, deriv_order))
+    return;
+  calc_derivs_impl<CI, CJ, CK, 0, 0>(gf, dgf, layout, grid, gf0, dx,
+                                     deriv_order);
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs2(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+             const smat<GF3D5<T>, dim> &ddgf, const GF3D5layout layout,
+             const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+             const vect<T, dim> dx, const int deriv_order) {
+  if (calc_derivs2_dispatch<CI, CJ, CK>(fixed_shapes(), gf, dgf, ddgf, layout,
+                                        grid, gf0, dx, deriv_order))
+    return;
+  calc_derivs2_impl<CI, CJ, CK, 0, 0>(gf, dgf, ddgf, layout, grid, gf0, dx,
+                                      deriv_order);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Upwinding and dissipation
+
+template <int CI, int CJ, int CK, int deriv_order, typename T>
+void calc_upwind_advection_impl(const GF3D5<T> &adv, const GF3D5layout layout,
+                                const GridDescBaseDevice &grid,
+                                const GF3D2<const T> &gf0,
+                                const vec<GF3D5<T>, dim> &beta,
+                                const vect<T, dim> dx) {
+  using vreal = simd<T>;
+  using vbool = simdl<T>;
+  constexpr std::size_t vsize = std::tuple_size_v<vreal>;
+
+  grid.loop_int_device<CI, CJ, CK, vsize>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+        // Take account of ghost points
+        const vbool mask1 =
+            mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2 + 1);
+        const GF3D5index index(layout, p.I);
+        const vec<vreal, dim> vel = beta(mask, index);
+        const vreal aval =
+            calc_deriv_upwind<deriv_order>(gf0, mask1, p.I, vel, dx);
+        adv.store(mask, index, aval);
+      });
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_upwind_advection(const GF3D5<T> &adv, const GF3D5layout layout,
+                      const GridDescBaseDevice &grid,
+                      const GF3D2<const T> &gf0,
+                      const vec<GF3D5<T>, dim> &beta, const vect<T, dim> dx,
+                      const int deriv_order) {
+  switch (deriv_order) {
+  case 2:
+    calc_upwind_advection_impl<CI, CJ, CK, 2>(adv, layout, grid, gf0, beta,
+                                              dx);
+    break;
+  case 4:
+    calc_upwind_advection_impl<CI, CJ, CK, 4>(adv, layout, grid, gf0, beta,
+                                              dx);
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", deriv_order);
+  }
+}
+
+template <int CI, int CJ, int CK, int deriv_order, typename T>
+void calc_dissipation_impl(const GF3D5<T> &diss, const GF3D5layout layout,
+                           const GridDescBaseDevice &grid,
+                           const GF3D2<const T> &gf0, const vect<T, dim> dx,
+                           const T eps) {
+  using vreal = simd<T>;
+  using vbool = simdl<T>;
+  constexpr std::size_t vsize = std::tuple_size_v<vreal>;
+
+  grid.loop_int_device<CI, CJ, CK, vsize>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+        // Take account of ghost points
+        const vbool mask1 =
+            mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2 + 1);
+        const GF3D5index index(layout, p.I);
+        const vreal dval = eps * calc_diss<deriv_order>(gf0, mask1, p.I, dx);
+        diss.store(mask, index, dval);
+      });
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_dissipation(const GF3D5<T> &diss, const GF3D5layout layout,
+                 const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+                 const vect<T, dim> dx, const T eps, const int deriv_order) {
+  switch (deriv_order) {
+  case 2:
+    calc_dissipation_impl<CI, CJ, CK, 2>(diss, layout, grid, gf0, dx, eps);
+    break;
+  case 4:
+    calc_dissipation_impl<CI, CJ, CK, 4>(diss, layout, grid, gf0, dx, eps);
+    break;
+  case 6:
+    calc_dissipation_impl<CI, CJ, CK, 6>(diss, layout, grid, gf0, dx, eps);
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", deriv_order);
+  }
+}
+
+template <int CI, int CJ, int CK, int deriv_order, typename T>
+void calc_derivs2_advection_dissipation_impl(
+    const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+    const smat<GF3D5<T>, dim> &ddgf, const GF3D5<T> &adv,
+    const GF3D5<T> &diss, const GF3D5layout layout,
+    const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+    const vec<GF3D5<T>, dim> &beta, const vect<T, dim> dx, const T eps) {
+  using vreal = simd<T>;
+  using vbool = simdl<T>;
+  constexpr std::size_t vsize = std::tuple_size_v<vreal>;
+
+  grid.loop_int_device<CI, CJ, CK, vsize>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+        // Take account of ghost points
+        const vbool mask1 =
+            mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2 + 1);
+        const GF3D5index index(layout, p.I);
+        const vec<vreal, dim> vel = beta(mask, index);
+        const auto val = gf0(mask, p.I);
+        const auto dval = calc_deriv<deriv_order>(gf0, mask1, p.I, dx);
+        const auto ddval = calc_deriv2<deriv_order>(gf0, mask1, p.I, dx);
+        const vreal aval =
+            calc_deriv_upwind<deriv_order>(gf0, mask1, p.I, vel, dx);
+        const vreal disval =
+            eps * calc_diss<deriv_order>(gf0, mask1, p.I, dx);
+        gf.store(mask, index, val);
+        dgf.store(mask, index, dval);
+        ddgf.store(mask, index, ddval);
+        adv.store(mask, index, aval);
+        diss.store(mask, index, disval);
+      });
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void calc_derivs2_advection_dissipation(
+    const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+    const smat<GF3D5<T>, dim> &ddgf, const GF3D5<T> &adv,
+    const GF3D5<T> &diss, const GF3D5layout layout,
+    const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+    const vec<GF3D5<T>, dim> &beta, const vect<T, dim> dx, const T eps,
+    const int deriv_order) {
+  switch (deriv_order) {
+  case 2:
+    calc_derivs2_advection_dissipation_impl<CI, CJ, CK, 2>(
+        gf, dgf, ddgf, adv, diss, layout, grid, gf0, beta, dx, eps);
+    break;
+  case 4:
+    calc_derivs2_advection_dissipation_impl<CI, CJ, CK, 4>(
+        gf, dgf, ddgf, adv, diss, layout, grid, gf0, beta, dx, eps);
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", deriv_order);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Batched multi-variable derivative operators
+
+// Process `NB` grid functions in a single pass. `NCOMPS` is the number
+// of results per grid function, 4 for values and first derivatives, 10
+// if second derivatives are included as well.
+template <int CI, int CJ, int CK, int deriv_order, int NCOMPS, int NB,
+          typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs_batch(T *restrict const out, const GF3D5layout layout,
+                  const std::array<const T *, NB> ptrs,
+                  const GF3D2layout layout0, const GridDescBaseDevice &grid,
+                  const vect<T, dim> dx) {
+  static_assert(NCOMPS == 1 + dim || NCOMPS == 1 + dim + dim * (dim + 1) / 2);
+  using vreal = simd<T>;
+  using vbool = simdl<T>;
+  constexpr std::size_t vsize = std::tuple_size_v<vreal>;
+
+  const std::ptrdiff_t np = layout.np;
+  const std::array<std::ptrdiff_t, dim> offsets{
+      layout0.delta(1, 0, 0), layout0.delta(0, 1, 0), layout0.delta(0, 0, 1)};
+
+  grid.loop_int_device<CI, CJ, CK, vsize>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+        // Take account of ghost points
+        const vbool mask1 =
+            mask_for_loop_tail<vbool>(p.i, p.imax + deriv_order / 2);
+        const int index0 = GF3D2index(layout0, p.I).linear();
+        const int index = GF3D5index(layout, p.I).linear();
+        for (int n = 0; n < NB; ++n) {
+          const T *restrict const ptr = &ptrs[n][index0];
+          T *restrict const res = &out[n * NCOMPS * np + index];
+          const auto load = [&](const std::ptrdiff_t off)
+                                CCTK_ATTRIBUTE_ALWAYS_INLINE {
+                                  return maskz_loadu(mask1, &ptr[off]);
+                                };
+          mask_storeu(mask, &res[0], maskz_loadu(mask, ptr));
+          const vec<vreal, dim> dval =
+              detail::calc_deriv<deriv_order>(load, offsets, dx);
+          for (int d = 0; d < dim; ++d)
+            mask_storeu(mask, &res[(1 + d) * np], dval(d));
+          if constexpr (NCOMPS > 1 + dim) {
+            const smat<vreal, dim> ddval =
+                detail::calc_deriv2<deriv_order>(load, offsets, dx);
+            int c = 1 + dim;
+            for (int d = 0; d < dim; ++d)
+              for (int e = d; e < dim; ++e)
+                mask_storeu(mask, &res[c++ * np], ddval(d, e));
+          }
+        }
+      });
+}
+
+template <int CI, int CJ, int CK, int deriv_order, int NCOMPS, typename T>
+void calc_derivs_batches(const GF3D5vector<T> &tmps,
+                         const std::vector<GF3D2<const T> > &gf0s,
+                         const GridDescBaseDevice &grid,
+                         const vect<T, dim> dx) {
+  // Number of grid functions processed in a single pass
+  constexpr int NB = 4;
+  const int nvars = gf0s.size();
+  assert(int(tmps.size()) >= NCOMPS * nvars);
+  for (int n = 0; n < nvars; ++n)
+    assert(gf0s.at(n).layout == gf0s.at(0).layout);
+
+  // The components of a GF3D5vector are stored contiguously
+  for (int n0 = 0; n0 < nvars; n0 += NB) {
+    T *restrict const out = tmps(NCOMPS * n0).ptr;
+    const auto call = [&](auto nb) {
+      constexpr int nb1 = decltype(nb)::value;
+      std::array<const T *, nb1> ptrs;
+      for (int n = 0; n < nb1; ++n)
+        ptrs[n] = gf0s.at(n0 + n).ptr;
+      calc_derivs_batch<CI, CJ, CK, deriv_order, NCOMPS, nb1>(
+          out, tmps.layout, ptrs, gf0s.at(n0).layout, grid, dx);
+    };
+    switch (std::min(NB, nvars - n0)) {
+    case 1:
+      call(std::integral_constant<int, 1>());
+      break;
+    case 2:
+      call(std::integral_constant<int, 2>());
+      break;
+    case 3:
+      call(std::integral_constant<int, 3>());
+      break;
+    case 4:
+      call(std::integral_constant<int, 4>());
+      break;
+    default:
+      assert(0);
+    }
+  }
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs_batched(const GF3D5vector<T> &tmps,
+                    const std::vector<GF3D2<const T> > &gf0s,
+                    const GridDescBaseDevice &grid, const vect<T, dim> dx,
+                    const int deriv_order) {
+  constexpr int ncomps = 1 + dim;
+  switch (deriv_order) {
+  case 2:
+    calc_derivs_batches<CI, CJ, CK, 2, ncomps>(tmps, gf0s, grid, dx);
+    break;
+  case 4:
+    calc_derivs_batches<CI, CJ, CK, 4, ncomps>(tmps, gf0s, grid, dx);
+    break;
+  case 6:
+    calc_derivs_batches<CI, CJ, CK, 6, ncomps>(tmps, gf0s, grid, dx);
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", deriv_order);
+  }
+}
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs2_batched(const GF3D5vector<T> &tmps,
+                     const std::vector<GF3D2<const T> > &gf0s,
+                     const GridDescBaseDevice &grid, const vect<T, dim> dx,
+                     const int deriv_order) {
+  constexpr int ncomps = 1 + dim + dim * (dim + 1) / 2;
+  switch (deriv_order) {
+  case 2:
+    calc_derivs_batches<CI, CJ, CK, 2, ncomps>(tmps, gf0s, grid, dx);
+    break;
+  case 4:
+    calc_derivs_batches<CI, CJ, CK, 4, ncomps>(tmps, gf0s, grid, dx);
+    break;
+  case 6:
+    calc_derivs_batches<CI, CJ, CK, 6, ncomps>(tmps, gf0s, grid, dx);
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", deriv_order);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // Template instantiations
@@ -238,4 +648,54 @@ calc_derivs2<0, 0, 0>(const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
                       const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
                       const vect<T, dim> dx, const int deriv_order);
 
+template void calc_upwind_advection<0, 0, 0>(
+    const GF3D5<T> &adv, const GF3D5layout layout,
+    const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+    const vec<GF3D5<T>, dim> &beta, const vect<T, dim> dx,
+    const int deriv_order);
+
+template void calc_dissipation<0, 0, 0>(const GF3D5<T> &diss,
+                                        const GF3D5layout layout,
+                                        const GridDescBaseDevice &grid,
+                                        const GF3D2<const T> &gf0,
+                                        const vect<T, dim> dx, const T eps,
+                                        const int deriv_order);
+
+template void calc_derivs2_advection_dissipation<0, 0, 0>(
+    const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,
+    const smat<GF3D5<T>, dim> &ddgf, const GF3D5<T> &adv,
+    const GF3D5<T> &diss, const GF3D5layout layout,
+    const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,
+    const vec<GF3D5<T>, dim> &beta, const vect<T, dim> dx, const T eps,
+    const int deriv_order);
+
+template void calc_derivs_batched<0, 0, 0>(
+    const GF3D5vector<T> &tmps, const std::vector<GF3D2<const T> > &gf0s,
+    const GridDescBaseDevice &grid, const vect<T, dim> dx,
+    const int deriv_order);
+
+template void calc_derivs2_batched<0, 0, 0>(
+    const GF3D5vector<T> &tmps, const std::vector<GF3D2<const T> > &gf0s,
+    const GridDescBaseDevice &grid, const vect<T, dim> dx,
+    const int deriv_order);
+
+#define INSTANTIATE_FIXED(N)                                                   \
+  template void calc_derivs_fixed<0, 0, 0, N, N>(                              \
+      const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,                       \
+      const GF3D5layout layout, const GridDescBaseDevice &grid,                \
+      const GF3D2<const T> &gf0, const vect<T, dim> dx,                        \
+      const int deriv_order);                                                  \
+  template void calc_derivs2_fixed<0, 0, 0, N, N>(                             \
+      const GF3D5<T> &gf, const vec<GF3D5<T>, dim> &dgf,                       \
+      const smat<GF3D5<T>, dim> &ddgf, const GF3D5layout layout,               \
+      const GridDescBaseDevice &grid, const GF3D2<const T> &gf0,               \
+      const vect<T, dim> dx, const int deriv_order);
+INSTANTIATE_FIXED(21)
+INSTANTIATE_FIXED(23)
+INSTANTIATE_FIXED(25)
+INSTANTIATE_FIXED(37)
+INSTANTIATE_FIXED(39)
+INSTANTIATE_FIXED(41)
+#undef INSTANTIATE_FIXED
+
 } // namespace Derivs
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 namespace Derivs {
 
@@ -174,7 +175,7 @@ inline CCTK_ATTRIBUTE_ALWAYS_INLINE
   const simd<T> symm =
       c2s * (maskz_loadu(mask, &var[2 * di]) -
              maskz_loadu(mask, &var[-2 * di])) //
-      + c1s(maskz_loadu(mask, &var[di]) - maskz_loadu(mask, &var[-di]));
+      + c1s * (maskz_loadu(mask, &var[di]) - maskz_loadu(mask, &var[-di]));
   // + 1/2 [+1/2 -2   +3/2  0    0  ]
   // - 1/2 [ 0    0   -3/2 +2   -1/2]
   //       [+1/4 -1   +3/2 -1   +1/4]
@@ -183,8 +184,8 @@ inline CCTK_ATTRIBUTE_ALWAYS_INLINE
   constexpr T c2a = 1 / T(4);
   const simd<T> anti =
       c2a * (maskz_loadu(mask, &var[2 * di]) +
-             maskz_loadu(mask, &var[-2 * di]))                          //
-      + c1a(maskz_loadu(mask, &var[di]) + maskz_loadu(mask, &var[-di])) //
+             maskz_loadu(mask, &var[-2 * di]))                            //
+      + c1a * (maskz_loadu(mask, &var[di]) + maskz_loadu(mask, &var[-di])) //
       + c0a * maskz_loadu(mask, &var[0]);
   using std::fabs;
   return (vel * symm - fabs(vel) * anti) / dx;
@@ -416,174 +417,266 @@ inline CCTK_ATTRIBUTE_ALWAYS_INLINE
          dx;
 }
 
+template <int deriv_order, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE
+    CCTK_DEVICE CCTK_HOST std::enable_if_t<deriv_order == 6, simd<T> >
+    diss1d(const simdl<T> &mask, const T *restrict const var,
+           const std::ptrdiff_t di, const T dx) {
+  constexpr T c0 = 70;
+  constexpr T c1 = -56;
+  constexpr T c2 = 28;
+  constexpr T c3 = -8;
+  constexpr T c4 = 1;
+  return (c4 * (maskz_loadu(mask, &var[4 * di]) +
+                maskz_loadu(mask, &var[-4 * di])) //
+          + c3 * (maskz_loadu(mask, &var[3 * di]) +
+                  maskz_loadu(mask, &var[-3 * di])) //
+          + c2 * (maskz_loadu(mask, &var[2 * di]) +
+                  maskz_loadu(mask, &var[-2 * di]))                           //
+          + c1 * (maskz_loadu(mask, &var[di]) + maskz_loadu(mask, &var[-di])) //
+          + c0 * maskz_loadu(mask, &var[0])) /
+         dx;
+}
+
 } // namespace detail
 
 ////////////////////////////////////////////////////////////////////////////////
 
 // Pointwise multi-dimensional derivative operators
 
-template <int deriv_order, typename T>
+namespace detail {
+
+// Grid function strides that are known at compile time. `NI` and `NJ`
+// are the allocated extents in the x and y directions.
+template <int NI, int NJ> struct fixed_offsets {
+  static_assert(NI > 0 && NJ > 0);
+  constexpr CCTK_DEVICE CCTK_HOST std::ptrdiff_t operator[](int d) const {
+    return d == 0 ? 1 : d == 1 ? NI : std::ptrdiff_t(NI) * NJ;
+  }
+};
+
+// `load(off)` loads the grid function at the linear offset `off` from
+// the current point. `offsets` holds the strides, either as run-time
+// array or as `fixed_offsets`.
+template <int deriv_order, typename T, typename Load, typename Offsets,
+          typename R = std::invoke_result_t<Load, std::ptrdiff_t> >
 inline CCTK_ATTRIBUTE_ALWAYS_INLINE
-    CCTK_DEVICE CCTK_HOST Arith::vec<Arith::simd<T>, Loop::dim>
-    calc_deriv(const Loop::GF3D2<const T> &gf, const Arith::simdl<T> &mask,
-               const Arith::vect<int, Loop::dim> &I,
+    CCTK_DEVICE CCTK_HOST Arith::vec<R, Loop::dim>
+    calc_deriv(const Load &load, const Offsets &offsets,
                const Arith::vect<T, Loop::dim> &dx) {
-  using namespace Arith;
-  using namespace Loop;
-  // We use explicit index calculations to avoid unnecessary integer
-  // multiplications
-  const T *restrict const ptr = &gf(I);
-  const std::array<std::ptrdiff_t, Loop::dim> offsets{
-      gf.delta(1, 0, 0),
-      gf.delta(0, 1, 0),
-      gf.delta(0, 0, 1),
-  };
   return {
-      detail::deriv1d<deriv_order>(
+      deriv1d<deriv_order>(
           [&](int di) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[0]]);
+            return load(di * offsets[0]);
           },
           dx[0]),
-      detail::deriv1d<deriv_order>(
+      deriv1d<deriv_order>(
           [&](int di) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[1]]);
+            return load(di * offsets[1]);
           },
           dx[1]),
-      detail::deriv1d<deriv_order>(
+      deriv1d<deriv_order>(
           [&](int di) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[2]]);
+            return load(di * offsets[2]);
           },
           dx[2]),
   };
 }
 
-template <int deriv_order, typename T>
+template <int deriv_order, typename T, typename Load, typename Offsets,
+          typename R = std::invoke_result_t<Load, std::ptrdiff_t> >
 inline CCTK_ATTRIBUTE_ALWAYS_INLINE
-    CCTK_DEVICE CCTK_HOST Arith::vec<T, Loop::dim>
-    calc_deriv(const Loop::GF3D2<const T> &gf,
-               const Arith::vect<int, Loop::dim> &I,
-               const Arith::vect<T, Loop::dim> &dx) {
-  using namespace Arith;
-  using namespace Loop;
-  // We use explicit index calculations to avoid unnecessary integer
-  // multiplications
-  const T *restrict const ptr = &gf(I);
-  const std::array<std::ptrdiff_t, Loop::dim> offsets{
-      gf.delta(1, 0, 0),
-      gf.delta(0, 1, 0),
-      gf.delta(0, 0, 1),
-  };
-  return {
-      detail::deriv1d<deriv_order>(
-          [&](int di)
-              CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[di * offsets[0]]; },
-          dx[0]),
-      detail::deriv1d<deriv_order>(
-          [&](int di)
-              CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[di * offsets[1]]; },
-          dx[1]),
-      detail::deriv1d<deriv_order>(
-          [&](int di)
-              CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[di * offsets[2]]; },
-          dx[2]),
-  };
-}
-
-template <int deriv_order, typename T>
-inline CCTK_ATTRIBUTE_ALWAYS_INLINE
-    CCTK_DEVICE CCTK_HOST Arith::smat<Arith::simd<T>, Loop::dim>
-    calc_deriv2(const Loop::GF3D2<const T> &gf, const Arith::simdl<T> &mask,
-                const Arith::vect<int, Loop::dim> &I,
+    CCTK_DEVICE CCTK_HOST Arith::smat<R, Loop::dim>
+    calc_deriv2(const Load &load, const Offsets &offsets,
                 const Arith::vect<T, Loop::dim> &dx) {
-  using namespace Arith;
-  using namespace Loop;
-  // We use explicit index calculations to avoid unnecessary integer
-  // multiplications
-  const T *restrict const ptr = &gf(I);
-  const std::array<std::ptrdiff_t, Loop::dim> offsets{
-      gf.delta(1, 0, 0),
-      gf.delta(0, 1, 0),
-      gf.delta(0, 0, 1),
-  };
   return {
-      detail::deriv2_1d<deriv_order>(
+      deriv2_1d<deriv_order>(
           [&](int di) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[0]]);
+            return load(di * offsets[0]);
           },
           dx[0]),
-      detail::deriv2_2d<deriv_order, true>(
+      deriv2_2d<deriv_order, true>(
           [&](int di, int dj) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[0] + dj * offsets[1]]);
+            return load(di * offsets[0] + dj * offsets[1]);
           },
           dx[0], dx[1]),
-      detail::deriv2_2d<deriv_order, true>(
+      deriv2_2d<deriv_order, true>(
           [&](int di, int dj) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[0] + dj * offsets[2]]);
+            return load(di * offsets[0] + dj * offsets[2]);
           },
           dx[0], dx[2]),
-      detail::deriv2_1d<deriv_order>(
+      deriv2_1d<deriv_order>(
           [&](int di) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[1]]);
+            return load(di * offsets[1]);
           },
           dx[1]),
-      detail::deriv2_2d<deriv_order, false>(
+      deriv2_2d<deriv_order, false>(
           [&](int di, int dj) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[1] + dj * offsets[2]]);
+            return load(di * offsets[1] + dj * offsets[2]);
           },
           dx[1], dx[2]),
-      detail::deriv2_1d<deriv_order>(
+      deriv2_1d<deriv_order>(
           [&](int di) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return maskz_loadu(mask, &ptr[di * offsets[2]]);
+            return load(di * offsets[2]);
           },
           dx[2]),
   };
 }
 
+template <typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_DEVICE CCTK_HOST
+    std::array<std::ptrdiff_t, Loop::dim>
+    runtime_offsets(const Loop::GF3D2<const T> &gf) {
+  return {gf.delta(1, 0, 0), gf.delta(0, 1, 0), gf.delta(0, 0, 1)};
+}
+
+template <int NI, int NJ, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_DEVICE CCTK_HOST fixed_offsets<NI, NJ>
+checked_fixed_offsets(const Loop::GF3D2<const T> &gf) {
+#ifdef CCTK_DEBUG
+  assert(gf.delta(1, 0, 0) == 1);
+  assert(gf.delta(0, 1, 0) == NI);
+  assert(gf.delta(0, 0, 1) == NI * NJ);
+#endif
+  return fixed_offsets<NI, NJ>();
+}
+
+} // namespace detail
+
+template <int deriv_order, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE
+    CCTK_DEVICE CCTK_HOST Arith::vec<Arith::simd<T>, Loop::dim>
+    calc_deriv(const Loop::GF3D2<const T> &gf, const Arith::simdl<T> &mask,
+               const Arith::vect<int, Loop::dim> &I,
+               const Arith::vect<T, Loop::dim> &dx) {
+  using namespace Arith;
+  // We use explicit index calculations to avoid unnecessary integer
+  // multiplications
+  const T *restrict const ptr = &gf(I);
+  return detail::calc_deriv<deriv_order>(
+      [&](std::ptrdiff_t off) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        return maskz_loadu(mask, &ptr[off]);
+      },
+      detail::runtime_offsets(gf), dx);
+}
+
+template <int deriv_order, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE
+    CCTK_DEVICE CCTK_HOST Arith::vec<T, Loop::dim>
+    calc_deriv(const Loop::GF3D2<const T> &gf,
+               const Arith::vect<int, Loop::dim> &I,
+               const Arith::vect<T, Loop::dim> &dx) {
+  // We use explicit index calculations to avoid unnecessary integer
+  // multiplications
+  const T *restrict const ptr = &gf(I);
+  return detail::calc_deriv<deriv_order>(
+      [&](std::ptrdiff_t off)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[off]; },
+      detail::runtime_offsets(gf), dx);
+}
+
+template <int deriv_order, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE
+    CCTK_DEVICE CCTK_HOST Arith::smat<Arith::simd<T>, Loop::dim>
+    calc_deriv2(const Loop::GF3D2<const T> &gf, const Arith::simdl<T> &mask,
+                const Arith::vect<int, Loop::dim> &I,
+                const Arith::vect<T, Loop::dim> &dx) {
+  using namespace Arith;
+  // We use explicit index calculations to avoid unnecessary integer
+  // multiplications
+  const T *restrict const ptr = &gf(I);
+  return detail::calc_deriv2<deriv_order>(
+      [&](std::ptrdiff_t off) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        return maskz_loadu(mask, &ptr[off]);
+      },
+      detail::runtime_offsets(gf), dx);
+}
+
 template <int deriv_order, typename T>
 inline CCTK_ATTRIBUTE_ALWAYS_INLINE
     CCTK_DEVICE CCTK_HOST Arith::smat<T, Loop::dim>
     calc_deriv2(const Loop::GF3D2<const T> &gf,
                 const Arith::vect<int, Loop::dim> &I,
                 const Arith::vect<T, Loop::dim> &dx) {
-  using namespace Arith;
-  using namespace Loop;
   // We use explicit index calculations to avoid unnecessary integer
   // multiplications
   const T *restrict const ptr = &gf(I);
-  const std::array<std::ptrdiff_t, Loop::dim> offsets{
-      gf.delta(1, 0, 0),
-      gf.delta(0, 1, 0),
-      gf.delta(0, 0, 1),
-  };
-  return {
-      detail::deriv2_1d<deriv_order>(
-          [&](int di)
-              CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[di * offsets[0]]; },
-          dx[0]),
-      detail::deriv2_2d<deriv_order, true>(
-          [&](int di, int dj) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return ptr[di * offsets[0] + dj * offsets[1]];
-          },
-          dx[0], dx[1]),
-      detail::deriv2_2d<deriv_order, true>(
-          [&](int di, int dj) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return ptr[di * offsets[0] + dj * offsets[2]];
-          },
-          dx[0], dx[2]),
-      detail::deriv2_1d<deriv_order>(
-          [&](int di)
-              CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[di * offsets[1]]; },
-          dx[1]),
-      detail::deriv2_2d<deriv_order, false>(
-          [&](int di, int dj) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-            return ptr[di * offsets[1] + dj * offsets[2]];
-          },
-          dx[1], dx[2]),
-      detail::deriv2_1d<deriv_order>(
-          [&](int di)
-              CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[di * offsets[2]]; },
-          dx[2]),
-  };
+  return detail::calc_deriv2<deriv_order>(
+      [&](std::ptrdiff_t off)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE { return ptr[off]; },
+      detail::runtime_offsets(gf), dx);
+}
+
+// Variants for grid functions with a fixed allocated shape. `NI` and `NJ`
+// are the allocated extents in the x and y directions. The strides are
+// then compile-time constants, which lets the compiler fully unroll and
+// schedule the stencils.
+
+template <int deriv_order, int NI, int NJ, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE
+    CCTK_DEVICE CCTK_HOST Arith::vec<Arith::simd<T>, Loop::dim>
+    calc_deriv_fixed(const Loop::GF3D2<const T> &gf,
+                     const Arith::simdl<T> &mask,
+                     const Arith::vect<int, Loop::dim> &I,
+                     const Arith::vect<T, Loop::dim> &dx) {
+  using namespace Arith;
+  const T *restrict const ptr = &gf(I);
+  return detail::calc_deriv<deriv_order>(
+      [&](std::ptrdiff_t off) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        return maskz_loadu(mask, &ptr[off]);
+      },
+      detail::checked_fixed_offsets<NI, NJ>(gf), dx);
+}
+
+template <int deriv_order, int NI, int NJ, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE
+    CCTK_DEVICE CCTK_HOST Arith::smat<Arith::simd<T>, Loop::dim>
+    calc_deriv2_fixed(const Loop::GF3D2<const T> &gf,
+                      const Arith::simdl<T> &mask,
+                      const Arith::vect<int, Loop::dim> &I,
+                      const Arith::vect<T, Loop::dim> &dx) {
+  using namespace Arith;
+  const T *restrict const ptr = &gf(I);
+  return detail::calc_deriv2<deriv_order>(
+      [&](std::ptrdiff_t off) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        return maskz_loadu(mask, &ptr[off]);
+      },
+      detail::checked_fixed_offsets<NI, NJ>(gf), dx);
+}
+
+// Upwinded advection derivative `vel^i d_i gf`. The stencils are
+// lopsided by one point in the direction of `vel`.
+template <int deriv_order, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_DEVICE CCTK_HOST Arith::simd<T>
+calc_deriv_upwind(const Loop::GF3D2<const T> &gf, const Arith::simdl<T> &mask,
+                  const Arith::vect<int, Loop::dim> &I,
+                  const Arith::vec<Arith::simd<T>, Loop::dim> &vel,
+                  const Arith::vect<T, Loop::dim> &dx) {
+  const T *restrict const ptr = &gf(I);
+  return detail::deriv1d_upwind<deriv_order>(mask, ptr, gf.delta(1, 0, 0),
+                                             vel(0), dx[0]) +
+         detail::deriv1d_upwind<deriv_order>(mask, ptr, gf.delta(0, 1, 0),
+                                             vel(1), dx[1]) +
+         detail::deriv1d_upwind<deriv_order>(mask, ptr, gf.delta(0, 0, 1),
+                                             vel(2), dx[2]);
+}
+
+// Kreiss-Oliger dissipation operator, to be used with finite
+// differencing of order `deriv_order`. This uses derivatives of order
+// `2r` with `r = deriv_order / 2 + 1`, with the usual normalization
+// factor `(-1)^(r+1) / 2^(2r)`.
+template <int deriv_order, typename T>
+inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_DEVICE CCTK_HOST Arith::simd<T>
+calc_diss(const Loop::GF3D2<const T> &gf, const Arith::simdl<T> &mask,
+          const Arith::vect<int, Loop::dim> &I,
+          const Arith::vect<T, Loop::dim> &dx) {
+  constexpr int r = deriv_order / 2 + 1;
+  constexpr T factor = (r % 2 == 0 ? -1 : +1) / T(1 << (2 * r));
+  const T *restrict const ptr = &gf(I);
+  return factor *
+         (detail::diss1d<deriv_order>(mask, ptr, gf.delta(1, 0, 0), dx[0]) +
+          detail::diss1d<deriv_order>(mask, ptr, gf.delta(0, 1, 0), dx[1]) +
+          detail::diss1d<deriv_order>(mask, ptr, gf.delta(0, 0, 1), dx[2]));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -611,6 +704,81 @@ CCTK_ATTRIBUTE_NOINLINE void calc_derivs2(
     const Loop::GF3D2<const T> &gf0, const Arith::vect<T, Loop::dim> dx,
     const int deriv_order);
 
+// Variants for a fixed allocated shape `NI` x `NJ` of `gf0` (see
+// `calc_deriv_fixed`). These are instantiated only for a few common
+// shapes; `calc_derivs` and `calc_derivs2` use them automatically when
+// `gf0` has one of these shapes.
+
+template <int CI, int CJ, int CK, int NI, int NJ, typename T>
+CCTK_ATTRIBUTE_NOINLINE void calc_derivs_fixed(
+    const Loop::GF3D5<T> &gf, const Arith::vec<Loop::GF3D5<T>, Loop::dim> &dgf,
+    const Loop::GF3D5layout layout, const Loop::GridDescBaseDevice &grid,
+    const Loop::GF3D2<const T> &gf0, const Arith::vect<T, Loop::dim> dx,
+    const int deriv_order);
+
+template <int CI, int CJ, int CK, int NI, int NJ, typename T>
+CCTK_ATTRIBUTE_NOINLINE void calc_derivs2_fixed(
+    const Loop::GF3D5<T> &gf, const Arith::vec<Loop::GF3D5<T>, Loop::dim> &dgf,
+    const Arith::smat<Loop::GF3D5<T>, Loop::dim> &ddgf,
+    const Loop::GF3D5layout layout, const Loop::GridDescBaseDevice &grid,
+    const Loop::GF3D2<const T> &gf0, const Arith::vect<T, Loop::dim> dx,
+    const int deriv_order);
+
+// Upwinded advection term `beta^i d_i gf0` (see `calc_deriv_upwind`).
+// This supports derivative orders 2 and 4.
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void calc_upwind_advection(
+    const Loop::GF3D5<T> &adv, const Loop::GF3D5layout layout,
+    const Loop::GridDescBaseDevice &grid, const Loop::GF3D2<const T> &gf0,
+    const Arith::vec<Loop::GF3D5<T>, Loop::dim> &beta,
+    const Arith::vect<T, Loop::dim> dx, const int deriv_order);
+
+// Kreiss-Oliger dissipation `eps * D gf0` (see `calc_diss`)
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_dissipation(const Loop::GF3D5<T> &diss, const Loop::GF3D5layout layout,
+                 const Loop::GridDescBaseDevice &grid,
+                 const Loop::GF3D2<const T> &gf0,
+                 const Arith::vect<T, Loop::dim> dx, const T eps,
+                 const int deriv_order);
+
+// Fused variant of `calc_derivs2`, `calc_upwind_advection`, and
+// `calc_dissipation` that reads `gf0` only once. `beta` must not be
+// one of the outputs.
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void calc_derivs2_advection_dissipation(
+    const Loop::GF3D5<T> &gf, const Arith::vec<Loop::GF3D5<T>, Loop::dim> &dgf,
+    const Arith::smat<Loop::GF3D5<T>, Loop::dim> &ddgf,
+    const Loop::GF3D5<T> &adv, const Loop::GF3D5<T> &diss,
+    const Loop::GF3D5layout layout, const Loop::GridDescBaseDevice &grid,
+    const Loop::GF3D2<const T> &gf0,
+    const Arith::vec<Loop::GF3D5<T>, Loop::dim> &beta,
+    const Arith::vect<T, Loop::dim> dx, const T eps, const int deriv_order);
+
+// Batched variants for many grid functions. All grid functions in `gf0s`
+// must have the same layout. They are processed a few at a time in a
+// single pass, sharing the loop structure, masks, and index calculations.
+// For grid function `n`, `calc_derivs_batched` stores the value and the
+// first derivatives in components `4 * n` to `4 * n + 3` of `tmps`, and
+// `calc_derivs2_batched` stores the value, the first derivatives, and the
+// second derivatives (in `smat` order) in components `10 * n` to `10 * n
+// + 9`.
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs_batched(const Loop::GF3D5vector<T> &tmps,
+                    const std::vector<Loop::GF3D2<const T> > &gf0s,
+                    const Loop::GridDescBaseDevice &grid,
+                    const Arith::vect<T, Loop::dim> dx, const int deriv_order);
+
+template <int CI, int CJ, int CK, typename T>
+CCTK_ATTRIBUTE_NOINLINE void
+calc_derivs2_batched(const Loop::GF3D5vector<T> &tmps,
+                     const std::vector<Loop::GF3D2<const T> > &gf0s,
+                     const Loop::GridDescBaseDevice &grid,
+                     const Arith::vect<T, Loop::dim> dx,
+                     const int deriv_order);
+
 } // namespace Derivs
 
 #endif // #ifndef CARPETX_DERIVS_DERIVS_HXX
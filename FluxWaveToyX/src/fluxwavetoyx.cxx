@@ -23,7 +23,9 @@ average(const Loop::GF3D2<T> &var, const Loop::PointDesc &p, const int dir) {
 }
 
 // Flux divergence
-// Expects fluxes on faces, calculates divergence in cell
+// Expects fluxes on faces, calculates divergence in cell. The fluxes
+// are flux densities (per face area and time), which is also what
+// CarpetX expects when refluxing.
 template <typename T>
 CCTK_DEVICE CCTK_HOST inline CCTK_ATTRIBUTE_ALWAYS_INLINE auto
 flux_div(const Loop::GF3D2<T> &flux_x, const Loop::GF3D2<T> &flux_y,
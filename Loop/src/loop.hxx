@@ -153,6 +153,46 @@ public:
                      bnd_max, loop_min, loop_max, X, DX);
   }
 
+  // Loop over the points i0 <= i < i1 of a row of a box. If `INTERIOR`
+  // is true, the points must be neither in nor next to the outer
+  // boundary, so that the boundary information in the point descriptor
+  // is trivial and need not be calculated. The point descriptor is
+  // otherwise the same; fields that the kernel does not use (e.g. the
+  // coordinates) are optimized away when the kernel is inlined.
+  template <bool INTERIOR, int CI, int CJ, int CK, int VS, typename F>
+  CCTK_ATTRIBUTE_ALWAYS_INLINE void
+  loop_row(const int i0, const int i1, const int j, const int k,
+           const int iter, const vect<int, dim> &restrict bnd_min,
+           const vect<int, dim> &restrict bnd_max,
+           const vect<int, dim> &restrict loop_min,
+           const vect<int, dim> &restrict loop_max, const F &f) const {
+#pragma omp simd
+    for (int i = i0; i < i1; i += VS) {
+      // Grid point
+      const vect<int, dim> I = {i, j, k};
+      if constexpr (INTERIOR) {
+        const vect<int, dim> Z = vect<int, dim>::pure(0);
+        const PointDesc p = point_desc({CI, CJ, CK}, I, iter, Z, Z, Z, bnd_min,
+                                       bnd_max, loop_min, loop_max);
+        f(p);
+      } else {
+        // Outward boundary normal (if in outer boundary), else 0
+        const vect<int, dim> NI =
+            vect<int, dim>(I > bnd_max - 1) - vect<int, dim>(I < bnd_min);
+        // Nearest interior point
+        const vect<int, dim> I0 =
+            if_else(NI == 0, 0, if_else(NI < 0, bnd_min, bnd_max - 1));
+        // Outward boundary normal (if on outermost interior point), else 0
+        const vect<int, dim> BI =
+            vect<int, dim>(I == bnd_max - 1) - vect<int, dim>(I == bnd_min);
+        const PointDesc p =
+            point_desc({CI, CJ, CK}, I, iter, NI, I0, BI, bnd_min, bnd_max,
+                       loop_min, loop_max);
+        f(p);
+      }
+    }
+  }
+
   // Loop over a given box
   template <int CI, int CJ, int CK, int VS = 1, int N = 1, typename F>
   void loop_box(const vect<int, dim> &restrict bnd_min,
@@ -168,26 +208,40 @@ public:
     if (N == 0 || any(loop_max <= loop_min))
       return;
 
+    // Box of points that are neither in nor next to the outer boundary
+    using std::max, std::min;
+    const vect<int, dim> int_min = max(loop_min, bnd_min + 1);
+    const vect<int, dim> int_max = max(int_min, min(loop_max, bnd_max - 1));
+
     for (int iter = 0; iter < N; ++iter) {
       for (int k = loop_min[2]; k < loop_max[2]; ++k) {
         for (int j = loop_min[1]; j < loop_max[1]; ++j) {
-#pragma omp simd
-          for (int i = loop_min[0]; i < loop_max[0]; i += VS) {
-            // Grid point
-            const vect<int, dim> I = {i, j, k};
-            // Outward boundary normal (if in outer boundary), else 0
-            const vect<int, dim> NI =
-                vect<int, dim>(I > bnd_max - 1) - vect<int, dim>(I < bnd_min);
-            // Nearest interior point
-            const vect<int, dim> I0 =
-                if_else(NI == 0, 0, if_else(NI < 0, bnd_min, bnd_max - 1));
-            // Outward boundary normal (if on outermost interior point), else 0
-            const vect<int, dim> BI =
-                vect<int, dim>(I == bnd_max - 1) - vect<int, dim>(I == bnd_min);
-            const PointDesc p =
-                point_desc({CI, CJ, CK}, I, iter, NI, I0, BI, bnd_min, bnd_max,
-                           loop_min, loop_max);
-            f(p);
+          const bool row_is_interior = j >= int_min[1] && j < int_max[1] &&
+                                       k >= int_min[2] && k < int_max[2];
+          if (row_is_interior) {
+            // Split the row into a boundary, an interior, and another
+            // boundary part. With SIMD vectorization, the vectors need to
+            // start at loop_min[0] plus a multiple of VS, and the interior
+            // part may contain only complete vectors.
+            const int i0 =
+                min(loop_max[0],
+                    loop_min[0] +
+                        (int_min[0] - loop_min[0] + VS - 1) / VS * VS);
+            const int i1 =
+                max(i0, min(loop_max[0],
+                            loop_min[0] + (int_max[0] - loop_min[0]) / VS * VS));
+            loop_row<false, CI, CJ, CK, VS>(loop_min[0], i0, j, k, iter,
+                                            bnd_min, bnd_max, loop_min,
+                                            loop_max, f);
+            loop_row<true, CI, CJ, CK, VS>(i0, i1, j, k, iter, bnd_min,
+                                           bnd_max, loop_min, loop_max, f);
+            loop_row<false, CI, CJ, CK, VS>(i1, loop_max[0], j, k, iter,
+                                            bnd_min, bnd_max, loop_min,
+                                            loop_max, f);
+          } else {
+            loop_row<false, CI, CJ, CK, VS>(loop_min[0], loop_max[0], j, k,
+                                            iter, bnd_min, bnd_max, loop_min,
+                                            loop_max, f);
           }
         }
       }
@@ -1577,6 +1631,48 @@ public:
   }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Storage for the intermediate results of a stencil pipeline (see
+// `GridDescBaseDevice::loop_int_pipeline_device`). This covers a single
+// block including its halo, and is reused for all blocks of a tile.
+template <typename T> struct GF3D5block {
+  typedef T value_type;
+  GF3D5layout layout;
+  T *restrict ptr;
+  int nvars;
+  GF3D5block() = delete;
+  GF3D5block(const GF3D5block &) = default;
+  GF3D5block(GF3D5block &&) = default;
+  GF3D5block &operator=(const GF3D5block &) = default;
+  GF3D5block &operator=(GF3D5block &&) = default;
+  CCTK_DEVICE CCTK_HOST GF3D5block(const GF3D5layout &layout,
+                                   T *restrict ptr, const int nvars)
+      : layout(layout), ptr(ptr), nvars(nvars) {}
+  CCTK_DEVICE CCTK_HOST int size() const { return nvars; }
+  CCTK_DEVICE CCTK_HOST GF3D5<T> operator()(const int n) const {
+#ifdef CCTK_DEBUG
+    assert(n >= 0 && n < nvars);
+#endif
+    return GF3D5<T>(layout, ptr + n * layout.np);
+  }
+};
+
+// A stage of a stencil pipeline. `radius` is the stencil radius with
+// which this stage reads the results of the previous stage. The kernel
+// is called as `kernel(const PointDesc &p, const GF3D5block<CCTK_REAL>
+// &tmp)`.
+template <typename F> struct PipelineStage {
+  int radius;
+  F kernel;
+};
+
+template <typename F>
+PipelineStage<F> pipeline_stage(const int radius, const F &kernel) {
+  assert(radius >= 0);
+  return PipelineStage<F>{radius, kernel};
+}
+
 } // namespace Loop
 
 // Macros for declaring variables using DECLARE_CCTK_ARGUMENTSX_func_name
@@ -13,6 +13,8 @@
 #include <AMReX_Gpu.H>
 #endif
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 
 #ifndef HAVE_CAPABILITY_Loop
@@ -81,26 +83,51 @@ public:
                        CJ ? amrex::IndexType::CELL : amrex::IndexType::NODE,
                        CK ? amrex::IndexType::CELL : amrex::IndexType::NODE));
 
-    amrex::ParallelFor<NT>(
-        box, [=, *this] CCTK_DEVICE(const int i, const int j,
-                                    const int k) CCTK_ATTRIBUTE_ALWAYS_INLINE {
-          const vect<int, dim> I = {i, j, k};
-          const vect<int, dim> NI =
-              vect<int, dim>(I > bnd_max1 - 1) - vect<int, dim>(I < bnd_min1);
-          const vect<int, dim> I0 =
-              // If NI<0,   return bnd_min1
-              // If NI>0,   return bnd_max1-1
-              // If NI==0,  return 0
-              if_else(NI == 0, 0, if_else(NI < 0, bnd_min1, bnd_max1 - 1));
-          const vect<int, dim> BI =
-              vect<int, dim>(I == bnd_max1 - 1) - vect<int, dim>(I == bnd_min1);
-          for (int iter = 0; iter < N; ++iter) {
-            const PointDesc p =
-                point_desc({CI, CJ, CK}, I, iter, NI, I0, BI, bnd_min1,
-                           bnd_max1, loop_min1, loop_max1);
-            f(p);
-          }
-        });
+    // Boxes that are neither in nor next to the outer boundary (the
+    // common case) do not need to determine boundary information for
+    // each point. We decide this for the whole box to avoid divergent
+    // threads, so that boxes touching the boundary take the general path
+    // for all their points.
+    const bool box_is_interior =
+        all(loop_min > bnd_min) && all(loop_max < bnd_max);
+    if (box_is_interior) {
+      amrex::ParallelFor<NT>(
+          box,
+          [=, *this] CCTK_DEVICE(const int i, const int j,
+                                 const int k) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+            const vect<int, dim> I = {i, j, k};
+            const vect<int, dim> Z = vect<int, dim>::pure(0);
+            for (int iter = 0; iter < N; ++iter) {
+              const PointDesc p =
+                  point_desc({CI, CJ, CK}, I, iter, Z, Z, Z, bnd_min1,
+                             bnd_max1, loop_min1, loop_max1);
+              f(p);
+            }
+          });
+    } else {
+      amrex::ParallelFor<NT>(
+          box,
+          [=, *this] CCTK_DEVICE(const int i, const int j,
+                                 const int k) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+            const vect<int, dim> I = {i, j, k};
+            const vect<int, dim> NI =
+                vect<int, dim>(I > bnd_max1 - 1) - vect<int, dim>(I < bnd_min1);
+            const vect<int, dim> I0 =
+                // If NI<0,   return bnd_min1
+                // If NI>0,   return bnd_max1-1
+                // If NI==0,  return 0
+                if_else(NI == 0, 0, if_else(NI < 0, bnd_min1, bnd_max1 - 1));
+            const vect<int, dim> BI =
+                vect<int, dim>(I == bnd_max1 - 1) -
+                vect<int, dim>(I == bnd_min1);
+            for (int iter = 0; iter < N; ++iter) {
+              const PointDesc p =
+                  point_desc({CI, CJ, CK}, I, iter, NI, I0, BI, bnd_min1,
+                             bnd_max1, loop_min1, loop_max1);
+              f(p);
+            }
+          });
+    }
 
     static const bool gpu_sync_after_every_kernel = []() {
       int type;
@@ -141,6 +168,94 @@ public:
     loop_box_device<CI, CJ, CK, VS, N, NT>(bnd_min, bnd_max, imin, imax, f);
   }
 
+  // Run a single stage of a stencil pipeline over a given box
+  template <int CI, int CJ, int CK, int VS, int NT, typename F>
+  void loop_pipeline_stage_device(const vect<int, dim> &restrict bnd_min,
+                                  const vect<int, dim> &restrict bnd_max,
+                                  const vect<int, dim> &restrict loop_min,
+                                  const vect<int, dim> &restrict loop_max,
+                                  const GF3D5block<CCTK_REAL> &tmp,
+                                  const PipelineStage<F> &stage) const {
+    const F &kernel = stage.kernel;
+    loop_box_device<CI, CJ, CK, VS, 1, NT>(
+        bnd_min, bnd_max, loop_min, loop_max,
+        [=] CCTK_DEVICE(const PointDesc &p)
+            CCTK_ATTRIBUTE_ALWAYS_INLINE { kernel(p, tmp); });
+  }
+
+  // Loop over all interior points, running a pipeline of stencil stages.
+  // The tile is split into blocks of size `block_size`. For each block,
+  // all stages are run one after the other before moving on to the next
+  // block. Stages write their intermediate results into `nvars`
+  // temporaries that cover only the current block, so that these stay in
+  // cache. Each stage is evaluated on the block grown by the sum of the
+  // stencil radii of all later stages, so that these can read the
+  // intermediate results at their stencil points. On GPUs the whole tile
+  // is a single block.
+  template <int CI, int CJ, int CK, int VS = 1,
+            int NT = AMREX_GPU_MAX_THREADS, typename... Stages>
+  void loop_int_pipeline_device(const vect<int, dim> &group_nghostzones,
+                                const vect<int, dim> &block_size,
+                                const int nvars,
+                                const Stages &...stages) const {
+    constexpr int nstages = sizeof...(Stages);
+    static_assert(nstages > 0);
+    assert(all(block_size > 0));
+    assert(nvars >= 0);
+
+    vect<int, dim> bnd_min, bnd_max;
+    boundary_box<CI, CJ, CK>(group_nghostzones, bnd_min, bnd_max);
+    vect<int, dim> imin, imax;
+    box_int<CI, CJ, CK>(group_nghostzones, imin, imax);
+    if (any(imax <= imin))
+      return;
+
+    // Halo of each stage
+    const std::array<int, nstages> radii{stages.radius...};
+    std::array<int, nstages> halos;
+    halos[nstages - 1] = 0;
+    for (int s = nstages - 2; s >= 0; --s)
+      halos[s] = halos[s + 1] + radii[s + 1];
+    const int halo = halos[0];
+    // The first stage reads grid functions in the halo
+    assert(all(group_nghostzones >= halo + radii[0]));
+
+#ifndef AMREX_USE_GPU
+    using std::min;
+    const vect<int, dim> bsize = min(block_size, imax - imin);
+#else
+    const vect<int, dim> bsize = imax - imin;
+#endif
+
+    // Temporaries for a single block, including its halo
+    const vect<int, dim> ash = bsize + 2 * halo;
+    const amrex::Box box(amrex::IntVect(0, 0, 0),
+                         amrex::IntVect(ash[0] * ash[1] * ash[2] - 1, 0, 0));
+    amrex::FArrayBox fab(box, std::max(1, nvars), amrex::The_Async_Arena());
+    CCTK_REAL *restrict const ptr = fab.dataPtr();
+
+    for (int k = imin[2]; k < imax[2]; k += bsize[2]) {
+      for (int j = imin[1]; j < imax[1]; j += bsize[1]) {
+        for (int i = imin[0]; i < imax[0]; i += bsize[0]) {
+          const vect<int, dim> bmin{i, j, k};
+          using std::min;
+          const vect<int, dim> bmax = min(bmin + bsize, imax);
+          const GF3D5block<CCTK_REAL> tmp(
+              GF3D5layout(bmin - halo, bmax + halo, ash), ptr, nvars);
+
+          int s = 0;
+          const auto run_stage = [&](const auto &stage) {
+            this->template loop_pipeline_stage_device<CI, CJ, CK, VS, NT>(
+                bnd_min, bnd_max, bmin - halos[s], bmax + halos[s], tmp,
+                stage);
+            ++s;
+          };
+          (run_stage(stages), ...);
+        }
+      }
+    }
+  }
+
   // Loop over a part of the domain. Loop over the interior first,
   // then faces, then edges, then corners.
   template <int CI, int CJ, int CK, int VS = 1, int N = 1,
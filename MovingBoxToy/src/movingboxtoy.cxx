@@ -16,6 +16,12 @@ extern "C" void MovingBoxToy_MoveBoxes(CCTK_ARGUMENTS) {
   using std::cos;
   using std::sqrt;
 
+  if (CCTK_EQUALS(trajectory, "line")) {
+    for (int n = 0; n < 2; ++n)
+      position_x[n] = line_start_x[n] + line_velocity_x[n] * cctk_time;
+    return;
+  }
+
   const CCTK_REAL omega{M_PI/4};
 
   // Radius of each box
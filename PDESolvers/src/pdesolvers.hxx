@@ -1,13 +1,19 @@
 #ifndef CARPETX_PDESOLVERS_PDESOLVERS_HXX
 #define CARPETX_PDESOLVERS_PDESOLVERS_HXX
 
+#include <dual.hxx>
+#include <loop.hxx>
+#include <simd.hxx>
 #include <spvect.hxx>
+#include <vect.hxx>
 
 #include <cctk.h>
 
 #include <petsc.h>
 
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <optional>
 #include <tuple>
 #include <vector>
@@ -99,6 +105,57 @@ public:
 
 extern std::optional<jacobians_t> jacobians;
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Automatic Jacobian assembly
+
+// Dual number type for the solution in `assemble_jacobian`, with one
+// derivative per stencil point
+template <int NS>
+using stencil_dual_t =
+    Arith::dual<CCTK_REALVEC, Arith::vect<CCTK_REALVEC, NS> >;
+
+// Add the Jacobian of a point-wise residual to `J`, using forward-mode
+// automatic differentiation. `stencil` lists the offsets (relative to
+// the current point) of all grid points the residual depends on.
+// `residual(p, sol)` evaluates the residual at the SIMD-vectorized point
+// `p`, where `sol(I)` returns the solution at grid point `I` as
+// `stencil_dual_t<NS>`, seeded with the stencil point's unit vector.
+// `gf_idx` holds the global indices of the solution.
+template <int CI, int CJ, int CK, std::size_t NS, typename F>
+void assemble_jacobian(
+    const Loop::GridDescBase &grid, const Loop::GF3D2<const CCTK_REAL> &gf_idx,
+    const Loop::GF3D2<const CCTK_REAL> &gf_sol,
+    const std::array<Arith::vect<int, Loop::dim>, NS> &stencil, jacobian_t &J,
+    const F &residual) {
+  using vreal = CCTK_REALVEC;
+  using vbool = CCTK_BOOLVEC;
+  constexpr std::size_t vsize = CCTK_VECSIZE;
+  using dual_t = stencil_dual_t<NS>;
+
+  grid.loop_int<CI, CJ, CK, vsize>(
+      grid.nghostzones, [&](const Loop::PointDesc &p) ARITH_INLINE {
+        const vbool mask = p.mask;
+        const auto sol = [&](const Arith::vect<int, Loop::dim> &I) {
+          std::size_t n = 0;
+          while (n < NS && !all(stencil[n] == I - p.I))
+            ++n;
+          assert(n < NS);
+          return dual_t(gf_sol(mask, I), Arith::vect<vreal, NS>::unit(n));
+        };
+
+        const dual_t res = residual(p, sol);
+
+        const vreal idx = gf_idx(mask, p.I);
+        for (std::size_t n = 0; n < NS; ++n) {
+          const vreal idx1 = gf_idx(mask, p.I + stencil[n]);
+          for (std::size_t l = 0; l < vsize; ++l)
+            if (mask[l])
+              J.add_value(int(idx[l]), int(idx1[l]), res.eps[n][l]);
+        }
+      });
+}
+
 } // namespace PDESolvers
 
 #endif // #ifndef CARPETX_PDESOLVERS_PDESOLVERS_HXX
@@ -918,15 +918,59 @@ void enumerate_points(
   }
 }
 
+// Grid function offsets of the PETSc points of each process-local
+// component, in PETSc order. These are calculated once per solve so
+// that copying between Cactus and PETSc is a plain gather or scatter.
+typedef std::vector<std::vector<std::vector<int> > > point_offsets_t;
+
+void enumerate_point_offsets(
+    point_offsets_t &restrict point_offsets,
+    const std::vector<std::vector<int> > &component_sizes) {
+  static const int vn_pt = CCTK_VarIndex("PDESolvers::point_type");
+  assert(vn_pt >= 0);
+
+  point_offsets.resize(component_sizes.size());
+  for (std::size_t level = 0; level < component_sizes.size(); ++level)
+    point_offsets.at(level).resize(component_sizes.at(level).size());
+
+  CarpetX::active_levels->loop_parallel([&](const int patch, const int level,
+                                            const int index,
+                                            const int component,
+                                            const cGH *restrict const cctkGH) {
+    const Loop::GF3D2layout layout1(cctkGH, indextype);
+    const CarpetX::GridDescBase grid(cctkGH);
+    const Loop::GF3D2<const CCTK_REAL> gf_pt(
+        layout1,
+        static_cast<const CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, tl, vn_pt)));
+    std::vector<int> &offsets = point_offsets.at(level).at(component);
+    offsets.clear();
+    offsets.reserve(component_sizes.at(level).at(component));
+    grid.loop_all<0, 0, 0>(
+        grid.nghostzones, [&](const Loop::PointDesc &p) ARITH_INLINE {
+          switch (int(gf_pt(p.I))) {
+          case int(point_type_t::intr):
+            offsets.push_back(layout1.linear(p.I));
+            break;
+          case int(point_type_t::bdry):
+          case int(point_type_t::rest):
+          case int(point_type_t::sync):
+          case int(point_type_t::prol):
+            // ignore this point
+            break;
+          default:
+            assert(0);
+          }
+        });
+    assert(int(offsets.size()) == component_sizes.at(level).at(component));
+  });
+}
+
 void copy_Cactus_to_PETSc(
     Vec vec, const std::vector<int> &varinds,
     const std::vector<std::vector<int> > &component_offsets,
-    const std::vector<std::vector<int> > &component_sizes) {
+    const point_offsets_t &point_offsets) {
   PetscErrorCode ierr;
 
-  int myproc;
-  MPI_Comm_rank(MPI_COMM_WORLD, &myproc);
-
   // Decode Cactus variables
   const int nvars = varinds.size();
   std::vector<int> gis, vis;
@@ -943,14 +987,6 @@ void copy_Cactus_to_PETSc(
     assert(vi >= 0);
     vis.push_back(vi);
   }
-  static const int vn_pt = CCTK_VarIndex("PDESolvers::point_type");
-  assert(vn_pt >= 0);
-  static const int gi_pt = CCTK_GroupIndexFromVarI(vn_pt);
-  assert(gi_pt >= 0);
-  static const int v0_pt = CCTK_FirstVarIndexI(gi_pt);
-  assert(v0_pt >= 0);
-  static const int vi_pt = vn_pt - v0_pt;
-  assert(vi_pt >= 0);
 
   // Get vector from PETSc
   CCTK_REAL *vec_ptr;
@@ -963,8 +999,6 @@ void copy_Cactus_to_PETSc(
                                             const int index,
                                             const int component,
                                             const cGH *restrict const cctkGH) {
-    const Loop::GF3D2layout layout1(cctkGH, indextype);
-    const CarpetX::GridDescBase grid(cctkGH);
     const auto &patchdata = CarpetX::ghext->patchdata.at(patch);
     const auto &leveldata = patchdata.leveldata.at(level);
     for (int n = 0; n < nvars; ++n)
@@ -972,34 +1006,18 @@ void copy_Cactus_to_PETSc(
                                 tl, CarpetX::make_valid_int(), []() {
                                   return "PDESolver::copy_Cactus_to_PETSc";
                                 });
-    const Loop::GF3D2<const CCTK_REAL> gf_pt(
-        layout1,
-        static_cast<const CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, tl, vn_pt)));
-    std::vector<Loop::GF3D2<const CCTK_REAL> > gfs;
-    gfs.reserve(nvars);
-    for (int n = 0; n < nvars; ++n)
-      gfs.emplace_back(layout1, static_cast<const CCTK_REAL *>(CCTK_VarDataPtrI(
-                                    cctkGH, tl, varinds.at(n))));
-    const int component_offset = component_offsets.at(level).at(component);
-    int nelems = 0;
-    grid.loop_all<0, 0, 0>(
-        grid.nghostzones, [&](const Loop::PointDesc &p) ARITH_INLINE {
-          switch (int(gf_pt(p.I))) {
-          case int(point_type_t::intr):
-            for (int n = 0; n < nvars; ++n)
-              petsc_ptr[nvars * component_offset + nelems++] = gfs.at(n)(p.I);
-            break;
-          case int(point_type_t::bdry):
-          case int(point_type_t::rest):
-          case int(point_type_t::sync):
-          case int(point_type_t::prol):
-            // ignore this point
-            break;
-          default:
-            assert(0);
-          }
-        });
-    assert(nelems == nvars * component_sizes.at(level).at(component));
+    const std::vector<int> &offsets = point_offsets.at(level).at(component);
+    const int npoints = offsets.size();
+    const int *restrict const offsets_ptr = offsets.data();
+    CCTK_REAL *restrict const ptr =
+        petsc_ptr + nvars * component_offsets.at(level).at(component);
+    for (int n = 0; n < nvars; ++n) {
+      const CCTK_REAL *restrict const var_ptr =
+          static_cast<const CCTK_REAL *>(
+              CCTK_VarDataPtrI(cctkGH, tl, varinds.at(n)));
+      for (int i = 0; i < npoints; ++i)
+        ptr[nvars * i + n] = var_ptr[offsets_ptr[i]];
+    }
   });
 
   ierr = VecRestoreArray(vec, &vec_ptr);
@@ -1009,12 +1027,9 @@ void copy_Cactus_to_PETSc(
 void copy_PETSc_to_Cactus(
     Vec vec, const std::vector<int> &varinds,
     const std::vector<std::vector<int> > &component_offsets,
-    const std::vector<std::vector<int> > &component_sizes) {
+    const point_offsets_t &point_offsets) {
   PetscErrorCode ierr;
 
-  int myproc;
-  MPI_Comm_rank(MPI_COMM_WORLD, &myproc);
-
   // Decode Cactus variables
   const int nvars = varinds.size();
   std::vector<int> gis, vis;
@@ -1031,14 +1046,6 @@ void copy_PETSc_to_Cactus(
     assert(vi >= 0);
     vis.push_back(vi);
   }
-  static const int vn_pt = CCTK_VarIndex("PDESolvers::point_type");
-  assert(vn_pt >= 0);
-  static const int gi_pt = CCTK_GroupIndexFromVarI(vn_pt);
-  assert(gi_pt >= 0);
-  static const int v0_pt = CCTK_FirstVarIndexI(gi_pt);
-  assert(v0_pt >= 0);
-  static const int vi_pt = vn_pt - v0_pt;
-  assert(vi_pt >= 0);
 
   // Get vector from PETSc
   const CCTK_REAL *vec_ptr;
@@ -1051,38 +1058,19 @@ void copy_PETSc_to_Cactus(
                                             const int index,
                                             const int component,
                                             const cGH *restrict const cctkGH) {
-    const Loop::GF3D2layout layout1(cctkGH, indextype);
-    const CarpetX::GridDescBase grid(cctkGH);
     const auto &patchdata = CarpetX::ghext->patchdata.at(patch);
     const auto &leveldata = patchdata.leveldata.at(level);
-    const Loop::GF3D2<const CCTK_REAL> gf_pt(
-        layout1,
-        static_cast<const CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, tl, vn_pt)));
-    std::vector<Loop::GF3D2<CCTK_REAL> > gfs;
-    gfs.reserve(nvars);
-    for (int n = 0; n < nvars; ++n)
-      gfs.emplace_back(layout1, static_cast<CCTK_REAL *>(CCTK_VarDataPtrI(
-                                    cctkGH, tl, varinds.at(n))));
-    const int component_offset = component_offsets.at(level).at(component);
-    int nelems = 0;
-    grid.loop_all<0, 0, 0>(
-        grid.nghostzones, [&](const Loop::PointDesc &p) ARITH_INLINE {
-          switch (int(gf_pt(p.I))) {
-          case int(point_type_t::intr):
-            for (int n = 0; n < nvars; ++n)
-              gfs.at(n)(p.I) = petsc_ptr[nvars * component_offset + nelems++];
-            break;
-          case int(point_type_t::bdry):
-          case int(point_type_t::rest):
-          case int(point_type_t::sync):
-          case int(point_type_t::prol):
-            // ignore this point
-            break;
-          default:
-            assert(0);
-          }
-        });
-    assert(nelems == nvars * component_sizes.at(level).at(component));
+    const std::vector<int> &offsets = point_offsets.at(level).at(component);
+    const int npoints = offsets.size();
+    const int *restrict const offsets_ptr = offsets.data();
+    const CCTK_REAL *restrict const ptr =
+        petsc_ptr + nvars * component_offsets.at(level).at(component);
+    for (int n = 0; n < nvars; ++n) {
+      CCTK_REAL *restrict const var_ptr =
+          static_cast<CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, tl, varinds.at(n)));
+      for (int i = 0; i < npoints; ++i)
+        var_ptr[offsets_ptr[i]] = ptr[nvars * i + n];
+    }
     for (int n = 0; n < nvars; ++n)
       leveldata.groupdata.at(gis.at(n))->valid.at(tl).at(vis.at(n)).set_all(
           CarpetX::make_valid_int(),
@@ -1129,6 +1117,44 @@ PetscErrorCode FormJacobian(SNES snes, Vec x, Mat J, Mat B, void *fun) {
           std::function<PetscErrorCode(SNES snes, Vec x, Mat J, Mat B)> *>(
       fun))(snes, x, J, B);
 }
+
+// Matrix-free Jacobian: J v = (F(x0 + h v) - F(x0)) / h
+struct mf_jacobian_t {
+  std::function<PetscErrorCode(Vec x, Vec f)> evalf;
+  CCTK_REAL epsilon;
+  Vec x0, f0, xh;   // base point, residual at base point, perturbed point
+  CCTK_REAL x0norm; // norm of base point
+};
+
+PetscErrorCode JacobianMult(Mat J, Vec v, Vec y) {
+  PetscErrorCode ierr;
+  void *ctx;
+  ierr = MatShellGetContext(J, &ctx);
+  assert(!ierr);
+  const mf_jacobian_t &mf = *static_cast<const mf_jacobian_t *>(ctx);
+
+  PetscReal vnorm;
+  ierr = VecNorm(v, NORM_2, &vnorm);
+  assert(!ierr);
+  if (vnorm == 0) {
+    ierr = VecSet(y, 0);
+    assert(!ierr);
+    return 0;
+  }
+
+  // Choose the step size as PETSc's "wp" method does
+  using std::sqrt;
+  const CCTK_REAL h = mf.epsilon * sqrt(1 + mf.x0norm) / vnorm;
+  ierr = VecWAXPY(mf.xh, h, v, mf.x0);
+  assert(!ierr);
+  ierr = mf.evalf(mf.xh, y);
+  assert(!ierr);
+  ierr = VecAXPY(y, -1, mf.f0);
+  assert(!ierr);
+  ierr = VecScale(y, 1 / h);
+  assert(!ierr);
+  return 0;
+}
 } // namespace
 
 extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
@@ -1155,6 +1181,8 @@ extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
                    component_sizes, npoints_prolongated_local,
                    npoints_prolongated_global, component_prolongated_offsets,
                    component_prolongated_sizes, Jp);
+  point_offsets_t point_offsets;
+  enumerate_point_offsets(point_offsets, component_sizes);
 
   // TODO: fix this
   const std::vector<int> solinds{CCTK_VarIndex("Poisson::sol")};
@@ -1181,42 +1209,102 @@ extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
   ierr = VecSetFromOptions(r);
   assert(!ierr);
 
+  // The PETSc vectors cannot alias the grid functions: each AMReX box
+  // is a separate allocation that interleaves ghost and boundary points
+  // with the solved-for points. Each evaluation thus gathers and
+  // scatters the interior points via `point_offsets`.
+  const auto evalr = [&](Vec x, Vec f) {
+    copy_PETSc_to_Cactus(x, solinds, component_offsets, point_offsets);
+    CallScheduleGroup(cctkGH, "PDESolvers_Residual");
+    copy_Cactus_to_PETSc(f, resinds, component_offsets, point_offsets);
+    return PetscErrorCode(0);
+  };
   std::function<PetscErrorCode(SNES snes, Vec x, Vec f)> evalf =
-      [&](SNES snes, Vec x, Vec f) {
-        copy_PETSc_to_Cactus(x, solinds, component_offsets, component_sizes);
-        CallScheduleGroup(cctkGH, "PDESolvers_Residual");
-        copy_Cactus_to_PETSc(f, resinds, component_offsets, component_sizes);
-        return 0;
-      };
+      [&](SNES snes, Vec x, Vec f) { return evalr(x, f); };
   ierr = SNESSetFunction(snes, r, FormFunction, &evalf);
   assert(!ierr);
 
   // Matrix and Jacobian evaluation function
 
-  Mat J;
-  ierr = MatCreateAIJ(PETSC_COMM_WORLD, nvars * npoints_local,
-                      nvars * npoints_local, nvars * npoints_global,
-                      nvars * npoints_global, dnz, NULL, onz, NULL, &J);
-  assert(!ierr);
-  // ierr = MatCreate(PETSC_COMM_WORLD, &J);
-  // assert(!ierr);
-  // ierr = MatSetSizes(J, nvars * npoints_local, nvars * npoints_local,
-  //                    nvars * npoints_global, nvars * npoints_global);
-  // assert(!ierr);
-  ierr = MatSetFromOptions(J);
-  assert(!ierr);
-  jacobians = std::make_optional<jacobians_t>();
+  // With a matrix-free Jacobian, `J` is a shell matrix and `B` (if
+  // present) is the assembled matrix from which the preconditioner is
+  // built. Otherwise `J` is assembled and `B` is the same as `J`.
+  const bool matrix_free = CCTK_EQUALS(jacobian, "matrix-free");
+  const bool assemble = !matrix_free || !CCTK_EQUALS(preconditioner, "none");
+
+  const auto create_matrix = [&](Mat &A) {
+    ierr = MatCreateAIJ(PETSC_COMM_WORLD, nvars * npoints_local,
+                        nvars * npoints_local, nvars * npoints_global,
+                        nvars * npoints_global, dnz, NULL, onz, NULL, &A);
+    assert(!ierr);
+    // ierr = MatCreate(PETSC_COMM_WORLD, &A);
+    // assert(!ierr);
+    // ierr = MatSetSizes(A, nvars * npoints_local, nvars * npoints_local,
+    //                    nvars * npoints_global, nvars * npoints_global);
+    // assert(!ierr);
+    ierr = MatSetFromOptions(A);
+    assert(!ierr);
+  };
+
+  Mat J, B;
+  mf_jacobian_t mf;
+  if (matrix_free) {
+    mf.evalf = evalr;
+    mf.epsilon = matrix_free_epsilon;
+    ierr = VecDuplicate(r, &mf.x0);
+    assert(!ierr);
+    ierr = VecDuplicate(r, &mf.f0);
+    assert(!ierr);
+    ierr = VecDuplicate(r, &mf.xh);
+    assert(!ierr);
+    ierr = MatCreateShell(PETSC_COMM_WORLD, nvars * npoints_local,
+                          nvars * npoints_local, nvars * npoints_global,
+                          nvars * npoints_global, &mf, &J);
+    assert(!ierr);
+    ierr = MatShellSetOperation(J, MATOP_MULT, (void (*)(void))JacobianMult);
+    assert(!ierr);
+    if (assemble)
+      create_matrix(B);
+    else
+      B = J;
+  } else {
+    create_matrix(J);
+    B = J;
+  }
+  if (assemble)
+    jacobians = std::make_optional<jacobians_t>();
 
   std::function<PetscErrorCode(SNES snes, Vec x, Mat J, Mat B)> evalJ =
       [&](SNES snes, Vec x, Mat J, Mat B) {
-        copy_PETSc_to_Cactus(x, solinds, component_offsets, component_sizes);
+        PetscErrorCode ierr;
+        if (matrix_free) {
+          // Set the base point. We re-evaluate the residual here since
+          // the Cactus grid functions might hold a different state.
+          ierr = VecCopy(x, mf.x0);
+          assert(!ierr);
+          PetscReal x0norm;
+          ierr = VecNorm(mf.x0, NORM_2, &x0norm);
+          assert(!ierr);
+          mf.x0norm = x0norm;
+          ierr = evalr(mf.x0, mf.f0);
+          assert(!ierr);
+          ierr = MatAssemblyBegin(J, MAT_FINAL_ASSEMBLY);
+          assert(!ierr);
+          ierr = MatAssemblyEnd(J, MAT_FINAL_ASSEMBLY);
+          assert(!ierr);
+          if (!assemble)
+            return 0;
+          // `evalr` has already copied `x` into the Cactus grid
+          // functions
+        } else {
+          copy_PETSc_to_Cactus(x, solinds, component_offsets, point_offsets);
+        }
         CallScheduleGroup(cctkGH, "PDESolvers_Jacobian");
-        jacobians->define_matrix(Jp, J);
+        jacobians->define_matrix(Jp, B);
         jacobians->clear();
         if (false) {
           MatInfo info;
-          PetscErrorCode ierr;
-          ierr = MatGetInfo(J, MAT_GLOBAL_SUM, &info);
+          ierr = MatGetInfo(B, MAT_GLOBAL_SUM, &info);
           assert(!ierr);
           CCTK_VINFO("Jacobian info: nz_allocated=%g nz_used=%g nz_unneeded=%g "
                      "memory=%g",
@@ -1225,9 +1313,28 @@ extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
         }
         return 0;
       };
-  ierr = SNESSetJacobian(snes, J, J, FormJacobian, &evalJ);
+  ierr = SNESSetJacobian(snes, J, B, FormJacobian, &evalJ);
   assert(!ierr);
 
+  if (matrix_free) {
+    KSP ksp;
+    ierr = SNESGetKSP(snes, &ksp);
+    assert(!ierr);
+    PC pc;
+    ierr = KSPGetPC(ksp, &pc);
+    assert(!ierr);
+    if (CCTK_EQUALS(preconditioner, "none")) {
+      ierr = PCSetType(pc, PCNONE);
+      assert(!ierr);
+    } else if (CCTK_EQUALS(preconditioner, "multigrid")) {
+      ierr = PCSetType(pc, PCGAMG);
+      assert(!ierr);
+    }
+    // Allow overriding the preconditioner via petsc_options
+    ierr = PCSetFromOptions(pc);
+    assert(!ierr);
+  }
+
   {
     double atol, rtol, stol;
     int maxit, maxf;
@@ -1242,7 +1349,7 @@ extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
   Vec x;
   ierr = VecDuplicate(r, &x);
   assert(!ierr);
-  copy_Cactus_to_PETSc(x, solinds, component_offsets, component_sizes);
+  copy_Cactus_to_PETSc(x, solinds, component_offsets, point_offsets);
 
   // Solve
 
@@ -1295,7 +1402,7 @@ extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
 
   // Extract solution
 
-  copy_PETSc_to_Cactus(x, solinds, component_offsets, component_sizes);
+  copy_PETSc_to_Cactus(x, solinds, component_offsets, point_offsets);
   CallScheduleGroup(cctkGH, "PDESolvers_Residual");
   {
     const int nvars = resinds.size();
@@ -1325,7 +1432,14 @@ extern "C" void PDESolvers_Solve(CCTK_ARGUMENTS) {
   jacobians.reset();
   VecDestroy(&x);
   VecDestroy(&r);
+  if (B != J)
+    MatDestroy(&B);
   MatDestroy(&J);
+  if (matrix_free) {
+    VecDestroy(&mf.x0);
+    VecDestroy(&mf.f0);
+    VecDestroy(&mf.xh);
+  }
   SNESDestroy(&snes);
   CCTK_INFO("Done.");
 }
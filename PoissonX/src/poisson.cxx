@@ -2,12 +2,11 @@
 #include "../../CarpetX/src/driver.hxx"
 
 #include <pdesolvers.hxx>
+#include <reduction.hxx>
 
 #include <defs.hxx>
-#include <dual.hxx>
 #include <loop.hxx>
-#include <smallvector.hxx>
-#include <spvect.hxx>
+#include <simd.hxx>
 #include <vect.hxx>
 
 #include <cctk.h>
@@ -15,14 +14,38 @@
 #include <cctk_Parameters.h>
 
 #include <array>
+#include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
-#include <utility>
+#include <type_traits>
 
 namespace PoissonX {
 
 constexpr int dim = Loop::dim;
 
+// Exact solution for the "eigenfunction" source. It vanishes on the
+// boundaries of the domain [-1,1]^3 and is an eigenfunction of the
+// second-order discrete Laplace operator on a vertex-centred grid.
+CCTK_REAL eigenfunction(const Arith::vect<CCTK_REAL, dim> &X) {
+  using std::cos;
+  CCTK_REAL u = 1;
+  for (int d = 0; d < dim; ++d)
+    u *= cos(M_PI / 2 * X[d]);
+  return u;
+}
+
+// Eigenvalue of the second-order discrete Laplace operator for the
+// eigenfunction above
+CCTK_REAL eigenvalue(const Arith::vect<CCTK_REAL, dim> &DX) {
+  using Arith::pow2;
+  using std::sin;
+  CCTK_REAL lambda = 0;
+  for (int d = 0; d < dim; ++d)
+    lambda -= 4 * pow2(sin(M_PI / 4 * DX[d])) / pow2(DX[d]);
+  return lambda;
+}
+
 extern "C" void PoissonX_Source(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTS_PoissonX_Source;
   DECLARE_CCTK_PARAMETERS;
@@ -61,6 +84,13 @@ extern "C" void PoissonX_Source(CCTK_ARGUMENTS) {
             gf_src(p.I) = 0;
           }
         });
+  } else if (CCTK_EQUALS(source, "eigenfunction")) {
+    if (fdorder != 2)
+      CCTK_ERROR("The \"eigenfunction\" source requires fdorder=2");
+    grid.loop_all<0, 0, 0>(
+        grid.nghostzones, [=](const Loop::PointDesc &p) ARITH_INLINE {
+          gf_src(p.I) = eigenvalue(p.DX) * eigenfunction(p.X);
+        });
   } else {
     CCTK_ERROR("Unknown value for parameter \"source\"");
   }
@@ -107,36 +137,39 @@ extern "C" void PoissonX_Boundaries(CCTK_ARGUMENTS) {
                              ARITH_INLINE { gf_sol(p.I) = 0; });
 }
 
-constexpr std::size_t max_small_size = 16;
-template <typename T>
-using smallvector1 = Arith::smallvector<T, max_small_size>;
-template <typename T>
-using spvect1 = Arith::spvect<Arith::vect<int, dim>, T, smallvector1>;
-template <typename T> using dual1 = Arith::dual<T, spvect1<T> >;
-
-template <typename T>
-dual1<T> residual(const int fdorder, const Loop::GF3D2<const T> &point_type,
-                  const Loop::GF3D2<const T> &sol_,
-                  const Loop::GF3D2<const T> &src, const Loop::PointDesc &p) {
-  const auto sol = [&](const Arith::vect<int, dim> &I) {
-    const T val = sol_(I);
-    spvect1<T> eps;
-    eps.emplace_back(I, 1);
-    return dual1<T>(val, std::move(eps));
-  };
-
-  assert(point_type(p.I) == 1 /*intr*/ || point_type(p.I) == 5 /*rest*/);
+// Stencil of the discrete Laplace operator
+template <int fdorder>
+constexpr std::array<Arith::vect<int, dim>, 1 + dim * fdorder>
+laplace_stencil() {
+  std::array<Arith::vect<int, dim>, 1 + dim * fdorder> stencil{};
+  int n = 0;
+  stencil[n++] = Arith::vect<int, dim>::pure(0);
+  for (int d = 0; d < dim; ++d)
+    for (int i = 1; i <= fdorder / 2; ++i) {
+      stencil[n++] = -i * Arith::vect<int, dim>::unit(d);
+      stencil[n++] = +i * Arith::vect<int, dim>::unit(d);
+    }
+  return stencil;
+}
+
+// SIMD-vectorized residual, generic in the type of the solution. This
+// is used both to evaluate the residual and to assemble the Jacobian.
+template <int fdorder, typename Sol>
+auto laplace_residual(const Loop::PointDesc &p,
+                      const Loop::GF3D2<const CCTK_REAL> &point_type,
+                      const Sol &sol, const CCTK_REALVEC &src) {
+  using R = std::invoke_result_t<Sol, Arith::vect<int, dim> >;
   using Arith::pow2;
-  dual1<T> ddsol = 0;
-  switch (fdorder) {
-  case 2:
+  assert(all(!p.mask || point_type(p.mask, p.I) == 1 /*intr*/ ||
+             point_type(p.mask, p.I) == 5 /*rest*/));
+  R ddsol = Arith::zero<R>()();
+  if constexpr (fdorder == 2) {
     for (int d = 0; d < dim; ++d)
       ddsol += (sol(p.I - p.DI[d]) //
                 - 2 * sol(p.I)     //
                 + sol(p.I + p.DI[d])) /
                pow2(p.DX[d]);
-    break;
-  case 4:
+  } else if constexpr (fdorder == 4) {
     for (int d = 0; d < dim; ++d)
       ddsol += (-1 / 12.0 * sol(p.I - 2 * p.DI[d]) //
                 + 4 / 3.0 * sol(p.I - p.DI[d])     //
@@ -144,12 +177,10 @@ dual1<T> residual(const int fdorder, const Loop::GF3D2<const T> &point_type,
                 + 4 / 3.0 * sol(p.I + p.DI[d])     //
                 - 1 / 12.0 * sol(p.I + 2 * p.DI[d])) /
                pow2(p.DX[d]);
-    break;
-  default:
-    assert(0);
-    abort();
+  } else {
+    static_assert(fdorder == 2 || fdorder == 4);
   }
-  return ddsol - src(p.I);
+  return ddsol - src;
 }
 
 extern "C" void PoissonX_Residual(CCTK_ARGUMENTS) {
@@ -170,38 +201,35 @@ extern "C" void PoissonX_Residual(CCTK_ARGUMENTS) {
   const Loop::GF3D2<const CCTK_REAL> gf_src(layout1, src);
   const Loop::GF3D2<CCTK_REAL> gf_res(layout1, res);
 
-  grid.loop_int<0, 0, 0>(grid.nghostzones,
-                         [=](const Loop::PointDesc &p) ARITH_INLINE {
-#if 0
-        assert(gf_point_type(p.I) == 1);
-        using Arith::pow2;
-        CCTK_REAL ddsol = 0;
-        switch (fdorder) {
-        case 2:
-          for (int d = 0; d < dim; ++d)
-            ddsol += (gf_sol(p.I - p.DI[d]) //
-                      - 2 * gf_sol(p.I)     //
-                      + gf_sol(p.I + p.DI[d])) /
-                     pow2(p.DX[d]);
-          break;
-        case 4:
-          for (int d = 0; d < dim; ++d)
-            ddsol += (-1 / 12.0 * gf_sol(p.I - 2 * p.DI[d]) //
-                      + 4 / 3.0 * gf_sol(p.I - p.DI[d])     //
-                      - 5 / 2.0 * gf_sol(p.I)               //
-                      + 4 / 3.0 * gf_sol(p.I + p.DI[d])     //
-                      - 1 / 12.0 * gf_sol(p.I + 2 * p.DI[d])) /
-                     pow2(p.DX[d]);
-          break;
-        default:
-          assert(0);
-          abort();
-        }
-        gf_res(p.I) = ddsol - gf_src(p.I);
-#else
-        gf_res(p.I) = residual(fdorder,gf_point_type,gf_sol,gf_src,p).val;
-#endif
-                         });
+  constexpr std::size_t vsize = CCTK_VECSIZE;
+
+  switch (fdorder) {
+  case 2:
+    grid.loop_int<0, 0, 0, vsize>(
+        grid.nghostzones, [=](const Loop::PointDesc &p) ARITH_INLINE {
+          const auto sol = [&](const Arith::vect<int, dim> &I) {
+            return gf_sol(p.mask, I);
+          };
+          gf_res.store(p.mask, p.I,
+                       laplace_residual<2>(p, gf_point_type, sol,
+                                           gf_src(p.mask, p.I)));
+        });
+    break;
+  case 4:
+    grid.loop_int<0, 0, 0, vsize>(
+        grid.nghostzones, [=](const Loop::PointDesc &p) ARITH_INLINE {
+          const auto sol = [&](const Arith::vect<int, dim> &I) {
+            return gf_sol(p.mask, I);
+          };
+          gf_res.store(p.mask, p.I,
+                       laplace_residual<4>(p, gf_point_type, sol,
+                                           gf_src(p.mask, p.I)));
+        });
+    break;
+  default:
+    assert(0);
+    abort();
+  }
 }
 
 extern "C" void PoissonX_ResidualSync(CCTK_ARGUMENTS) {
@@ -227,6 +255,30 @@ extern "C" void PoissonX_ResidualBoundaries(CCTK_ARGUMENTS) {
                          });
 }
 
+extern "C" void PoissonX_Error(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_PoissonX_Error;
+
+  const std::array<int, dim> indextype = {0, 0, 0};
+  const Loop::GF3D2layout layout1(cctkGH, indextype);
+  const Loop::GridDescBase grid(cctkGH);
+
+  const Loop::GF3D2<const CCTK_REAL> gf_sol(layout1, sol);
+  const Loop::GF3D2<CCTK_REAL> gf_err(layout1, err);
+
+  grid.loop_int<0, 0, 0>(grid.nghostzones,
+                         [=](const Loop::PointDesc &p) ARITH_INLINE {
+                           gf_err(p.I) = gf_sol(p.I) - eigenfunction(p.X);
+                         });
+}
+
+extern "C" void PoissonX_MaxError(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_PoissonX_MaxError;
+
+  const int gi = CCTK_GroupIndex("PoissonX::err");
+  assert(gi >= 0);
+  *max_error = CarpetX::reduce(gi, 0, 0).maxabs;
+}
+
 extern "C" void PoissonX_Jacobian(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTS_PoissonX_Jacobian;
   DECLARE_CCTK_PARAMETERS;
@@ -245,47 +297,27 @@ extern "C" void PoissonX_Jacobian(CCTK_ARGUMENTS) {
 
   const int fdorder1 = fdorder_jac < 0 ? fdorder : fdorder_jac;
 
-  grid.loop_int<0, 0, 0>(
-      grid.nghostzones, [=, &J](const Loop::PointDesc &p) ARITH_INLINE {
-        const auto getidx = [&](const Arith::vect<int, dim> &I) {
-          return int(gf_idx(I));
-        };
-        const int idx = getidx(p.I);
-#if 0
-        assert(gf_point_type(p.I) == 1);
-        using Arith::pow2;
-        switch (fdorder1) {
-        case 2:
-          for (int d = 0; d < dim; ++d) {
-            assert(getidx(p.I - p.DI[d]) >= 0);
-            assert(getidx(p.I + p.DI[d]) >= 0);
-            J.add_value(idx, getidx(p.I - p.DI[d]), 1 / pow2(p.DX[d]));
-            J.add_value(idx, getidx(p.I), -2 / pow2(p.DX[d]));
-            J.add_value(idx, getidx(p.I + p.DI[d]), 1 / pow2(p.DX[d]));
-          }
-          break;
-        case 4:
-          for (int d = 0; d < dim; ++d) {
-            J.add_value(idx, getidx(p.I - 2 * p.DI[d]),
-                        -1 / 12.0 / pow2(p.DX[d]));
-            J.add_value(idx, getidx(p.I - p.DI[d]), 4 / 3.0 / pow2(p.DX[d]));
-            J.add_value(idx, getidx(p.I), -5 / 2.0 / pow2(p.DX[d]));
-            J.add_value(idx, getidx(p.I + p.DI[d]), 4 / 3.0 / pow2(p.DX[d]));
-            J.add_value(idx, getidx(p.I + 2 * p.DI[d]),
-                        -1 / 12.0 / pow2(p.DX[d]));
-          }
-          break;
-        default:
-          assert(0);
-          abort();
-        }
-#else
-        const auto row =
-            residual(fdorder1, gf_point_type, gf_sol, gf_src, p).eps;
-        for (const auto &elt : row)
-          J.add_value(idx, getidx(elt.first), elt.second);
-#endif
-      });
+  switch (fdorder1) {
+  case 2:
+    PDESolvers::assemble_jacobian<0, 0, 0>(
+        grid, gf_idx, gf_sol, laplace_stencil<2>(), J,
+        [&](const Loop::PointDesc &p, const auto &sol) {
+          return laplace_residual<2>(p, gf_point_type, sol,
+                                     gf_src(p.mask, p.I));
+        });
+    break;
+  case 4:
+    PDESolvers::assemble_jacobian<0, 0, 0>(
+        grid, gf_idx, gf_sol, laplace_stencil<4>(), J,
+        [&](const Loop::PointDesc &p, const auto &sol) {
+          return laplace_residual<4>(p, gf_point_type, sol,
+                                     gf_src(p.mask, p.I));
+        });
+    break;
+  default:
+    assert(0);
+    abort();
+  }
 }
 
 } // namespace PoissonX
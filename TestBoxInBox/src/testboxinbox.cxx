@@ -1,7 +1,12 @@
+#include <loop_device.hxx>
+#include <reduction.hxx>
+
 #include <cctk.h>
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
+#include <cassert>
+
 namespace TestBoxInBox {
 
 extern "C" void TestBoxInBox_Update(CCTK_ARGUMENTS) {
@@ -10,4 +15,30 @@ extern "C" void TestBoxInBox_Update(CCTK_ARGUMENTS) {
   position_x[0] = -0.5 + 0.1 * cctk_iteration;
 }
 
-} // namespace BoxInBox
+// The local-mode cctkGHs and their grid function pointers are set up
+// once per level. Writing the iteration number in every iteration
+// checks that they follow the data when time levels are cycled and
+// when retained boxes are moved into a regridded level.
+extern "C" void TestBoxInBox_SetIteration(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestBoxInBox_SetIteration;
+
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        itnum(p.I) = cctk_iteration;
+      });
+}
+
+// Both values equal the current iteration number unless a scheduled
+// function wrote into stale memory
+extern "C" void TestBoxInBox_CheckIteration(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestBoxInBox_CheckIteration;
+
+  const int gi = CCTK_GroupIndex("TestBoxInBox::iteration_number");
+  assert(gi >= 0);
+  const auto red = CarpetX::reduce(gi, 0, 0);
+  *itnum_min = red.min;
+  *itnum_max = red.max;
+}
+
+} // namespace TestBoxInBox
@@ -5,11 +5,16 @@
 #include <simd.hxx>
 #include <vec.hxx>
 #include <derivs.hxx>
+#include <reduction.hxx>
 
 #include <cctk.h>
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
+#include <array>
+#include <cstddef>
+#include <vector>
+
 namespace TestDerivs {
 using namespace Loop;
 using namespace std;
@@ -20,6 +25,33 @@ constexpr void poly(const T kxx, const T kxy, const T kyz, const VT x,
   u = kxx * x * x + kxy * x * y + kyz * y * z;
 }
 
+CCTK_DEVICE CCTK_HOST inline CCTK_REAL ipow(const CCTK_REAL x, const int n) {
+  CCTK_REAL r = 1;
+  for (int i = 0; i < n; ++i)
+    r *= x;
+  return r;
+}
+
+// Polynomial of degree `n` in each direction and its gradient. Upwinding
+// of order `n` is exact for it, and the matching dissipation vanishes.
+CCTK_DEVICE CCTK_HOST inline CCTK_REAL poly_n(const int n, const CCTK_REAL x,
+                                              const CCTK_REAL y,
+                                              const CCTK_REAL z) {
+  return ipow(x, n) + ipow(y, n) + ipow(z, n) + x * y * z;
+}
+CCTK_DEVICE CCTK_HOST inline Arith::vec<CCTK_REAL, dim>
+dpoly_n(const int n, const CCTK_REAL x, const CCTK_REAL y, const CCTK_REAL z) {
+  return {n * ipow(x, n - 1) + y * z, n * ipow(y, n - 1) + x * z,
+          n * ipow(z, n - 1) + x * y};
+}
+
+// Advection velocity for upwinding, with both signs in each direction
+CCTK_DEVICE CCTK_HOST inline Arith::vec<CCTK_REAL, dim>
+velocity(const CCTK_REAL x, const CCTK_REAL y, const CCTK_REAL z) {
+  using std::cos, std::sin;
+  return {sin(y) + CCTK_REAL(0.5), cos(z) - x / 4, -sin(x)};
+}
+
 extern "C" void TestDerivs_SetError(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTSX_TestDerivs_SetError;
   DECLARE_CCTK_PARAMETERS;
@@ -53,6 +85,16 @@ extern "C" void TestDerivs_Set(CCTK_ARGUMENTS) {
         poly(kxx, kxy, kyz, Arith::cos(x0), std::sin(y0), std::sin(z0), u0);
 
         chi.store(mask, p.I, u0);
+
+        // Use different polynomials for the batched grid functions
+        const std::array<GF3D2<CCTK_REAL>, 5> batch_chis{
+            batch_chi0, batch_chi1, batch_chi2, batch_chi3, batch_chi4};
+        for (int n = 0; n < int(batch_chis.size()); ++n) {
+          vreal un;
+          poly(kxx + n, kxy - n, kyz + 2 * n, Arith::cos(x0), std::sin(y0),
+               std::sin(z0), un);
+          batch_chis[n].store(mask, p.I, un);
+        }
       });
 }
 
@@ -62,6 +104,40 @@ extern "C" void TestDerivs_Sync(CCTK_ARGUMENTS) {
   // do nothing
 }
 
+// Compare the tile-based derivatives `t5_dchi` and `t5_ddchi` to the
+// pointwise operators with run-time strides
+template <int deriv_order>
+void calc_fixed_diff(const GridDescBaseDevice &grid,
+                     const GF3D2<const CCTK_REAL> &gf2_chi,
+                     const Arith::vec<GF3D5<CCTK_REAL>, dim> &t5_dchi,
+                     const Arith::smat<GF3D5<CCTK_REAL>, dim> &t5_ddchi,
+                     const GF3D5layout &layout5,
+                     const Arith::vect<CCTK_REAL, dim> &dx,
+                     const GF3D2<CCTK_REAL> &gf_diff) {
+  using Arith::vec, Arith::smat;
+  typedef Arith::simd<CCTK_REAL> vreal;
+  typedef Arith::simdl<CCTK_REAL> vbool;
+  constexpr size_t vsize = tuple_size_v<vreal>;
+  grid.loop_int_device<0, 0, 0, vsize>(
+      grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+        const vbool mask = Arith::mask_for_loop_tail<vbool>(p.i, p.imax);
+        const GF3D5index index5(layout5, p.I);
+        const vec<vreal, dim> dchi =
+            Derivs::calc_deriv<deriv_order>(gf2_chi, mask, p.I, dx);
+        const smat<vreal, dim> ddchi =
+            Derivs::calc_deriv2<deriv_order>(gf2_chi, mask, p.I, dx);
+        const vec<vreal, dim> dchi5 = t5_dchi(mask, index5);
+        const smat<vreal, dim> ddchi5 = t5_ddchi(mask, index5);
+        vreal diff = 0;
+        for (int a = 0; a < dim; ++a) {
+          diff = fmax(diff, fabs(dchi5(a) - dchi(a)));
+          for (int b = a; b < dim; ++b)
+            diff = fmax(diff, fabs(ddchi5(a, b) - ddchi(a, b)));
+        }
+        gf_diff.store(mask, p.I, diff);
+      });
+}
+
 extern "C" void TestDerivs_CalcDerivs(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTS_TestDerivs_CalcDerivs;
   DECLARE_CCTK_PARAMETERS;
@@ -130,6 +206,26 @@ extern "C" void TestDerivs_CalcDerivs(CCTK_ARGUMENTS) {
         gf_ddchi.store(mask, index2, t5_ddchi(mask, index5));
       });
 
+  // `calc_derivs2` uses fixed strides if the component has one of the
+  // shapes for which they are instantiated
+  const GF3D2<CCTK_REAL> gf_fixed_diff(layout2, fixed_diff);
+  switch (deriv_order) {
+  case 2:
+    calc_fixed_diff<2>(grid, gf2_chi, t5_dchi, t5_ddchi, layout5, dx,
+                       gf_fixed_diff);
+    break;
+  case 4:
+    calc_fixed_diff<4>(grid, gf2_chi, t5_dchi, t5_ddchi, layout5, dx,
+                       gf_fixed_diff);
+    break;
+  case 6:
+    calc_fixed_diff<6>(grid, gf2_chi, t5_dchi, t5_ddchi, layout5, dx,
+                       gf_fixed_diff);
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", int(deriv_order));
+  }
+
 #if CCTK_DEBUG
   grid.loop_int_device<0, 0, 0>(
       grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
@@ -166,4 +262,230 @@ extern "C" void TestDerivs_CalcDerivs(CCTK_ARGUMENTS) {
 #endif
 }
 
+extern "C" void TestDerivs_CalcBatchedDerivs(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestDerivs_CalcBatchedDerivs;
+  DECLARE_CCTK_PARAMETERS;
+
+  using Arith::vect, Arith::vec, Arith::smat;
+
+  const array<int, dim> indextype = {0, 0, 0};
+  const array<int, dim> nghostzones = {cctk_nghostzones[0], cctk_nghostzones[1],
+                                       cctk_nghostzones[2]};
+  vect<int, dim> imin, imax;
+  GridDescBase(cctkGH).box_int<0, 0, 0>(nghostzones, imin, imax);
+  const GF3D2layout layout2(cctkGH, indextype);
+  const GF3D5layout layout5(imin, imax);
+
+  const GridDescBaseDevice grid(cctkGH);
+  const vect<CCTK_REAL, dim> dx(std::array<CCTK_REAL, dim>{
+      CCTK_DELTA_SPACE(0),
+      CCTK_DELTA_SPACE(1),
+      CCTK_DELTA_SPACE(2),
+  });
+
+  // Five grid functions are processed in one full and one partial batch
+  const std::vector<GF3D2<const CCTK_REAL> > gf0s{
+      GF3D2<const CCTK_REAL>(layout2, batch_chi0),
+      GF3D2<const CCTK_REAL>(layout2, batch_chi1),
+      GF3D2<const CCTK_REAL>(layout2, batch_chi2),
+      GF3D2<const CCTK_REAL>(layout2, batch_chi3),
+      GF3D2<const CCTK_REAL>(layout2, batch_chi4)};
+  const int nvars = gf0s.size();
+
+  // Value, first derivatives, and second derivatives
+  constexpr int ncomps1 = 1 + dim;
+  constexpr int ncomps2 = 1 + dim + dim * (dim + 1) / 2;
+  const GF3D5vector<CCTK_REAL> tmps1(layout5, ncomps1 * nvars);
+  const GF3D5vector<CCTK_REAL> tmps2(layout5, ncomps2 * nvars);
+  Derivs::calc_derivs_batched<0, 0, 0>(tmps1, gf0s, grid, dx, deriv_order);
+  Derivs::calc_derivs2_batched<0, 0, 0>(tmps2, gf0s, grid, dx, deriv_order);
+
+  const GF3D5vector<CCTK_REAL> vars(layout5, ncomps2);
+  const GF3D5<CCTK_REAL> t5_chi(vars(0));
+  const vec<GF3D5<CCTK_REAL>, dim> t5_dchi{vars(1), vars(2), vars(3)};
+  const smat<GF3D5<CCTK_REAL>, dim> t5_ddchi{vars(4), vars(5), vars(6),
+                                             vars(7), vars(8), vars(9)};
+
+  // The components of a GF3D5vector are stored contiguously
+  const std::ptrdiff_t np = layout5.np;
+  const CCTK_REAL *const ptr = vars(0).ptr;
+  const GF3D2<CCTK_REAL> gf_batched_diff(layout2, batched_diff);
+  for (int n = 0; n < nvars; ++n) {
+    Derivs::calc_derivs2<0, 0, 0>(t5_chi, t5_dchi, t5_ddchi, layout5, grid,
+                                  gf0s[n], dx, deriv_order);
+
+    const CCTK_REAL *const ptr1 = tmps1(ncomps1 * n).ptr;
+    const CCTK_REAL *const ptr2 = tmps2(ncomps2 * n).ptr;
+    grid.loop_int_device<0, 0, 0>(
+        grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+          const int index5 = GF3D5index(layout5, p.I).linear();
+          CCTK_REAL diff = n == 0 ? 0 : gf_batched_diff(p.I);
+          for (int c = 0; c < ncomps2; ++c) {
+            const CCTK_REAL val = ptr[c * np + index5];
+            if (c < ncomps1)
+              diff = fmax(diff, fabs(ptr1[c * np + index5] - val));
+            diff = fmax(diff, fabs(ptr2[c * np + index5] - val));
+          }
+          gf_batched_diff(p.I) = diff;
+        });
+  }
+}
+
+extern "C" void TestDerivs_CalcUpwindDissipation(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TestDerivs_CalcUpwindDissipation;
+  DECLARE_CCTK_PARAMETERS;
+
+  using Arith::vect, Arith::vec, Arith::smat;
+
+  const array<int, dim> indextype = {0, 0, 0};
+  const array<int, dim> nghostzones = {cctk_nghostzones[0], cctk_nghostzones[1],
+                                       cctk_nghostzones[2]};
+  vect<int, dim> imin, imax;
+  GridDescBase(cctkGH).box_int<0, 0, 0>(nghostzones, imin, imax);
+  const GF3D2layout layout2(cctkGH, indextype);
+  const GF3D5layout layout5(imin, imax);
+
+  const GF3D2<CCTK_REAL> gf_upwind_diff(layout2, upwind_diff);
+  const GF3D2<CCTK_REAL> gf_diss_diff(layout2, diss_diff);
+  const GF3D2<CCTK_REAL> gf_fused_diff(layout2, fused_diff);
+
+  const GridDescBaseDevice grid(cctkGH);
+
+  // Set the polynomial in the ghost zones as well, since it is not
+  // periodic
+  const GF3D2<CCTK_REAL> gf_poly_chi(layout2, poly_chi);
+  grid.loop_all_device<0, 0, 0>(
+      grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+        gf_poly_chi(p.I) = poly_n(deriv_order, p.x, p.y, p.z);
+      });
+  const GF3D2<const CCTK_REAL> gf2_poly_chi(layout2, poly_chi);
+
+  if (!test_upwind_dissipation) {
+    grid.loop_int_device<0, 0, 0>(
+        grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+          gf_upwind_diff(p.I) = 0;
+          gf_diss_diff(p.I) = 0;
+          gf_fused_diff(p.I) = 0;
+        });
+    return;
+  }
+
+  for (int d = 0; d < dim; ++d)
+    if (cctk_nghostzones[d] < deriv_order / 2 + 1)
+      CCTK_VERROR("Testing upwinding and dissipation with derivative order %d "
+                  "requires at least %d ghost zones",
+                  int(deriv_order), int(deriv_order / 2 + 1));
+
+  // Upwinding is implemented for derivative orders 2 and 4 only
+  const bool have_upwind = deriv_order <= 4;
+
+  const vect<CCTK_REAL, dim> dx(std::array<CCTK_REAL, dim>{
+      CCTK_DELTA_SPACE(0),
+      CCTK_DELTA_SPACE(1),
+      CCTK_DELTA_SPACE(2),
+  });
+  const CCTK_REAL eps = 0.3;
+
+  constexpr int nvars = 27;
+  GF3D5vector<CCTK_REAL> vars(layout5, nvars);
+
+  int ivar = 0;
+  const auto make_gf = [&]() { return GF3D5<CCTK_REAL>(vars(ivar++)); };
+  const auto make_vec = [&](const auto &f) {
+    return vec<invoke_result_t<decltype(f)>, dim>([&](int) { return f(); });
+  };
+  const auto make_mat = [&](const auto &f) {
+    return smat<invoke_result_t<decltype(f)>, dim>([&](int, int) { return f(); });
+  };
+  const auto make_vec_gf = [&]() { return make_vec(make_gf); };
+  const auto make_mat_gf = [&]() { return make_mat(make_gf); };
+
+  const vec<GF3D5<CCTK_REAL>, dim> t5_beta(make_vec_gf());
+  const GF3D5<CCTK_REAL> t5_adv(make_gf());
+  const GF3D5<CCTK_REAL> t5_diss(make_gf());
+  // Results of the fused kernel
+  const GF3D5<CCTK_REAL> t5_chi(make_gf());
+  const vec<GF3D5<CCTK_REAL>, dim> t5_dchi(make_vec_gf());
+  const smat<GF3D5<CCTK_REAL>, dim> t5_ddchi(make_mat_gf());
+  const GF3D5<CCTK_REAL> t5_fused_adv(make_gf());
+  const GF3D5<CCTK_REAL> t5_fused_diss(make_gf());
+  // Results of `calc_derivs2`
+  const GF3D5<CCTK_REAL> t5_chi2(make_gf());
+  const vec<GF3D5<CCTK_REAL>, dim> t5_dchi2(make_vec_gf());
+  const smat<GF3D5<CCTK_REAL>, dim> t5_ddchi2(make_mat_gf());
+  assert(ivar == nvars);
+
+  grid.loop_int_device<0, 0, 0>(
+      grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+        const GF3D5index index5(layout5, p.I);
+        const vec<CCTK_REAL, dim> vel = velocity(p.x, p.y, p.z);
+        for (int d = 0; d < dim; ++d)
+          t5_beta(d).store(index5, vel(d));
+      });
+
+  Derivs::calc_dissipation<0, 0, 0>(t5_diss, layout5, grid, gf2_poly_chi, dx,
+                                    eps, deriv_order);
+  if (have_upwind) {
+    Derivs::calc_upwind_advection<0, 0, 0>(t5_adv, layout5, grid,
+                                           gf2_poly_chi, t5_beta, dx,
+                                           deriv_order);
+    Derivs::calc_derivs2_advection_dissipation<0, 0, 0>(
+        t5_chi, t5_dchi, t5_ddchi, t5_fused_adv, t5_fused_diss, layout5, grid,
+        gf2_poly_chi, t5_beta, dx, eps, deriv_order);
+    Derivs::calc_derivs2<0, 0, 0>(t5_chi2, t5_dchi2, t5_ddchi2, layout5, grid,
+                                  gf2_poly_chi, dx, deriv_order);
+  }
+
+  // Compare relative to the magnitude of the polynomial to allow for
+  // round-off errors
+  grid.loop_int_device<0, 0, 0>(
+      grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+        const GF3D5index index5(layout5, p.I);
+        const CCTK_REAL scale =
+            ipow(1 + fabs(p.x) + fabs(p.y) + fabs(p.z), deriv_order);
+
+        if (!have_upwind) {
+          gf_diss_diff(p.I) = fabs(t5_diss(index5)) / scale;
+          gf_upwind_diff(p.I) = 0;
+          gf_fused_diff(p.I) = 0;
+          return;
+        }
+
+        gf_diss_diff(p.I) =
+            fmax(fabs(t5_diss(index5)), fabs(t5_fused_diss(index5))) / scale;
+
+        const vec<CCTK_REAL, dim> vel = velocity(p.x, p.y, p.z);
+        const vec<CCTK_REAL, dim> dchi = dpoly_n(deriv_order, p.x, p.y, p.z);
+        CCTK_REAL adv = 0;
+        for (int d = 0; d < dim; ++d)
+          adv += vel(d) * dchi(d);
+        gf_upwind_diff(p.I) = fmax(fabs(t5_adv(index5) - adv),
+                                   fabs(t5_fused_adv(index5) - adv)) /
+                              scale;
+
+        CCTK_REAL diff = fabs(t5_chi(index5) - t5_chi2(index5));
+        for (int a = 0; a < dim; ++a) {
+          diff = fmax(diff, fabs(t5_dchi(a)(index5) - t5_dchi2(a)(index5)));
+          for (int b = a; b < dim; ++b)
+            diff = fmax(diff, fabs(t5_ddchi(a, b)(index5) -
+                                   t5_ddchi2(a, b)(index5)));
+        }
+        diff = fmax(diff, fabs(t5_fused_adv(index5) - t5_adv(index5)));
+        diff = fmax(diff, fabs(t5_fused_diss(index5) - t5_diss(index5)));
+        gf_fused_diff(p.I) = diff / scale;
+      });
+}
+
+extern "C" void TestDerivs_MaxDiffs(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestDerivs_MaxDiffs;
+
+  const int gi = CCTK_GroupIndex("TestDerivs::diffs");
+  assert(gi >= 0);
+  *max_fixed_diff = CarpetX::reduce(gi, 0, 0).maxabs;
+  *max_batched_diff = CarpetX::reduce(gi, 1, 0).maxabs;
+  *max_upwind_diff = CarpetX::reduce(gi, 2, 0).maxabs;
+  *max_diss_diff = CarpetX::reduce(gi, 3, 0).maxabs;
+  *max_fused_diff = CarpetX::reduce(gi, 4, 0).maxabs;
+}
+
 } // namespace TestDerivs
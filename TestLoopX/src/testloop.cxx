@@ -3,6 +3,10 @@
 #include <cctk_Parameters.h>
 #include <loop.hxx>
 #include <loop_device.hxx>
+#include <reduction.hxx>
+
+#include <cassert>
+#include <cmath>
 
 namespace TestLoopX {
 using namespace Loop;
@@ -42,4 +46,166 @@ extern "C" void TestLoopX_OutermostInterior(CCTK_ARGUMENTS) {
       });
 }
 
+extern "C" void TestLoopX_PipelineInit(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestLoopX_PipelineInit;
+  DECLARE_CCTK_PARAMETERS;
+
+  grid.loop_int_device<0, 0, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE CCTK_HOST(const PointDesc &p)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE {
+          using std::cos, std::sin;
+          constexpr CCTK_REAL k = M_PI / 10;
+          pipeline_input(p.I) =
+              sin(k * p.x) * cos(2 * k * p.y) + sin(3 * k * p.z);
+      });
+}
+
+// Undivided Laplacian of `u` at point `I`
+template <typename F>
+CCTK_DEVICE CCTK_HOST inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_REAL
+laplacian(const F &u, const vect<int, dim> &I, const PointDesc &p) {
+  CCTK_REAL r = 0;
+  for (int d = 0; d < dim; ++d)
+    r += u(I - p.DI[d]) - 2 * u(I) + u(I + p.DI[d]);
+  return r;
+}
+
+// Apply the Laplacian twice, once as a single fused kernel that
+// recalculates the inner Laplacian at every stencil point, and once as
+// a two-stage pipeline that stores the inner Laplacian in a temporary.
+// Both evaluate the same expressions, so they have to agree.
+extern "C" void TestLoopX_Pipeline(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestLoopX_Pipeline;
+  DECLARE_CCTK_PARAMETERS;
+
+  grid.loop_int_device<0, 0, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE CCTK_HOST(const PointDesc &p)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE {
+          const auto input = [&](const vect<int, dim> &I) {
+            return pipeline_input(I);
+          };
+          const auto lap_input = [&](const vect<int, dim> &I) {
+            return laplacian(input, I, p);
+          };
+          pipeline_fused(p.I) = laplacian(lap_input, p.I, p);
+      });
+
+  // Use small blocks so that each tile consists of several blocks,
+  // including partial ones
+  const vect<int, dim> block_size{4, 4, 4};
+  const int ntmps = 1;
+  grid.loop_int_pipeline_device<0, 0, 0>(
+      grid.nghostzones, block_size, ntmps,
+      pipeline_stage(1,
+                     [=] CCTK_DEVICE CCTK_HOST(
+                         const PointDesc &p, const GF3D5block<CCTK_REAL> &tmp)
+                         CCTK_ATTRIBUTE_ALWAYS_INLINE {
+                           const auto input = [&](const vect<int, dim> &I) {
+                             return pipeline_input(I);
+                           };
+                           tmp(0)(tmp.layout, p.I) = laplacian(input, p.I, p);
+                         }),
+      pipeline_stage(1,
+                     [=] CCTK_DEVICE CCTK_HOST(
+                         const PointDesc &p, const GF3D5block<CCTK_REAL> &tmp)
+                         CCTK_ATTRIBUTE_ALWAYS_INLINE {
+                           const auto lap_input = [&](const vect<int, dim> &I) {
+                             return tmp(0)(tmp.layout, I);
+                           };
+                           pipeline_blocked(p.I) =
+                               laplacian(lap_input, p.I, p);
+                         }));
+
+  grid.loop_int_device<0, 0, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE CCTK_HOST(const PointDesc &p)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE {
+          pipeline_diff(p.I) = pipeline_blocked(p.I) - pipeline_fused(p.I);
+      });
+}
+
+extern "C" void TestLoopX_PipelineError(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestLoopX_PipelineError;
+
+  const int gi = CCTK_GroupIndex("TestLoopX::pipeline_results");
+  assert(gi >= 0);
+  // pipeline_diff is the third variable of the group
+  *pipeline_error = CarpetX::reduce(gi, 2, 0).maxabs;
+}
+
+// Difference between the boundary information in the point descriptor
+// and the one calculated directly from the point's location
+CCTK_DEVICE CCTK_HOST inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_REAL
+boundary_info_mismatch(const PointDesc &p) {
+  const vect<int, dim> &I = p.I;
+  const vect<int, dim> NI =
+      vect<int, dim>(I > p.bnd_max - 1) - vect<int, dim>(I < p.bnd_min);
+  const vect<int, dim> I0 =
+      if_else(NI == 0, 0, if_else(NI < 0, p.bnd_min, p.bnd_max - 1));
+  const vect<int, dim> BI =
+      vect<int, dim>(I == p.bnd_max - 1) - vect<int, dim>(I == p.bnd_min);
+  using std::abs;
+  CCTK_REAL r = 0;
+  for (int d = 0; d < dim; ++d)
+    r += abs(p.NI[d] - NI[d]) + abs(p.I0[d] - I0[d]) + abs(p.BI[d] - BI[d]);
+  return r;
+}
+
+// Loops split each row into boundary and interior points. Check that
+// both give the same boundary information, and that every point is
+// visited exactly once, also when the loop is vectorized.
+extern "C" void TestLoopX_BoundaryInfo(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestLoopX_BoundaryInfo;
+  DECLARE_CCTK_PARAMETERS;
+
+  grid.loop_all<0, 0, 0>(grid.nghostzones, [=](const PointDesc &p) {
+    boundary_info_count(p.I) = 0;
+    boundary_info_diff(p.I) = 0;
+  });
+
+  grid.loop_all<0, 0, 0>(grid.nghostzones, [=](const PointDesc &p) {
+    boundary_info_count(p.I) += 1;
+    boundary_info_diff(p.I) += boundary_info_mismatch(p);
+  });
+
+  // With a vector size larger than one, the boundary information
+  // describes the first point of each vector
+  constexpr int vsize = 4;
+  grid.loop_all<0, 0, 0, vsize>(grid.nghostzones, [=](const PointDesc &p) {
+    for (int n = 0; n < vsize; ++n) {
+      const vect<int, dim> I = p.I + n * p.DI[0];
+      if (I[0] < p.loop_max[0])
+        boundary_info_count(I) += 1;
+    }
+    boundary_info_diff(p.I) += boundary_info_mismatch(p);
+  });
+
+  grid.loop_all_device<0, 0, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE CCTK_HOST(const PointDesc &p)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE {
+            boundary_info_count(p.I) += 1;
+            boundary_info_diff(p.I) += boundary_info_mismatch(p);
+          });
+
+  grid.loop_all_device<0, 0, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE CCTK_HOST(const PointDesc &p)
+          CCTK_ATTRIBUTE_ALWAYS_INLINE {
+            using std::abs;
+            boundary_info_diff(p.I) += abs(boundary_info_count(p.I) - 3);
+          });
+}
+
+extern "C" void TestLoopX_BoundaryInfoError(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestLoopX_BoundaryInfoError;
+
+  const int gi = CCTK_GroupIndex("TestLoopX::boundary_info");
+  assert(gi >= 0);
+  // boundary_info_diff is the second variable of the group
+  *boundary_info_error = CarpetX::reduce(gi, 1, 0).maxabs;
+}
+
 } // namespace TestLoopX
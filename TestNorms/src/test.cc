@@ -4,6 +4,7 @@
 
 #include <iostream>
 
+#include "derived.hxx"
 #include "loop.hxx"
 
 namespace TestNorms {
@@ -27,6 +28,14 @@ CCTK_REAL fun(const Loop::PointDesc &p, const bool avgx, const bool avgy,
          fun1d(p.z, p.dz, avgz, order);
 }
 
+// A derived quantity that reproduces gf000. Its norms must agree with
+// those of the stored grid function.
+extern "C" void TestNorms_RegisterDerived(CCTK_ARGUMENTS) {
+  CarpetX::register_derived_quantity(
+      "TestNorms::gf000_derived", {"TestNorms::gf000"},
+      [](const CCTK_REAL *const vals) { return vals[0]; });
+}
+
 extern "C" void TestNorms_SetError(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTSX_TestNorms_SetError;
   DECLARE_CCTK_PARAMETERS;
@@ -1,7 +1,16 @@
+#include <derived.hxx>
 #include <loop_device.hxx>
 
 namespace TestOutput {
 
+// A derived quantity that reproduces gf. Its output must agree with
+// that of the stored grid function.
+extern "C" void TestOutput_RegisterDerived(CCTK_ARGUMENTS) {
+  CarpetX::register_derived_quantity(
+      "TestOutput::gf_derived", {"TestOutput::gf"},
+      [](const CCTK_REAL *const vals) { return vals[0]; });
+}
+
 extern "C" void TestOutput_SetVarsLocal(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTSX_TestOutput_SetVarsLocal;
 
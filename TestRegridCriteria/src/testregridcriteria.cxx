@@ -0,0 +1,55 @@
+#include <loop_device.hxx>
+#include <reduction.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace TestRegridCriteria {
+
+// Each criterion is non-zero exactly in the coarse-grid cells whose
+// centres lie in the slab -0.5 < x < 0:
+// - crit_value is 1 there,
+// - crit_gradient has slope 1 there and is constant outside,
+// - crit_laplacian is a parabola that vanishes at the centres of the
+//   first and last cells of the slab, and is 0 outside.
+extern "C" void TestRegridCriteria_Init(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestRegridCriteria_Init;
+
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        using std::fmax, std::fmin;
+        constexpr CCTK_REAL xmin = -0.5, xmax = 0;
+        // Coarse-grid cell spacing
+        const CCTK_REAL dx0 = p.DX[0] * (1 << p.level);
+        const CCTK_REAL a = xmin + dx0 / 2, b = xmax - dx0 / 2;
+        const bool in_slab = p.x > xmin && p.x < xmax;
+
+        crit_value(p.I) = in_slab ? 1 : 0;
+        crit_gradient(p.I) = fmin(fmax(p.x, xmin), xmax);
+        crit_laplacian(p.I) = in_slab ? (p.x - a) * (b - p.x) : 0;
+
+        level_index(p.I) = p.level;
+        level_x(p.I) = p.level * p.x;
+      });
+}
+
+// The reductions skip cells that are covered by finer levels. The sums
+// of level_index and level_x are thus the volume and the x moment of
+// the refined region.
+extern "C" void TestRegridCriteria_Measure(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestRegridCriteria_Measure;
+
+  const int gi = CCTK_GroupIndex("TestRegridCriteria::refinement");
+  assert(gi >= 0);
+  const CCTK_REAL volume = CarpetX::reduce(gi, 0, 0).sum;
+  const CCTK_REAL moment_x = CarpetX::reduce(gi, 1, 0).sum;
+  *refined_volume = volume;
+  *refined_centre_x = volume == 0 ? 0 : moment_x / volume;
+}
+
+} // namespace TestRegridCriteria
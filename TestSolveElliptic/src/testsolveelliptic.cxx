@@ -0,0 +1,102 @@
+#include <loop_device.hxx>
+#include <reduction.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace TestSolveElliptic {
+
+constexpr int dim = Loop::dim;
+using vec = Arith::vect<CCTK_REAL, dim>;
+
+// Known solution. This is a bump with support in |x|, |y|, |z| < 1/2,
+// so that it vanishes near the domain boundary where the boundary
+// stencils of the solver differ from the interior stencil.
+CCTK_DEVICE CCTK_HOST inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_REAL
+solution(const vec &X) {
+  using Arith::pow2;
+  using std::fabs;
+  CCTK_REAL u = 1;
+  for (int d = 0; d < dim; ++d)
+    u *= fabs(X[d]) < CCTK_REAL(0.5) ? pow2(1 - 4 * pow2(X[d])) : 0;
+  return u;
+}
+
+// Coefficient sigma
+CCTK_DEVICE CCTK_HOST inline CCTK_ATTRIBUTE_ALWAYS_INLINE CCTK_REAL
+coefficient(const vec &X) {
+  using Arith::pow2;
+  return 1 + pow2(X[0] + 2 * X[1] + 3 * X[2]) / 16;
+}
+
+extern "C" void TestSolveElliptic_Init(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSolveElliptic_Init;
+
+  // The boundary values of the solution are zero
+  grid.loop_all_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        sol(p.I) = 0;
+        sigma(p.I) = coefficient(p.X);
+      });
+
+  // Apply the discrete operator to the known solution. The solver
+  // averages sigma arithmetically to faces, so this is the operator it
+  // inverts, and the discrete solution is the known solution.
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        using Arith::pow2;
+        CCTK_REAL r = 0;
+        for (int d = 0; d < dim; ++d) {
+          const vec DX = p.DX[d] * vec::unit(d);
+          const CCTK_REAL sigma_m =
+              (coefficient(p.X - DX) + coefficient(p.X)) / 2;
+          const CCTK_REAL sigma_p =
+              (coefficient(p.X) + coefficient(p.X + DX)) / 2;
+          r += (sigma_p * (solution(p.X + DX) - solution(p.X)) -
+                sigma_m * (solution(p.X) - solution(p.X - DX))) /
+               pow2(p.DX[d]);
+        }
+        rhs(p.I) = r;
+      });
+}
+
+extern "C" void TestSolveElliptic_Solve(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSolveElliptic_Solve;
+  DECLARE_CCTK_PARAMETERS;
+
+  const CCTK_INT vn_sol = CCTK_VarIndex("TestSolveElliptic::sol");
+  const CCTK_INT vn_rhs = CCTK_VarIndex("TestSolveElliptic::rhs");
+  const CCTK_INT vn_res = -1;
+  const CCTK_INT vn_sigma = CCTK_VarIndex("TestSolveElliptic::sigma");
+  assert(vn_sol >= 0 && vn_rhs >= 0 && vn_sigma >= 0);
+
+  CCTK_REAL res_initial, res_final;
+  SolveElliptic(1, &vn_sol, &vn_rhs, &vn_res, vn_sigma, 0, reltol, abstol,
+                &res_initial, &res_final);
+}
+
+extern "C" void TestSolveElliptic_Error(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSolveElliptic_Error;
+
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        err(p.I) = sol(p.I) - solution(p.X);
+      });
+}
+
+extern "C" void TestSolveElliptic_MaxError(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSolveElliptic_MaxError;
+
+  const int gi = CCTK_GroupIndex("TestSolveElliptic::err");
+  assert(gi >= 0);
+  *max_error = CarpetX::reduce(gi, 0, 0).maxabs;
+}
+
+} // namespace TestSolveElliptic
@@ -0,0 +1,87 @@
+#include <loop_device.hxx>
+#include <reduction.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace TestSubcycling {
+
+extern "C" void TestSubcycling_Initial(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSubcycling_Initial;
+  DECLARE_CCTK_PARAMETERS;
+
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        using std::exp, std::pow;
+        const CCTK_REAL r2 = pow(p.x, 2) + pow(p.y, 2) + pow(p.z, 2);
+        rho(p.I) = 1 + amplitude * exp(-r2 / (2 * pow(width, 2)));
+      });
+}
+
+extern "C" void TestSubcycling_InitialMass(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSubcycling_InitialMass;
+
+  const int gi = CCTK_GroupIndex("TestSubcycling::rho");
+  assert(gi >= 0);
+  *initial_mass = CarpetX::reduce(gi, 0, 0).sum;
+}
+
+extern "C" void TestSubcycling_Fluxes(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSubcycling_Fluxes;
+  DECLARE_CCTK_PARAMETERS;
+
+  // First-order upwind fluxes; the velocity is non-negative, so the
+  // upwind cell is the one in the negative direction. As in
+  // FluxWaveToyX, the fluxes are flux densities; CarpetX scales them
+  // by the face area and the time step size for refluxing.
+  grid.loop_int_device<0, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        flux_x(p.I) = velocity_x * rho(p.I - p.DI[0]);
+      });
+  grid.loop_int_device<1, 0, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        flux_y(p.I) = velocity_y * rho(p.I - p.DI[1]);
+      });
+  grid.loop_int_device<1, 1, 0>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        flux_z(p.I) = velocity_z * rho(p.I - p.DI[2]);
+      });
+}
+
+extern "C" void TestSubcycling_Update(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSubcycling_Update;
+
+  const CCTK_REAL dt = CCTK_DELTA_TIME;
+
+  grid.loop_int_device<1, 1, 1>(
+      grid.nghostzones,
+      [=] CCTK_DEVICE(const Loop::PointDesc &p) CCTK_ATTRIBUTE_ALWAYS_INLINE {
+        rho(p.I) -= dt * ((flux_x(p.I + p.DI[0]) - flux_x(p.I)) / p.DX[0] +
+                          (flux_y(p.I + p.DI[1]) - flux_y(p.I)) / p.DX[1] +
+                          (flux_z(p.I + p.DI[2]) - flux_z(p.I)) / p.DX[2]);
+      });
+}
+
+extern "C" void TestSubcycling_Sync(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSubcycling_Sync;
+  // do nothing
+}
+
+extern "C" void TestSubcycling_MassError(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTSX_TestSubcycling_MassError;
+
+  const int gi = CCTK_GroupIndex("TestSubcycling::rho");
+  assert(gi >= 0);
+  const CCTK_REAL mass = CarpetX::reduce(gi, 0, 0).sum;
+  *mass_error = std::fabs(mass - *initial_mass) / std::fabs(*initial_mass);
+}
+
+} // namespace TestSubcycling